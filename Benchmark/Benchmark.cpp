@@ -0,0 +1,49 @@
+#include "Benchmark.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+
+#include "ThreadPoolBenchmark.h"
+
+BenchmarkApplication::BenchmarkSettings Benchmark::ParseSettings(const int argc, char** argv)
+{
+	BenchmarkSettings settings;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* value = std::strchr(argv[i], '=');
+		if (!value) { printf("Ignoring argument %s, settings are passed as name=value\n", argv[i]); continue; }
+
+		const uint64 nameLength = value - argv[i];
+		const uint64 number = std::strtoull(value + 1, nullptr, 10);
+
+		auto is = [&](const char* name) { return std::strlen(name) == nameLength && !std::strncmp(argv[i], name, nameLength); };
+		auto set = [&](auto& setting) { setting = static_cast<std::remove_reference_t<decltype(setting)>>(number); };
+
+		if (is("Systems")) { set(settings.Systems); }
+		else if (is("RecurringTasks")) { set(settings.RecurringTasks); }
+		else if (is("DynamicTasksPerFrame")) { set(settings.DynamicTasksPerFrame); }
+		else if (is("MaxDependencies")) { set(settings.MaxDependencies); }
+		else if (is("WritePercentage")) { set(settings.WritePercentage); }
+		else if (is("WorkIterations")) { set(settings.WorkIterations); }
+		else if (is("Frames")) { set(settings.Frames); }
+		else if (is("FramesInFlight")) { set(settings.FramesInFlight); }
+		else if (is("Seed")) { set(settings.Seed); }
+		else if (is("AllocatorIterations")) { set(settings.AllocatorIterations); }
+		else if (is("TLBWalkMegabytes")) { set(settings.TLBWalkMegabytes); }
+		else if (is("ThreadPoolTasks")) { set(settings.ThreadPoolTasks); }
+		else if (is("ProfilerEvents")) { set(settings.ProfilerEvents); }
+		else { printf("Ignoring unknown setting %s\n", argv[i]); }
+	}
+
+	return settings;
+}
+
+void Benchmark::PostInitialize()
+{
+	if (getSettings().ThreadPoolTasks) { ThreadPoolBenchmark(GetThreadPool(), getSettings().ThreadPoolTasks).Run(); }
+
+	BenchmarkApplication::PostInitialize();
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <ByteEngine.h>
+
+#include "ByteEngine/Application/Templates/BenchmarkApplication.h"
+
+/**
+ * \brief Runs BenchmarkApplication with settings taken from the command line, as name=value pairs named like the BenchmarkSettings members.
+ * e.g. Benchmark Frames=500 DynamicTasksPerFrame=128 ThreadPoolTasks=1000000
+ */
+class Benchmark final : public BenchmarkApplication
+{
+public:
+	Benchmark() : BenchmarkApplication("Benchmark", ParseSettings(application_argc, application_argv))
+	{
+	}
+
+	/**
+	 * \brief Returns the default settings overridden by every recognized argument, unrecognized ones are reported and ignored.
+	 */
+	static BenchmarkSettings ParseSettings(int argc, char** argv);
+
+	/**
+	 * \brief Runs the ThreadPoolBenchmark before the benchmarks of BenchmarkApplication.
+	 */
+	void PostInitialize() override;
+};
+
+inline GTSL::SmartPointer<BE::Application, SystemAllocatorReference> CreateApplication(const SystemAllocatorReference& allocatorReference)
+{
+	return GTSL::SmartPointer<BE::Application, SystemAllocatorReference>::Create<Benchmark>(allocatorReference);
+}
@@ -0,0 +1,165 @@
+#include "ThreadPoolBenchmark.h"
+
+#include <thread>
+
+#include <GTSL/Atomic.hpp>
+#include <GTSL/BlockingQueue.h>
+#include <GTSL/Semaphore.h>
+#include <GTSL/Thread.h>
+#include <GTSL/Tuple.h>
+
+#include "ByteEngine/Application/Templates/Benchmarks/BenchmarkThreads.h"
+#include "ByteEngine/Application/ThreadPool.h"
+
+/**
+ * \brief Thread pool the engine used before the work stealing ThreadPool, a blocking queue per worker which tasks are pushed to round robin.
+ * Every task record is allocated from the persistent allocator. Only kept, out of the engine, so the thread pool benchmark has something to compare against.
+ */
+class BlockingQueueThreadPool : public Object
+{
+	using TaskDelegate = GTSL::Delegate<void(BlockingQueueThreadPool*, void*)>;
+	using Tasks = GTSL::Tuple<TaskDelegate, void*, GTSL::Semaphore*>;
+public:
+	explicit BlockingQueueThreadPool() : Object("Blocking Queue Thread Pool"), queues(threadCount)
+	{
+		auto workers_loop = [](BlockingQueueThreadPool* pool, const uint8 i)
+		{
+			while (true)
+			{
+				Tasks task;
+
+				for (auto n = 0; n < threadCount * K; ++n)
+				{
+					if (pool->queues[(i + n) % threadCount].TryPop(task)) { break; }
+				}
+
+				if (!GTSL::Get<TUPLE_LAMBDA_DELEGATE_INDEX>(task) && !pool->queues[i].Pop(task)) { break; }
+
+				GTSL::Get<TUPLE_LAMBDA_DELEGATE_INDEX>(task)(pool, &task);
+			}
+		};
+
+		for (uint8 i = 0; i < threadCount; ++i)
+		{
+			threads.EmplaceBack(GetPersistentAllocator(), i, GTSL::Delegate<void(BlockingQueueThreadPool*, uint8)>::Create(workers_loop), this, i);
+			threads[i].SetPriority(GTSL::Thread::Priority::HIGH);
+		}
+	}
+
+	~BlockingQueueThreadPool()
+	{
+		for (auto& queue : queues) { queue.Done(); }
+		for (auto& thread : threads) { thread.Join(GetPersistentAllocator()); }
+	}
+
+	template<typename F, typename... ARGS>
+	void EnqueueTask(const GTSL::Delegate<F>& task, GTSL::Semaphore* semaphore, ARGS&&... args)
+	{
+		TaskInfo<F, ARGS...>* taskInfoAlloc = GTSL::New<TaskInfo<F, ARGS...>>(GetPersistentAllocator(), task, GTSL::ForwardRef<ARGS>(args)...);
+
+		auto work = [](BlockingQueueThreadPool* threadPool, void* voidTask) -> void
+		{
+			Tasks* task = static_cast<Tasks*>(voidTask);
+			TaskInfo<F, ARGS...>* taskInfo = static_cast<TaskInfo<F, ARGS...>*>(GTSL::Get<TUPLE_LAMBDA_TASK_INFO_INDEX>(*task));
+
+			GTSL::Call(taskInfo->Delegate, taskInfo->Arguments);
+			if (auto* semaphore = GTSL::Get<TUPLE_SEMAPHORE_INDEX>(*task)) { semaphore->Post(); }
+
+			GTSL::Delete<TaskInfo<F, ARGS...>>(taskInfo, threadPool->GetPersistentAllocator());
+		};
+
+		const auto currentIndex = ++index;
+
+		for (auto n = 0; n < threadCount * K; ++n)
+		{
+			if (queues[(currentIndex + n) % threadCount].TryPush(Tasks(TaskDelegate::Create(work), GTSL::MoveRef((void*)taskInfoAlloc), GTSL::MoveRef(semaphore)))) { return; }
+		}
+
+		queues[currentIndex % threadCount].Push(Tasks(TaskDelegate::Create(work), GTSL::MoveRef((void*)taskInfoAlloc), GTSL::MoveRef(semaphore)));
+	}
+
+private:
+	inline const static uint8 threadCount{ static_cast<uint8>(GTSL::Thread::ThreadCount() - 1) };
+	GTSL::Atomic<uint32> index{ 0 };
+
+	static constexpr uint8 TUPLE_LAMBDA_DELEGATE_INDEX = 0;
+	static constexpr uint8 TUPLE_LAMBDA_TASK_INFO_INDEX = 1;
+	static constexpr uint8 TUPLE_SEMAPHORE_INDEX = 2;
+
+	GTSL::Array<GTSL::BlockingQueue<Tasks>, 32> queues;
+	GTSL::Array<GTSL::Thread, 32> threads;
+
+	template<typename T, typename... ARGS>
+	struct TaskInfo
+	{
+		TaskInfo(const GTSL::Delegate<T>& delegate, ARGS&&... args) : Delegate(delegate), Arguments(GTSL::ForwardRef<ARGS>(args)...)
+		{
+		}
+
+		GTSL::Delegate<T> Delegate;
+		GTSL::Tuple<ARGS...> Arguments;
+	};
+
+	/**
+	 * \brief Number of times to loop around the queues to find one that is free.
+	 */
+	inline static constexpr uint8 K{ 2 };
+};
+
+void ThreadPoolBenchmark::Run()
+{
+	if (!ThreadPool::GetNumberOfThreads()) { BenchmarkThreads::Report(true, "Thread pool: no worker threads, skipped"); return; }
+
+	auto* blockingQueuePool = GTSL::New<BlockingQueueThreadPool>(GetPersistentAllocator());
+
+	for (const bool fromTasks : { false, true })
+	{
+		//first round warms up the task caches and queues of both pools
+		measure(threadPool, fromTasks); measure(blockingQueuePool, fromTasks);
+
+		const float64 workStealing = measure(threadPool, fromTasks);
+		const float64 blockingQueue = measure(blockingQueuePool, fromTasks);
+
+		BenchmarkThreads::Report(true, "Thread pool: %u tasks enqueued from %s, work stealing %.0f tasks/sec, blocking queue %.0f tasks/sec, %.2fx", tasks,
+			fromTasks ? "tasks" : "the main thread", workStealing, blockingQueue, workStealing / blockingQueue);
+	}
+
+	GTSL::Delete(blockingQueuePool, GetPersistentAllocator());
+}
+
+template<class POOL>
+float64 ThreadPoolBenchmark::measure(POOL* pool, const bool fromTasks)
+{
+	using EmptyTask = GTSL::Delegate<void(ThreadPoolBenchmark*)>;
+
+	ThreadPoolBenchmark* benchmark = this;
+	tasksDone.store(0, std::memory_order_relaxed);
+
+	const uint64 start = BenchmarkThreads::Now();
+
+	if (fromTasks) //every worker gets a task which enqueues it's share of the tasks, so the work stealing pool pushes them to the worker's own deque
+	{
+		const uint32 roots = ThreadPool::GetNumberOfThreads();
+
+		for (uint32 i = 0; i < roots; ++i)
+		{
+			uint32 count = tasks / roots + (i < tasks % roots);
+
+			pool->EnqueueTask(GTSL::Delegate<void(POOL*, ThreadPoolBenchmark*, uint32)>::Create([](POOL* pool, ThreadPoolBenchmark* benchmark, const uint32 count)
+			{
+				for (uint32 t = 0; t < count; ++t) { pool->EnqueueTask(EmptyTask::Create([](ThreadPoolBenchmark* benchmark) { benchmark->tasksDone.fetch_add(1, std::memory_order_relaxed); }), nullptr, GTSL::MoveRef(benchmark)); }
+			}), nullptr, GTSL::MoveRef(pool), GTSL::MoveRef(benchmark), GTSL::MoveRef(count));
+		}
+	}
+	else
+	{
+		for (uint32 t = 0; t < tasks; ++t)
+		{
+			pool->EnqueueTask(EmptyTask::Create([](ThreadPoolBenchmark* benchmark) { benchmark->tasksDone.fetch_add(1, std::memory_order_relaxed); }), nullptr, GTSL::MoveRef(benchmark));
+		}
+	}
+
+	while (tasksDone.load(std::memory_order_acquire) != tasks) { std::this_thread::yield(); }
+
+	return static_cast<float64>(tasks) / (static_cast<float64>(BenchmarkThreads::Now() - start) / 1000000000.0);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "ByteEngine/Object.h"
+
+#include <atomic>
+
+class ThreadPool;
+
+/**
+ * \brief Measures how many empty tasks per second the work stealing ThreadPool runs compared to the blocking queue based pool it replaced,
+ * once enqueued from the main thread and once enqueued from inside tasks.
+ */
+class ThreadPoolBenchmark : public Object
+{
+public:
+	/**
+	 * \param tasks Empty tasks run through each pool per measurement.
+	 */
+	ThreadPoolBenchmark(ThreadPool* threadPool, const uint32 tasks) : Object("Thread Pool Benchmark"), threadPool(threadPool), tasks(tasks)
+	{
+	}
+
+	void Run();
+
+private:
+	ThreadPool* threadPool; uint32 tasks;
+	std::atomic<uint32> tasksDone{ 0 };
+
+	/**
+	 * \brief Runs tasks empty tasks through pool and returns the tasks per second.
+	 */
+	template<class POOL>
+	float64 measure(POOL* pool, bool fromTasks);
+};
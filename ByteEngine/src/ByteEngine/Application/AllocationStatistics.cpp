@@ -0,0 +1,191 @@
+#include "AllocationStatistics.h"
+
+#ifdef BE_ALLOCATION_STATISTICS
+
+#include <bit>
+#include <new>
+
+#include <GTSL/Id.h>
+#include <GTSL/Memory.h>
+
+#include "ByteEngine/Debug/Assert.h"
+
+//defined out of the class since ThreadTableOwner's member initializers aren't usable until AllocationStatistics is complete
+thread_local AllocationStatistics::ThreadTableOwner AllocationStatistics::threadTable;
+
+uint32 AllocationStatistics::getBucket(const uint64 size)
+{
+	if (size <= 16) { return 0; }
+	const uint32 bucket = static_cast<uint32>(std::bit_width(size - 1)) - 4;
+	return bucket < HISTOGRAM_BUCKETS ? bucket : HISTOGRAM_BUCKETS - 1;
+}
+
+AllocationStatistics::ThreadTable* AllocationStatistics::getThreadTable()
+{
+	if (threadTable.Table) { return threadTable.Table; }
+
+	{
+		GTSL::Lock lock(freeTablesMutex);
+		if (freeTableCount) { threadTable.Table = freeTables[--freeTableCount]; return threadTable.Table; }
+	}
+
+	const auto index = threadTableCount.fetch_add(1, std::memory_order_relaxed);
+	BE_ASSERT(index < MAX_THREADS, "Too many threads for allocation statistics!")
+	if (index >= MAX_THREADS) { return nullptr; }
+
+	//straight from the OS, going through an engine allocator would record this allocation while creating the table
+	void* memory{ nullptr };
+	GTSL::Allocate(sizeof(ThreadTable), &memory);
+
+	//kept alive until the process exits, counts of exited threads are still read
+	threadTable.Table = ::new(memory) ThreadTable();
+	threadTables[index].store(threadTable.Table, std::memory_order_release);
+	return threadTable.Table;
+}
+
+AllocationStatistics::ThreadTableOwner::~ThreadTableOwner()
+{
+	if (!Table) { return; }
+
+	GTSL::Lock lock(freeTablesMutex);
+	freeTables[freeTableCount++] = Table;
+}
+
+AllocationStatistics::Entry& AllocationStatistics::getEntry(ThreadTable& table, const AllocatorType allocator, const char* name)
+{
+	if (!name) { name = "Unnamed"; }
+
+	//keyed by pointer, names are mostly literals or object names which don't move, TakeSnapshot merges equal names behind different pointers
+	const auto pointerHash = reinterpret_cast<uint64>(name) * 0x9E3779B97F4A7C15ull + static_cast<uint64>(allocator);
+
+	for (uint32 i = 0, slot = static_cast<uint32>(pointerHash >> 56) % ENTRIES_PER_THREAD; i < ENTRIES_PER_THREAD; ++i, slot = (slot + 1) % ENTRIES_PER_THREAD)
+	{
+		auto& entry = table.Entries[slot];
+		const char* entryName = entry.Name.load(std::memory_order_relaxed);
+
+		if (entryName == name && entry.Allocator == allocator) { return entry; }
+
+		if (!entryName)
+		{
+			const GTSL::Id64::HashType hash = GTSL::Id64(name);
+			entry.NameHash = hash; entry.Allocator = allocator;
+			entry.Name.store(name, std::memory_order_release);
+			return entry;
+		}
+	}
+
+	if (!table.Other.Name.load(std::memory_order_relaxed))
+	{
+		const GTSL::Id64::HashType hash = GTSL::Id64("Other");
+		table.Other.NameHash = hash;
+		table.Other.Name.store("Other", std::memory_order_release);
+	}
+
+	return table.Other;
+}
+
+void AllocationStatistics::RecordAllocation(const AllocatorType allocator, const char* name, const uint64 size)
+{
+	auto* table = getThreadTable(); if (!table) { return; }
+	auto& entry = getEntry(*table, allocator, name);
+
+	add(entry.Allocations, 1); add(entry.BytesAllocated, size);
+	add(entry.SizeHistogram[getBucket(size)], 1);
+}
+
+void AllocationStatistics::RecordDeallocation(const AllocatorType allocator, const char* name, const uint64 size)
+{
+	auto* table = getThreadTable(); if (!table) { return; }
+	auto& entry = getEntry(*table, allocator, name);
+
+	add(entry.Deallocations, 1); add(entry.BytesDeallocated, size);
+}
+
+void AllocationStatistics::TakeSnapshot(Snapshot& snapshot)
+{
+	snapshot.Clear();
+
+	auto accumulate = [&](const Entry& entry)
+	{
+		const char* name = entry.Name.load(std::memory_order_acquire);
+		if (!name) { return; }
+
+		//open addressing on the name's hash, so equal names from different threads and pointers land on the same entry
+		uint32 slot = static_cast<uint32>((entry.NameHash ^ static_cast<uint64>(entry.Allocator)) % MAX_SNAPSHOT_NAMES);
+
+		for (uint32 i = 0; i < MAX_SNAPSHOT_NAMES; ++i, slot = (slot + 1) % MAX_SNAPSHOT_NAMES)
+		{
+			auto& statistics = snapshot.Names[slot];
+
+			if (!statistics.Name)
+			{
+				statistics.Name = name; statistics.NameHash = entry.NameHash; statistics.Allocator = entry.Allocator;
+				++snapshot.Count;
+			}
+			else if (statistics.NameHash != entry.NameHash || statistics.Allocator != entry.Allocator)
+			{
+				continue;
+			}
+
+			statistics.Allocations += entry.Allocations.load(std::memory_order_relaxed);
+			statistics.Deallocations += entry.Deallocations.load(std::memory_order_relaxed);
+			statistics.BytesAllocated += entry.BytesAllocated.load(std::memory_order_relaxed);
+			statistics.BytesDeallocated += entry.BytesDeallocated.load(std::memory_order_relaxed);
+			for (uint32 b = 0; b < HISTOGRAM_BUCKETS; ++b) { statistics.SizeHistogram[b] += entry.SizeHistogram[b].load(std::memory_order_relaxed); }
+
+			return;
+		}
+	};
+
+	const uint32 tableCount = threadTableCount.load(std::memory_order_acquire);
+
+	for (uint32 t = 0; t < tableCount && t < MAX_THREADS; ++t)
+	{
+		const auto* table = threadTables[t].load(std::memory_order_acquire);
+		if (!table) { continue; }
+
+		for (const auto& entry : table->Entries) { accumulate(entry); }
+		accumulate(table->Other);
+	}
+}
+
+uint32 AllocationStatistics::GetTopAllocators(const Snapshot& current, const Snapshot& previous, const SortBy sortBy, const GTSL::Ranger<NameStatistics> top)
+{
+	uint32 count = 0;
+	if (!top.ElementCount()) { return 0; }
+
+	auto key = [&](const NameStatistics& statistics) { return sortBy == SortBy::BYTES ? statistics.BytesAllocated : statistics.Allocations; };
+
+	for (const auto& entry : current.Names)
+	{
+		if (!entry.Name) { continue; }
+
+		NameStatistics delta = entry;
+
+		//same hashing as TakeSnapshot, the entry is at or after it's slot
+		for (uint32 i = 0, slot = static_cast<uint32>((entry.NameHash ^ static_cast<uint64>(entry.Allocator)) % MAX_SNAPSHOT_NAMES); i < MAX_SNAPSHOT_NAMES; ++i, slot = (slot + 1) % MAX_SNAPSHOT_NAMES)
+		{
+			const auto& old = previous.Names[slot];
+			if (!old.Name) { break; }
+			if (old.NameHash != entry.NameHash || old.Allocator != entry.Allocator) { continue; }
+
+			delta.Allocations -= old.Allocations; delta.Deallocations -= old.Deallocations;
+			delta.BytesAllocated -= old.BytesAllocated; delta.BytesDeallocated -= old.BytesDeallocated;
+			for (uint32 b = 0; b < HISTOGRAM_BUCKETS; ++b) { delta.SizeHistogram[b] -= old.SizeHistogram[b]; }
+			break;
+		}
+
+		if (!key(delta)) { continue; }
+
+		//insertion into the sorted top list, dropping the smallest one when full
+		if (count == top.ElementCount() && key(top[count - 1]) >= key(delta)) { continue; }
+		uint32 position = count < top.ElementCount() ? count++ : count - 1;
+
+		for (; position > 0 && key(top[position - 1]) < key(delta); --position) { top[position] = top[position - 1]; }
+		top[position] = delta;
+	}
+
+	return count;
+}
+
+#endif
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "ByteEngine/Core.h"
+
+#ifdef BE_ALLOCATION_STATISTICS
+
+#include <atomic>
+
+#include <GTSL/Mutex.h>
+#include <GTSL/Ranger.h>
+
+/**
+ * \brief Counts allocations per allocator and allocation name(BEAllocatorReference::Name) along with a histogram of their sizes.
+ * Every thread counts in it's own table, which only it writes, so recording takes no locks nor locked instructions. Reading sums every thread's table.
+ * Compiled when BE_ALLOCATION_STATISTICS is defined, which debug builds always do and release builds can, call sites wrap calls in BE_STATISTICS_ONLY.
+ */
+class AllocationStatistics
+{
+public:
+	enum class AllocatorType : uint8
+	{
+		SYSTEM, PERSISTENT, TRANSIENT
+	};
+
+	/**
+	 * \brief Allocations of up to 16 bytes go in the first bucket, every bucket after doubles the size, the last one takes everything bigger.
+	 */
+	static constexpr uint32 HISTOGRAM_BUCKETS = 16;
+
+	static void RecordAllocation(AllocatorType allocator, const char* name, uint64 size);
+	static void RecordDeallocation(AllocatorType allocator, const char* name, uint64 size);
+
+	struct NameStatistics
+	{
+		const char* Name = nullptr;
+		uint64 NameHash = 0;
+		AllocatorType Allocator = AllocatorType::SYSTEM;
+		uint64 Allocations = 0, Deallocations = 0;
+		uint64 BytesAllocated = 0, BytesDeallocated = 0;
+		uint64 SizeHistogram[HISTOGRAM_BUCKETS]{};
+	};
+
+	static constexpr uint32 MAX_SNAPSHOT_NAMES = 512;
+
+	/**
+	 * \brief Totals of every name at the time it was taken, names allocated through more than one allocator get an entry per allocator.
+	 */
+	struct Snapshot
+	{
+		uint32 Count = 0;
+		NameStatistics Names[MAX_SNAPSHOT_NAMES];
+
+		void Clear() { Count = 0; for (auto& e : Names) { e = NameStatistics(); } }
+	};
+
+	/**
+	 * \brief Sums every thread's counters into snapshot. Threads keep recording while it's taken, so numbers can be slightly off.
+	 */
+	static void TakeSnapshot(Snapshot& snapshot);
+
+	enum class SortBy : uint8
+	{
+		BYTES, COUNT
+	};
+
+	/**
+	 * \brief Fills top with the names which allocated the most between previous and current, biggest first. Taking a snapshot every frame gives the top allocators per frame.
+	 * \return Number of entries written to top.
+	 */
+	static uint32 GetTopAllocators(const Snapshot& current, const Snapshot& previous, SortBy sortBy, GTSL::Ranger<NameStatistics> top);
+
+private:
+	static constexpr uint32 ENTRIES_PER_THREAD = 256;
+	static constexpr uint32 MAX_THREADS = 256;
+
+	struct Entry
+	{
+		/**
+		 * \brief Published last so readers never see an entry with missing key.
+		 */
+		std::atomic<const char*> Name{ nullptr };
+		uint64 NameHash = 0;
+		AllocatorType Allocator = AllocatorType::SYSTEM;
+		std::atomic<uint64> Allocations{ 0 }, Deallocations{ 0 };
+		std::atomic<uint64> BytesAllocated{ 0 }, BytesDeallocated{ 0 };
+		std::atomic<uint64> SizeHistogram[HISTOGRAM_BUCKETS]{};
+	};
+
+	struct ThreadTable
+	{
+		Entry Entries[ENTRIES_PER_THREAD];
+		/**
+		 * \brief Takes the counts of names which don't fit in the table.
+		 */
+		Entry Other;
+	};
+
+	/**
+	 * \brief Returns a thread's table to the free list when the thread exits, so threads created later reuse it and their counts are kept.
+	 */
+	struct ThreadTableOwner
+	{
+		ThreadTable* Table = nullptr;
+		~ThreadTableOwner();
+	};
+
+	static thread_local ThreadTableOwner threadTable;
+
+	inline static std::atomic<uint32> threadTableCount{ 0 };
+	inline static std::atomic<ThreadTable*> threadTables[MAX_THREADS]{};
+
+	inline static GTSL::Mutex freeTablesMutex;
+	inline static ThreadTable* freeTables[MAX_THREADS]{};
+	inline static uint32 freeTableCount{ 0 };
+
+	static ThreadTable* getThreadTable();
+	static Entry& getEntry(ThreadTable& table, AllocatorType allocator, const char* name);
+
+	static void add(std::atomic<uint64>& counter, const uint64 value) { counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed); }
+
+	static uint32 getBucket(uint64 size);
+};
+
+#endif
@@ -0,0 +1,179 @@
+#include "AllocationTracker.h"
+
+#ifdef BE_ALLOCATION_TRACKING
+
+#include <new>
+
+#include <GTSL/Id.h>
+#include <GTSL/Memory.h>
+
+#if defined(BE_PLATFORM_WIN)
+#include <Windows.h>
+#elif defined(BE_PLATFORM_LINUX)
+#include <execinfo.h>
+#endif
+
+AllocationTracker::Shard* AllocationTracker::getShard(const uint64 hash)
+{
+	auto& shardPointer = shards[hash >> 58];
+
+	Shard* shard = shardPointer.load(std::memory_order_acquire);
+	if (shard) { return shard; }
+
+	//straight from the OS, going through an engine allocator would track this allocation while creating the shard
+	void* memory{ nullptr };
+	GTSL::Allocate(sizeof(Shard), &memory);
+	Shard* newShard = ::new(memory) Shard();
+
+	//another thread may have created it first, in which case it's shard is used and this one given back
+	if (shardPointer.compare_exchange_strong(shard, newShard, std::memory_order_acq_rel)) { return newShard; }
+
+	newShard->~Shard();
+	GTSL::Deallocate(sizeof(Shard), memory);
+	return shard;
+}
+
+void AllocationTracker::RecordAllocation(const AllocationStatistics::AllocatorType allocator, const char* name, const void* memory, const uint64 size)
+{
+	if (!memory) { return; }
+
+	//this function and the allocator reference's Allocate are the first two frames, the interesting part of the stack is who called Allocate
+	const void* callstack[CALLSTACK_DEPTH]{};
+#if defined(BE_PLATFORM_WIN)
+	RtlCaptureStackBackTrace(2, CALLSTACK_DEPTH, const_cast<void**>(callstack), nullptr);
+#elif defined(BE_PLATFORM_LINUX)
+	void* stack[CALLSTACK_DEPTH + 2];
+	const int32 depth = backtrace(stack, CALLSTACK_DEPTH + 2);
+	for (int32 i = 2; i < depth; ++i) { callstack[i - 2] = stack[i]; }
+#endif
+
+	const uint64 addressHash = hash(memory);
+	auto* shard = getShard(addressHash);
+
+	for (uint32 i = 0, slot = static_cast<uint32>(addressHash) % SHARD_CAPACITY; i < SHARD_CAPACITY; ++i, slot = (slot + 1) % SHARD_CAPACITY)
+	{
+		auto& entry = shard->Entries[slot];
+		uint64 address = entry.Address.load(std::memory_order_relaxed);
+
+		if (address != EMPTY && address != TOMBSTONE) { continue; }
+		if (!entry.Address.compare_exchange_strong(address, RESERVED, std::memory_order_acquire)) { continue; }
+
+		entry.Size.store(size, std::memory_order_relaxed);
+		entry.Name.store(name ? name : "Unnamed", std::memory_order_relaxed);
+		for (uint8 f = 0; f < CALLSTACK_DEPTH; ++f) { entry.Callstack[f].store(callstack[f], std::memory_order_relaxed); }
+		entry.Allocator.store(allocator, std::memory_order_relaxed);
+		entry.Epoch.store(epoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		entry.Address.store(reinterpret_cast<uint64>(memory), std::memory_order_release);
+		return;
+	}
+
+	dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AllocationTracker::RecordDeallocation(const void* memory)
+{
+	if (!memory) { return; }
+
+	const uint64 addressHash = hash(memory);
+	auto* shard = shards[addressHash >> 58].load(std::memory_order_acquire);
+	if (!shard) { return; }
+
+	//an address is only live once, so the first match is it. Reaching an empty slot means it was allocated before the shard filled up and was dropped
+	for (uint32 i = 0, slot = static_cast<uint32>(addressHash) % SHARD_CAPACITY; i < SHARD_CAPACITY; ++i, slot = (slot + 1) % SHARD_CAPACITY)
+	{
+		auto& entry = shard->Entries[slot];
+		const uint64 address = entry.Address.load(std::memory_order_acquire);
+
+		if (address == reinterpret_cast<uint64>(memory)) { entry.Address.store(TOMBSTONE, std::memory_order_release); return; }
+		if (address == EMPTY) { return; }
+	}
+}
+
+template<typename F>
+void AllocationTracker::forEachLive(F&& function)
+{
+	for (auto& shardPointer : shards)
+	{
+		const auto* shard = shardPointer.load(std::memory_order_acquire);
+		if (!shard) { continue; }
+
+		for (const auto& entry : shard->Entries)
+		{
+			const uint64 address = entry.Address.load(std::memory_order_acquire);
+			if (address == EMPTY || address == RESERVED || address == TOMBSTONE) { continue; }
+
+			Allocation allocation;
+			allocation.Address = reinterpret_cast<const void*>(address);
+			allocation.Size = entry.Size.load(std::memory_order_relaxed);
+			allocation.Name = entry.Name.load(std::memory_order_relaxed);
+			for (uint8 f = 0; f < CALLSTACK_DEPTH; ++f) { allocation.Callstack[f] = entry.Callstack[f].load(std::memory_order_relaxed); }
+			allocation.Allocator = entry.Allocator.load(std::memory_order_relaxed);
+			function(allocation, entry.Epoch.load(std::memory_order_relaxed));
+		}
+	}
+}
+
+uint32 AllocationTracker::GetLiveMemoryByName(const GTSL::Ranger<LiveMemory> top)
+{
+	static constexpr uint32 MAX_NAMES = 512;
+
+	struct Name { LiveMemory Memory; uint64 Hash = 0; };
+	Name names[MAX_NAMES];
+
+	//names are merged by hash, allocations of the same object can come from different name pointers
+	forEachLive([&](const Allocation& allocation, uint8)
+	{
+		const GTSL::Id64::HashType nameHash = GTSL::Id64(allocation.Name);
+
+		for (uint32 i = 0, slot = static_cast<uint32>(nameHash % MAX_NAMES); i < MAX_NAMES; ++i, slot = (slot + 1) % MAX_NAMES)
+		{
+			auto& name = names[slot];
+
+			if (!name.Memory.Name) { name.Memory.Name = allocation.Name; name.Hash = nameHash; }
+			else if (name.Hash != nameHash) { continue; }
+
+			name.Memory.Bytes += allocation.Size; ++name.Memory.Allocations;
+			return;
+		}
+	});
+
+	uint32 count = 0;
+	if (!top.ElementCount()) { return 0; }
+
+	for (const auto& name : names)
+	{
+		if (!name.Memory.Name) { continue; }
+
+		//insertion into the sorted top list, dropping the smallest one when full
+		if (count == top.ElementCount() && top[count - 1].Bytes >= name.Memory.Bytes) { continue; }
+		uint32 position = count < top.ElementCount() ? count++ : count - 1;
+
+		for (; position > 0 && top[position - 1].Bytes < name.Memory.Bytes; --position) { top[position] = top[position - 1]; }
+		top[position] = name.Memory;
+	}
+
+	return count;
+}
+
+uint32 AllocationTracker::GetLeaks(const GTSL::Ranger<Allocation> leaks, uint64* leakedBytes)
+{
+	uint32 leakCount = 0, count = 0; *leakedBytes = 0;
+
+	forEachLive([&](const Allocation& allocation, const uint8 allocationEpoch)
+	{
+		if (!allocationEpoch) { return; }
+
+		++leakCount; *leakedBytes += allocation.Size;
+
+		if (!leaks.ElementCount()) { return; }
+		if (count == leaks.ElementCount() && leaks[count - 1].Size >= allocation.Size) { return; }
+		uint32 position = count < leaks.ElementCount() ? count++ : count - 1;
+
+		for (; position > 0 && leaks[position - 1].Size < allocation.Size; --position) { leaks[position] = leaks[position - 1]; }
+		leaks[position] = allocation;
+	});
+
+	return leakCount;
+}
+
+#endif
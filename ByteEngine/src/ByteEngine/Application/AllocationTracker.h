@@ -0,0 +1,114 @@
+#pragma once
+
+#include "ByteEngine/Core.h"
+
+#ifdef BE_ALLOCATION_TRACKING
+
+#include <atomic>
+
+#include <GTSL/Ranger.h>
+
+#include "AllocationStatistics.h"
+
+/**
+ * \brief Keeps every live allocation made through the system, persistent and component allocator references, along with it's name(BEAllocatorReference::Name),
+ * size and the call stack it was allocated from, to find leaks. Transient allocations are not tracked since they are all released by StackAllocator::Clear.
+ * Allocations live in a hash table split in shards by address, each one an open addressing table whose slots are claimed with a compare exchange, so recording takes no locks.
+ * Compiled when BE_ALLOCATION_TRACKING is defined, which debug builds always do, call sites wrap calls in BE_TRACKING_ONLY.
+ */
+class AllocationTracker
+{
+public:
+	/**
+	 * \brief Number of frames kept of the call stack of every allocation. Deep enough to get past the containers, which usually take the first few.
+	 */
+	static constexpr uint8 CALLSTACK_DEPTH = 8;
+
+	/**
+	 * \brief Records memory as live. Must be called directly from an allocator reference's Allocate, the call stack is captured starting at whoever called Allocate.
+	 */
+	static void RecordAllocation(AllocationStatistics::AllocatorType allocator, const char* name, const void* memory, uint64 size);
+	static void RecordDeallocation(const void* memory);
+
+	/**
+	 * \brief Allocations made from now on which are still live at shutdown are reported as leaks, the ones made before belong to the application's startup.
+	 */
+	static void BeginFrames() { epoch.store(1, std::memory_order_relaxed); }
+
+	struct LiveMemory
+	{
+		const char* Name = nullptr;
+		uint64 Bytes = 0, Allocations = 0;
+	};
+
+	/**
+	 * \brief Fills top with the names holding the most live memory, biggest first. Safe to call while other threads allocate, for watching long running processes.
+	 * \return Number of entries written to top.
+	 */
+	static uint32 GetLiveMemoryByName(GTSL::Ranger<LiveMemory> top);
+
+	struct Allocation
+	{
+		const void* Address = nullptr;
+		uint64 Size = 0;
+		const char* Name = nullptr;
+		/**
+		 * \brief Return addresses of the call stack, innermost first, to be looked up in a debugger or symbol file. The first ones are usually
+		 * inside the container which called the allocator reference, the ones after it lead to the code which owns the container. Unused frames are null.
+		 */
+		const void* Callstack[CALLSTACK_DEPTH]{};
+		AllocationStatistics::AllocatorType Allocator = AllocationStatistics::AllocatorType::SYSTEM;
+	};
+
+	/**
+	 * \brief Fills leaks with the biggest live allocations made since BeginFrames, biggest first.
+	 * \return Number of live allocations made since BeginFrames, which can be more than fit in leaks.
+	 */
+	static uint32 GetLeaks(GTSL::Ranger<Allocation> leaks, uint64* leakedBytes);
+
+	/**
+	 * \brief Number of allocations which weren't tracked because their shard was full.
+	 */
+	static uint64 GetDroppedCount() { return dropped.load(std::memory_order_relaxed); }
+
+private:
+	static constexpr uint32 SHARDS = 64;
+	static constexpr uint32 SHARD_CAPACITY = 4096;
+
+	static constexpr uint64 EMPTY = 0, RESERVED = 1, TOMBSTONE = 2;
+
+	struct Entry
+	{
+		/**
+		 * \brief Address of the allocation, or one of EMPTY, RESERVED(being written) and TOMBSTONE(removed). Published last so readers never see half written entries.
+		 */
+		std::atomic<uint64> Address{ EMPTY };
+		std::atomic<uint64> Size{ 0 };
+		std::atomic<const char*> Name{ nullptr };
+		std::atomic<const void*> Callstack[CALLSTACK_DEPTH]{};
+		std::atomic<AllocationStatistics::AllocatorType> Allocator{ AllocationStatistics::AllocatorType::SYSTEM };
+		std::atomic<uint8> Epoch{ 0 };
+	};
+
+	struct Shard
+	{
+		Entry Entries[SHARD_CAPACITY];
+	};
+
+	/**
+	 * \brief Allocated the first time an address hashes to them and kept until the process exits.
+	 */
+	inline static std::atomic<Shard*> shards[SHARDS]{};
+
+	inline static std::atomic<uint8> epoch{ 0 };
+	inline static std::atomic<uint64> dropped{ 0 };
+
+	static uint64 hash(const void* memory) { return (reinterpret_cast<uint64>(memory) >> 4) * 0x9E3779B97F4A7C15ull; }
+
+	static Shard* getShard(uint64 hash);
+
+	template<typename F>
+	static void forEachLive(F&& function);
+};
+
+#endif
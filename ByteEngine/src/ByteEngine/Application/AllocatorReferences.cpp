@@ -1,15 +1,47 @@
 #include "AllocatorReferences.h"
 
 #include "Application.h"
+#include "AllocationStatistics.h"
+#include "AllocationTracker.h"
 
-void BE::SystemAllocatorReference::Allocate(const uint64 size, const uint64 alignment, void** memory, uint64* allocatedSize) const { (*allocatedSize) = size;	BE::Application::Get()->GetSystemAllocator()->Allocate(size, alignment, memory); }
+void BE::SystemAllocatorReference::Allocate(const uint64 size, const uint64 alignment, void** memory, uint64* allocatedSize) const
+{
+	BE_STATISTICS_ONLY(AllocationStatistics::RecordAllocation(AllocationStatistics::AllocatorType::SYSTEM, Name, size))
+	(*allocatedSize) = size;	BE::Application::Get()->GetSystemAllocator()->Allocate(size, alignment, memory);
+	BE_TRACKING_ONLY(AllocationTracker::RecordAllocation(AllocationStatistics::AllocatorType::SYSTEM, Name, *memory, size))
+}
 
-void BE::SystemAllocatorReference::Deallocate(const uint64 size, const uint64 alignment, void* memory) const { BE::Application::Get()->GetSystemAllocator()->Deallocate(size, alignment, memory); }
+void BE::SystemAllocatorReference::Deallocate(const uint64 size, const uint64 alignment, void* memory) const
+{
+	BE_STATISTICS_ONLY(AllocationStatistics::RecordDeallocation(AllocationStatistics::AllocatorType::SYSTEM, Name, size))
+	BE_TRACKING_ONLY(AllocationTracker::RecordDeallocation(memory)) //before the memory is released, another thread could be given the same address right after
+	BE::Application::Get()->GetSystemAllocator()->Deallocate(size, alignment, memory);
+}
 
 void BE::TransientAllocatorReference::Allocate(const uint64 size, const uint64 alignment, void** memory, uint64* allocatedSize) const { BE::Application::Get()->GetTransientAllocator()->Allocate(size, alignment, memory, allocatedSize, Name); }
 
 void BE::TransientAllocatorReference::Deallocate(const uint64 size, const uint64 alignment, void* memory) const { BE::Application::Get()->GetTransientAllocator()->Deallocate(size, alignment, memory, Name); }
 
-void BE::PersistentAllocatorReference::Allocate(const uint64 size, const uint64 alignment, void** memory, uint64* allocatedSize) const { Application::Get()->GetNormalAllocator()->Allocate(size, alignment, memory, allocatedSize, Name); }
+void BE::PersistentAllocatorReference::Allocate(const uint64 size, const uint64 alignment, void** memory, uint64* allocatedSize) const
+{
+	Application::Get()->GetNormalAllocator()->Allocate(size, alignment, memory, allocatedSize, Name);
+	BE_TRACKING_ONLY(AllocationTracker::RecordAllocation(AllocationStatistics::AllocatorType::PERSISTENT, Name, *memory, size))
+}
 
-void BE::PersistentAllocatorReference::Deallocate(const uint64 size, const uint64 alignment, void* memory) const { Application::Get()->GetNormalAllocator()->Deallocate(size, alignment, memory, Name); }
\ No newline at end of file
+void BE::PersistentAllocatorReference::Deallocate(const uint64 size, const uint64 alignment, void* memory) const
+{
+	BE_TRACKING_ONLY(AllocationTracker::RecordDeallocation(memory))
+	Application::Get()->GetNormalAllocator()->Deallocate(size, alignment, memory, Name);
+}
+
+void BE::ComponentAllocatorReference::Allocate(const uint64 size, const uint64 alignment, void** memory, uint64* allocatedSize) const
+{
+	Application::Get()->GetMemoryBudget()->Allocate(size, alignment, memory, allocatedSize, Name);
+	BE_TRACKING_ONLY(AllocationTracker::RecordAllocation(AllocationStatistics::AllocatorType::PERSISTENT, Name, *memory, size))
+}
+
+void BE::ComponentAllocatorReference::Deallocate(const uint64 size, const uint64 alignment, void* memory) const
+{
+	BE_TRACKING_ONLY(AllocationTracker::RecordDeallocation(memory))
+	Application::Get()->GetMemoryBudget()->Deallocate(size, alignment, memory, Name);
+}
@@ -79,5 +79,29 @@ namespace BE
 		}
 	};
 
+	/**
+	 * \brief Allocates from the application's MemoryBudget arena, used for component arrays so they are reserved up front.
+	 */
+	struct ComponentAllocatorReference : BEAllocatorReference
+	{
+		void Allocate(uint64 size, uint64 alignment, void** memory, uint64* allocatedSize) const;
+
+		void Deallocate(uint64 size, uint64 alignment, void* memory) const;
+
+		ComponentAllocatorReference() = default;
+
+		ComponentAllocatorReference(const ComponentAllocatorReference& allocatorReference) : BEAllocatorReference(allocatorReference.Name, allocatorReference.IsDebugAllocation)
+		{
+		}
+
+		ComponentAllocatorReference& operator=(const ComponentAllocatorReference&) = default;
+
+		ComponentAllocatorReference(ComponentAllocatorReference&& componentAllocatorReference) = default;
+
+		explicit ComponentAllocatorReference(const char* name, const bool isDebugAllocation = false) : BEAllocatorReference(name, isDebugAllocation)
+		{
+		}
+	};
+
 	using TAR = TransientAllocatorReference;
 }
\ No newline at end of file
@@ -1,9 +1,13 @@
 #include "ByteEngine/Application/Application.h"
 
+#include <cstdio>
+
 #include <GTSL/FlatHashMap.h>
 #include <GTSL/StaticString.hpp>
 
+#include "ByteEngine/Application/AllocationTracker.h"
 #include "ByteEngine/Application/InputManager.h"
+#include "ByteEngine/Application/IOService.h"
 #include "ByteEngine/Application/ThreadPool.h"
 #include "ByteEngine/Application/Clock.h"
 
@@ -13,6 +17,7 @@
 
 #include "ByteEngine/Debug/FunctionTimer.h"
 #include "ByteEngine/Debug/Logger.h"
+#include "ByteEngine/Debug/TaskProfiler.h"
 
 #if (_DEBUG)
 void onAssert(const bool condition, const char* text, int line, const char* file, const char* function)
@@ -36,9 +41,16 @@ namespace BE
 	void Application::Initialize()
 	{
 		::new(&poolAllocator) PoolAllocator(&systemAllocatorReference);
-		::new(&transientAllocator) StackAllocator(&systemAllocatorReference, 2, 2, 2048 * 2048 * 2);
+		::new(&transientAllocator) StackAllocator(&systemAllocatorReference, 256 * 1024); //bigger allocations take the large allocation path
+		::new(&memoryBudget) MemoryBudget(&systemAllocatorReference, &poolAllocator);
 		
 		resourceManagers.Initialize(8, systemAllocatorReference);
+
+#ifdef BE_ALLOCATION_STATISTICS
+		uint64 allocated_size{ 0 };
+		systemAllocatorReference.Allocate(sizeof(AllocationStatistics::Snapshot) * 2, alignof(AllocationStatistics::Snapshot), reinterpret_cast<void**>(&allocationSnapshots), &allocated_size);
+		::new(allocationSnapshots) AllocationStatistics::Snapshot(); ::new(allocationSnapshots + 1) AllocationStatistics::Snapshot();
+#endif
 		
 		systemApplication.SetProcessPriority(GTSL::Application::Priority::HIGH);
 
@@ -51,6 +63,7 @@ namespace BE
 		clockInstance = new Clock();
 		inputManagerInstance = new InputManager();
 		threadPool = new ThreadPool();
+		ioService = new IOService();
 		
 		BE_DEBUG_ONLY(closeReason = GTSL::String(255, systemAllocatorReference));
 	}
@@ -62,20 +75,86 @@ namespace BE
 			BE_LOG_WARNING("Shutting down application!\nReason: ", closeReason.c_str())
 		}
 
+		gameInstance->WaitForFrames(this); //tasks of frames in flight still use the thread pool and might queue reads
+		ioService->Drain(); //completions add dynamic tasks no frame will run, the game instance frees their infos
+		delete ioService;
 		delete threadPool;
+
+#ifdef BE_DEBUG
+		{
+			//every thread which recorded tasks has finished by now, so the trace is complete
+			GTSL::StaticString<512> tracePath; tracePath += GetPathToApplication(); tracePath += "/TaskTrace.json";
+			TaskProfiler::WriteChromeTrace(tracePath);
+			BE_LOG_MESSAGE("Wrote task trace to ", tracePath.begin())
+		}
+#endif
 		
 		delete clockInstance;
 		delete inputManagerInstance;
 
 		gameInstance.Free();
+
+		if (memoryBudget.GetOverflowCount())
+		{
+			BE_LOG_WARNING("Component arrays grew ", memoryBudget.GetOverflowCount(), " times during frames, allocating ", memoryBudget.GetOverflowBytes(), " bytes. Raise the component budgets to avoid it.")
+		}
 		
-		transientAllocator.LockedClear();
+		memoryBudget.Free();
 		transientAllocator.Free();
-		StackAllocator::DebugData stack_allocator_debug_data(&systemAllocatorReference);
-		transientAllocator.GetDebugData(stack_allocator_debug_data);
-		BE_LOG_MESSAGE("Debug data: ", static_cast<GTSL::StaticString<1024>>(stack_allocator_debug_data));
+
+#ifdef BE_ALLOCATION_STATISTICS
+		{
+			//totals over the whole run are the difference to an empty snapshot
+			AllocationStatistics::TakeSnapshot(allocationSnapshots[0]); allocationSnapshots[1].Clear();
+
+			AllocationStatistics::NameStatistics top[8];
+			const auto count = AllocationStatistics::GetTopAllocators(allocationSnapshots[0], allocationSnapshots[1], AllocationStatistics::SortBy::BYTES, GTSL::Ranger<AllocationStatistics::NameStatistics>(8, top));
+
+			for (uint32 i = 0; i < count; ++i)
+			{
+				BE_LOG_MESSAGE("Allocations by ", top[i].Name, ": ", top[i].BytesAllocated, " bytes in ", top[i].Allocations, " allocations");
+			}
+
+			systemAllocatorReference.Deallocate(sizeof(AllocationStatistics::Snapshot) * 2, alignof(AllocationStatistics::Snapshot), allocationSnapshots);
+		}
+#endif
 
 		poolAllocator.Free();
+
+#ifdef BE_ALLOCATION_TRACKING
+		{
+			//everything owned by the game has been released by now, what's left from frames leaked. Startup allocations still owned by the application are expected
+			AllocationTracker::Allocation leaks[16]; uint64 leakedBytes{ 0 };
+			const auto leakCount = AllocationTracker::GetLeaks(GTSL::Ranger<AllocationTracker::Allocation>(16, leaks), &leakedBytes);
+
+			if (leakCount)
+			{
+				BE_LOG_WARNING("Leaked ", leakCount, " allocations, ", leakedBytes, " bytes. Biggest ones:")
+
+				for (uint32 i = 0; i < leakCount && i < 16; ++i)
+				{
+					//in hex so they can be looked up in a debugger or with addr2line
+					char callstack[AllocationTracker::CALLSTACK_DEPTH * 24 + 1]{}; uint32 length = 0;
+					for (uint8 f = 0; f < AllocationTracker::CALLSTACK_DEPTH && leaks[i].Callstack[f]; ++f)
+					{
+						length += snprintf(callstack + length, sizeof(callstack) - length, f ? " <- 0x%llx" : "0x%llx", static_cast<unsigned long long>(reinterpret_cast<uint64>(leaks[i].Callstack[f])));
+					}
+
+					BE_LOG_WARNING(leaks[i].Size, " bytes by ", leaks[i].Name, ", allocated from ", callstack)
+				}
+			}
+
+			AllocationTracker::LiveMemory live[8];
+			const auto liveCount = AllocationTracker::GetLiveMemoryByName(GTSL::Ranger<AllocationTracker::LiveMemory>(8, live));
+
+			for (uint32 i = 0; i < liveCount; ++i)
+			{
+				BE_LOG_MESSAGE("Live at shutdown, by ", live[i].Name, ": ", live[i].Bytes, " bytes in ", live[i].Allocations, " allocations")
+			}
+
+			if (AllocationTracker::GetDroppedCount()) { BE_LOG_WARNING(AllocationTracker::GetDroppedCount(), " allocations weren't tracked, the tracking table was full") }
+		}
+#endif
 		
 		logger->Shutdown();
 	}
@@ -102,7 +181,10 @@ namespace BE
 	}
 
 	int Application::Run(int argc, char** argv)
-	{		
+	{
+		memoryBudget.BeginFrames(); //component arrays should have been sized at startup, growing from here on is an overflow
+		BE_TRACKING_ONLY(AllocationTracker::BeginFrames())
+		
 		while (!flaggedForClose)
 		{
 			systemApplication.Update();
@@ -112,8 +194,15 @@ namespace BE
 			OnUpdateInfo update_info{};
 			update_info.UpdateContext = updateContext;
 			OnUpdate(update_info);
+
+			ioService->Submit(); //reads requested during the frame go to the OS as one batch
 			
-			transientAllocator.LockedClear();
+			transientAllocator.Clear(); //frames in flight keep using the memory of their frame, it's only reused StackAllocator::FRAME_COUNT frames later
+
+#ifdef BE_ALLOCATION_STATISTICS
+			lastAllocationSnapshot = !lastAllocationSnapshot;
+			AllocationStatistics::TakeSnapshot(allocationSnapshots[lastAllocationSnapshot]);
+#endif
 
 			++applicationTicks;
 		}
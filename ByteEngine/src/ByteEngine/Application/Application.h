@@ -7,6 +7,8 @@
 #include <GTSL/FlatHashMap.h>
 #include <GTSL/String.hpp>
 
+#include "AllocationStatistics.h"
+#include "MemoryBudget.h"
 #include "PoolAllocator.h"
 #include "StackAllocator.h"
 #include "SystemAllocator.h"
@@ -15,6 +17,7 @@ class ResourceManager;
 class GameInstance;
 class InputManager;
 class ThreadPool;
+class IOService;
 class Clock;
 
 #undef ERROR
@@ -98,10 +101,23 @@ namespace BE
 		T* GetResourceManager(const GTSL::Id64 name) { return static_cast<T*>(resourceManagers.At(name).GetData()); }
 		
 		[[nodiscard]] ThreadPool* GetThreadPool() const { return threadPool; }
+		[[nodiscard]] IOService* GetIOService() const { return ioService; }
 		
 		[[nodiscard]] SystemAllocator* GetSystemAllocator() const { return systemAllocator; }
 		[[nodiscard]] PoolAllocator* GetNormalAllocator() { return &poolAllocator; }
 		[[nodiscard]] StackAllocator* GetTransientAllocator() { return &transientAllocator; }
+		[[nodiscard]] MemoryBudget* GetMemoryBudget() { return &memoryBudget; }
+
+#ifdef BE_ALLOCATION_STATISTICS
+		/**
+		 * \brief Fills top with the allocation names which allocated the most during the last frame, biggest first.
+		 * \return Number of entries written to top.
+		 */
+		uint32 GetFrameTopAllocators(const AllocationStatistics::SortBy sortBy, const GTSL::Ranger<AllocationStatistics::NameStatistics> top) const
+		{
+			return AllocationStatistics::GetTopAllocators(allocationSnapshots[lastAllocationSnapshot], allocationSnapshots[!lastAllocationSnapshot], sortBy, top);
+		}
+#endif
 
 	protected:
 		GTSL::SmartPointer<Logger, SystemAllocatorReference> logger;
@@ -113,12 +129,22 @@ namespace BE
 		SystemAllocator* systemAllocator{ nullptr };
 		PoolAllocator poolAllocator;
 		StackAllocator transientAllocator;
+		MemoryBudget memoryBudget;
+
+#ifdef BE_ALLOCATION_STATISTICS
+		/**
+		 * \brief Allocation statistics at the end of the last two frames.
+		 */
+		AllocationStatistics::Snapshot* allocationSnapshots{ nullptr };
+		uint8 lastAllocationSnapshot{ 0 };
+#endif
 
 		GTSL::Application systemApplication;
 
 		Clock* clockInstance{ nullptr };
 		InputManager* inputManagerInstance{ nullptr };
 		ThreadPool* threadPool = nullptr;
+		IOService* ioService = nullptr;
 
 		UpdateContext updateContext{ UpdateContext::NORMAL };
 
@@ -2,6 +2,18 @@
 
 #ifdef BE_PLATFORM_WIN
 #include <Windows.h>
+#elif defined(BE_PLATFORM_LINUX)
+#include <ctime>
+#endif
+
+#if defined(BE_PLATFORM_LINUX)
+namespace
+{
+	//monotonic clock ticks are nanoseconds, so the processor frequency is fixed
+	uint64 getTicks() { timespec ticks; clock_gettime(CLOCK_MONOTONIC, &ticks); return static_cast<uint64>(ticks.tv_sec) * 1000000000ull + static_cast<uint64>(ticks.tv_nsec); }
+
+	tm getLocalTime() { const time_t now = time(nullptr); tm localTime; localtime_r(&now, &localTime); return localTime; }
+}
 #endif
 
 Clock::Clock()
@@ -16,6 +28,10 @@ Clock::Clock()
 	processorFrequency = WinProcessorFrequency.QuadPart;
 	startPerformanceCounterTicks = WinProcessorTicks.QuadPart;
 	performanceCounterTicks = WinProcessorTicks.QuadPart;
+#elif defined(BE_PLATFORM_LINUX)
+	processorFrequency = 1000000000ull;
+	startPerformanceCounterTicks = getTicks();
+	performanceCounterTicks = startPerformanceCounterTicks;
 #endif
 }
 
@@ -45,6 +61,20 @@ void Clock::OnUpdate()
 	
 	//Set system ticks as this frame's ticks so in the next update we can work with it.
 	performanceCounterTicks = current_ticks.QuadPart;
+#elif defined(BE_PLATFORM_LINUX)
+	const uint64 current_ticks = getTicks();
+
+	//Large deltas are dropped for the same reasons as on Windows.
+	const auto delta_time = GTSL::Microseconds((current_ticks - performanceCounterTicks) / 1000);
+
+	if (delta_time < static_cast<GTSL::Microseconds>(GTSL::Seconds(1)))
+	{
+		deltaTime = delta_time;
+	}
+
+	elapsedTime += delta_time;
+
+	performanceCounterTicks = current_ticks;
 #endif
 }
 
@@ -54,6 +84,8 @@ GTSL::Microseconds Clock::GetCurrentMicroseconds() const
 {
 #ifdef BE_PLATFORM_WIN
 	LARGE_INTEGER win_processor_ticks; QueryPerformanceCounter(&win_processor_ticks); return GTSL::Microseconds(win_processor_ticks.QuadPart * 1000000 / processorFrequency);
+#elif defined(BE_PLATFORM_LINUX)
+	return GTSL::Microseconds(getTicks() / 1000);
 #endif
 }
 
@@ -66,6 +98,8 @@ uint16 Clock::GetYear()
 	SYSTEMTIME WinTimeStructure;
 	GetLocalTime(&WinTimeStructure);
 	return WinTimeStructure.wYear;
+#elif defined(BE_PLATFORM_LINUX)
+	return static_cast<uint16>(getLocalTime().tm_year + 1900);
 #endif
 }
 
@@ -75,6 +109,8 @@ Months Clock::GetMonth()
 	SYSTEMTIME WinTimeStructure;
 	GetLocalTime(&WinTimeStructure);
 	return static_cast<Months>(WinTimeStructure.wMonth);
+#elif defined(BE_PLATFORM_LINUX)
+	return static_cast<Months>(getLocalTime().tm_mon + 1);
 #endif
 }
 
@@ -84,6 +120,8 @@ uint8 Clock::GetDayOfMonth()
 	SYSTEMTIME WinTimeStructure;
 	GetLocalTime(&WinTimeStructure);
 	return WinTimeStructure.wDay;
+#elif defined(BE_PLATFORM_LINUX)
+	return static_cast<uint8>(getLocalTime().tm_mday);
 #endif
 }
 
@@ -93,6 +131,9 @@ Days Clock::GetDayOfWeek()
 	SYSTEMTIME WinTimeStructure;
 	GetLocalTime(&WinTimeStructure);
 	return (WinTimeStructure.wDayOfWeek == 0) ? Days::Sunday : static_cast<Days>(WinTimeStructure.wDayOfWeek);
+#elif defined(BE_PLATFORM_LINUX)
+	const auto dayOfWeek = getLocalTime().tm_wday;
+	return (dayOfWeek == 0) ? Days::Sunday : static_cast<Days>(dayOfWeek);
 #endif
 }
 
@@ -102,5 +143,8 @@ Time Clock::GetTime()
 	SYSTEMTIME WinTimeStructure;
 	GetLocalTime(&WinTimeStructure);
 	return { static_cast<uint8>(WinTimeStructure.wHour), static_cast<uint8>(WinTimeStructure.wMinute), static_cast<uint8>(WinTimeStructure.wSecond) };
+#elif defined(BE_PLATFORM_LINUX)
+	const auto localTime = getLocalTime();
+	return { static_cast<uint8>(localTime.tm_hour), static_cast<uint8>(localTime.tm_min), static_cast<uint8>(localTime.tm_sec) };
 #endif
 }
@@ -26,10 +26,16 @@ struct SystemAllocatorReference : GTSL::AllocatorReference
 
 inline SystemAllocatorReference system_allocator_reference;
 
+//Command line the program was started with, set before CreateApplication() is called so applications can be configured from it.
+inline int application_argc = 0;
+inline char** application_argv = nullptr;
+
 extern GTSL::SmartPointer<BE::Application, SystemAllocatorReference> CreateApplication(const SystemAllocatorReference&); //Is defined in another translation unit.
 
 int main(int argc, char** argv)
 {	
+	application_argc = argc; application_argv = argv;
+
 	//When CreateApplication() is defined it must return a new object of it class, effectively letting us manage that instance from here.
 	auto application = CreateApplication(system_allocator_reference);
 
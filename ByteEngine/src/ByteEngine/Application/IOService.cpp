@@ -0,0 +1,394 @@
+#include "IOService.h"
+
+#include <GTSL/Memory.h>
+
+#include "ByteEngine/Debug/Assert.h"
+
+#if defined(BE_PLATFORM_WIN)
+#include <Windows.h>
+#elif defined(BE_PLATFORM_LINUX)
+#include <cerrno>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#if defined(BE_PLATFORM_LINUX)
+/**
+ * \brief Mappings of an io_uring's submission and completion queues. The kernel reads the submission queue's tail and writes it's head,
+ * and the other way around for the completion queue, those are accessed atomically.
+ */
+struct IOService::Ring
+{
+	int FileDescriptor = -1;
+
+	void* SubmissionRing = nullptr; uint64 SubmissionRingSize = 0;
+	void* CompletionRing = nullptr; uint64 CompletionRingSize = 0;
+	io_uring_sqe* Entries = nullptr; uint64 EntriesSize = 0;
+
+	uint32* SubmissionHead = nullptr; uint32* SubmissionTail = nullptr; uint32* SubmissionArray = nullptr; uint32 SubmissionMask = 0;
+	uint32* CompletionHead = nullptr; uint32* CompletionTail = nullptr; io_uring_cqe* Completions = nullptr; uint32 CompletionMask = 0;
+
+	/**
+	 * \brief One per request, reads are issued as readv, available since the first kernel with io_uring.
+	 */
+	iovec Vectors[MAX_IN_FLIGHT];
+};
+
+/**
+ * \brief User data of the no-op which wakes the completion thread up on shutdown.
+ */
+static constexpr uint64 WAKE_UP = 0xFFFFFFFFFFFFFFFFull;
+
+static uint32 loadAcquire(const uint32* value) { return std::atomic_ref<const uint32>(*value).load(std::memory_order_acquire); }
+static void storeRelease(uint32* value, const uint32 newValue) { std::atomic_ref<uint32>(*value).store(newValue, std::memory_order_release); }
+
+static int enterRing(const int ring, const uint32 toSubmit, const uint32 minComplete, const uint32 flags)
+{
+	return static_cast<int>(syscall(__NR_io_uring_enter, ring, toSubmit, minComplete, flags, nullptr, 0));
+}
+#else
+struct IOService::Ring {};
+#endif
+
+IOService::IOService() : Object("IOService")
+{
+	for (uint32 i = 0; i < MAX_IN_FLIGHT; ++i) { requests[i].NextFree = i + 1 < MAX_IN_FLIGHT ? i + 1 : NO_REQUEST; }
+
+#if defined(BE_PLATFORM_LINUX)
+	if (createRing())
+	{
+		auto completionLoop = [](IOService* ioService)
+		{
+			auto* ring = ioService->ring;
+
+			while (true)
+			{
+				uint32 head = *ring->CompletionHead;
+				const uint32 tail = loadAcquire(ring->CompletionTail);
+
+				if (head == tail)
+				{
+					if (ioService->done.load(std::memory_order_acquire) && !ioService->inFlight.load(std::memory_order_acquire)) { break; }
+					enterRing(ring->FileDescriptor, 0, 1, IORING_ENTER_GETEVENTS);
+					continue;
+				}
+
+				for (; head != tail; ++head)
+				{
+					const auto& completion = ring->Completions[head & ring->CompletionMask];
+					const uint64 request = completion.user_data; const int32 result = completion.res;
+
+					//the slot is handed back before running the callback, which can take a while, the values needed were copied
+					storeRelease(ring->CompletionHead, head + 1);
+
+					if (request == WAKE_UP) { continue; }
+					ioService->complete(static_cast<uint32>(request), result > 0 ? static_cast<uint64>(result) : 0);
+				}
+			}
+		};
+
+		threads.EmplaceBack(GetPersistentAllocator(), 0, GTSL::Delegate<void(IOService*)>::Create(completionLoop), this);
+	}
+	else
+#endif
+	{
+		auto ioLoop = [](IOService* ioService)
+		{
+			while (true)
+			{
+				const auto epoch = ioService->submitEpoch.load(std::memory_order_acquire);
+				uint32 request = NO_REQUEST;
+
+				{
+					GTSL::Lock lock(ioService->mutex);
+					if (ioService->queueHead != ioService->queueSubmitted) { request = ioService->queue[ioService->queueHead++ % MAX_IN_FLIGHT]; }
+				}
+
+				if (request == NO_REQUEST)
+				{
+					if (ioService->done.load(std::memory_order_acquire)) { break; }
+					ioService->submitEpoch.wait(epoch, std::memory_order_acquire);
+					continue;
+				}
+
+				const auto& read = ioService->requests[request].Read;
+				ioService->complete(request, readAt(read.File, read.Offset, read.Buffer));
+			}
+		};
+
+		for (uint8 i = 0; i < IO_THREADS; ++i)
+		{
+			threads.EmplaceBack(GetPersistentAllocator(), i, GTSL::Delegate<void(IOService*)>::Create(ioLoop), this);
+		}
+	}
+}
+
+IOService::~IOService()
+{
+	Submit();
+	done.store(true, std::memory_order_release);
+
+#if defined(BE_PLATFORM_LINUX)
+	if (ring)
+	{
+		GTSL::Lock lock(mutex);
+
+		//the completion thread may be waiting for completions while nothing is in flight, a no-op gets it out
+		const uint32 tail = *ring->SubmissionTail, index = tail & ring->SubmissionMask;
+		auto& entry = ring->Entries[index];
+		GTSL::SetMemory(sizeof(io_uring_sqe), &entry);
+		entry.opcode = IORING_OP_NOP; entry.user_data = WAKE_UP;
+		ring->SubmissionArray[index] = index;
+		storeRelease(ring->SubmissionTail, tail + 1);
+		++ringQueued;
+
+		submit();
+	}
+#endif
+
+	submitEpoch.fetch_add(1, std::memory_order_release); submitEpoch.notify_all();
+
+	for (auto& thread : threads) { thread.Join(GetPersistentAllocator()); }
+
+	destroyRing();
+}
+
+IOService::FileHandle IOService::OpenFile(const char* path)
+{
+#if defined(BE_PLATFORM_WIN)
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+	return file == INVALID_HANDLE_VALUE ? INVALID_FILE : reinterpret_cast<FileHandle>(file);
+#elif defined(BE_PLATFORM_LINUX)
+	const int file = open(path, O_RDONLY | O_CLOEXEC);
+	return file == -1 ? INVALID_FILE : static_cast<FileHandle>(file);
+#else
+#error "IOService has no file backend for this platform!"
+#endif
+}
+
+void IOService::CloseFile(const FileHandle file)
+{
+	if (file == INVALID_FILE) { return; }
+
+#if defined(BE_PLATFORM_WIN)
+	CloseHandle(reinterpret_cast<HANDLE>(file));
+#elif defined(BE_PLATFORM_LINUX)
+	close(static_cast<int>(file));
+#endif
+}
+
+void IOService::Read(const ReadRequest& readRequest)
+{
+	BE_ASSERT(readRequest.File != INVALID_FILE, "Reading from a file which couldn't be opened!")
+
+	GTSL::Lock lock(mutex);
+
+	while (freeRequest == NO_REQUEST) //every request is in flight, get the queued ones going and wait for one to complete
+	{
+		submit();
+		mutex.Unlock();
+		inFlight.wait(MAX_IN_FLIGHT, std::memory_order_acquire);
+		mutex.Lock();
+	}
+
+	const uint32 request = freeRequest;
+	freeRequest = requests[request].NextFree;
+	requests[request].Read = readRequest;
+	inFlight.fetch_add(1, std::memory_order_relaxed);
+
+#if defined(BE_PLATFORM_LINUX)
+	if (ring)
+	{
+		ring->Vectors[request].iov_base = readRequest.Buffer.begin(); ring->Vectors[request].iov_len = readRequest.Buffer.Bytes();
+
+		//never full, there are as many submission queue entries as requests
+		const uint32 tail = *ring->SubmissionTail, index = tail & ring->SubmissionMask;
+		auto& entry = ring->Entries[index];
+		GTSL::SetMemory(sizeof(io_uring_sqe), &entry);
+		entry.opcode = IORING_OP_READV;
+		entry.fd = static_cast<int>(readRequest.File);
+		entry.off = readRequest.Offset;
+		entry.addr = reinterpret_cast<uint64>(&ring->Vectors[request]);
+		entry.len = 1;
+		entry.user_data = request;
+		ring->SubmissionArray[index] = index;
+		storeRelease(ring->SubmissionTail, tail + 1);
+
+		if (++ringQueued >= BATCH_SIZE) { submit(); }
+		return;
+	}
+#endif
+
+	queue[queueTail++ % MAX_IN_FLIGHT] = request;
+	if (queueTail - queueSubmitted >= BATCH_SIZE) { submit(); }
+}
+
+void IOService::Submit()
+{
+	GTSL::Lock lock(mutex);
+	submit();
+}
+
+void IOService::Drain()
+{
+	Submit();
+
+	//completion callbacks run before their read stops counting as in flight
+	for (uint32 count = inFlight.load(std::memory_order_acquire); count; count = inFlight.load(std::memory_order_acquire)) { inFlight.wait(count, std::memory_order_acquire); }
+}
+
+void IOService::submit()
+{
+#if defined(BE_PLATFORM_LINUX)
+	if (ring)
+	{
+		while (ringQueued)
+		{
+			const int submitted = enterRing(ring->FileDescriptor, ringQueued, 0, 0);
+
+			if (submitted < 0)
+			{
+				if (errno == EINTR || errno == EAGAIN || errno == EBUSY) { continue; }
+				BE_LOG_ERROR("io_uring submission failed, errno: ", errno)
+				break;
+			}
+
+			ringQueued -= static_cast<uint32>(submitted);
+		}
+
+		return;
+	}
+#endif
+
+	if (queueSubmitted == queueTail) { return; }
+
+	queueSubmitted = queueTail;
+	submitEpoch.fetch_add(1, std::memory_order_release); submitEpoch.notify_all();
+}
+
+void IOService::complete(const uint32 request, const uint64 bytesRead)
+{
+	auto& read = requests[request].Read;
+	read.OnDone(read.UserData, bytesRead);
+
+	{
+		GTSL::Lock lock(mutex);
+		requests[request].NextFree = freeRequest; freeRequest = request;
+	}
+
+	inFlight.fetch_sub(1, std::memory_order_release); inFlight.notify_all();
+}
+
+uint64 IOService::readAt(const FileHandle file, const uint64 offset, const GTSL::Ranger<byte> buffer)
+{
+	uint64 bytesRead = 0;
+
+#if defined(BE_PLATFORM_WIN)
+	while (bytesRead < buffer.Bytes())
+	{
+		//a positional read on a handle opened without FILE_FLAG_OVERLAPPED, the offset goes in the OVERLAPPED but the call blocks
+		OVERLAPPED overlapped{}; const uint64 position = offset + bytesRead;
+		overlapped.Offset = static_cast<DWORD>(position); overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+
+		DWORD read = 0; const uint64 remaining = buffer.Bytes() - bytesRead;
+		const DWORD toRead = static_cast<DWORD>(remaining < 0x80000000ull ? remaining : 0x80000000ull);
+		if (!ReadFile(reinterpret_cast<HANDLE>(file), buffer.begin() + bytesRead, toRead, &read, &overlapped) || !read) { break; }
+		bytesRead += read;
+	}
+#elif defined(BE_PLATFORM_LINUX)
+	while (bytesRead < buffer.Bytes())
+	{
+		const ssize_t read = pread(static_cast<int>(file), buffer.begin() + bytesRead, buffer.Bytes() - bytesRead, static_cast<off_t>(offset + bytesRead));
+		if (read < 0 && errno == EINTR) { continue; }
+		if (read <= 0) { break; }
+		bytesRead += static_cast<uint64>(read);
+	}
+#endif
+
+	return bytesRead;
+}
+
+bool IOService::createRing()
+{
+#if defined(BE_PLATFORM_LINUX)
+	io_uring_params parameters{};
+	const int fileDescriptor = static_cast<int>(syscall(__NR_io_uring_setup, MAX_IN_FLIGHT, &parameters));
+
+	if (fileDescriptor < 0)
+	{
+		BE_LOG_MESSAGE("io_uring is not available, errno: ", errno, ". Reading with I/O threads.")
+		return false;
+	}
+
+	void* memory{ nullptr };
+	GTSL::Allocate(sizeof(Ring), &memory);
+	ring = ::new(memory) Ring();
+	ring->FileDescriptor = fileDescriptor;
+
+	ring->SubmissionRingSize = parameters.sq_off.array + parameters.sq_entries * sizeof(uint32);
+	ring->CompletionRingSize = parameters.cq_off.cqes + parameters.cq_entries * sizeof(io_uring_cqe);
+
+	//newer kernels map both queues with a single mapping
+	if (parameters.features & IORING_FEAT_SINGLE_MMAP)
+	{
+		if (ring->CompletionRingSize > ring->SubmissionRingSize) { ring->SubmissionRingSize = ring->CompletionRingSize; }
+		ring->CompletionRingSize = ring->SubmissionRingSize;
+	}
+
+	ring->SubmissionRing = mmap(nullptr, ring->SubmissionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fileDescriptor, IORING_OFF_SQ_RING);
+	ring->CompletionRing = parameters.features & IORING_FEAT_SINGLE_MMAP ? ring->SubmissionRing :
+		mmap(nullptr, ring->CompletionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fileDescriptor, IORING_OFF_CQ_RING);
+
+	ring->EntriesSize = parameters.sq_entries * sizeof(io_uring_sqe);
+	void* entries = mmap(nullptr, ring->EntriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fileDescriptor, IORING_OFF_SQES);
+
+	if (ring->SubmissionRing == MAP_FAILED || ring->CompletionRing == MAP_FAILED || entries == MAP_FAILED)
+	{
+		if (ring->SubmissionRing == MAP_FAILED) { ring->SubmissionRing = nullptr; }
+		if (ring->CompletionRing == MAP_FAILED) { ring->CompletionRing = nullptr; }
+		if (entries != MAP_FAILED) { ring->Entries = static_cast<io_uring_sqe*>(entries); }
+
+		BE_LOG_MESSAGE("Couldn't map io_uring queues. Reading with I/O threads.")
+		destroyRing();
+		return false;
+	}
+
+	ring->Entries = static_cast<io_uring_sqe*>(entries);
+
+	auto* submissionRing = static_cast<byte*>(ring->SubmissionRing);
+	ring->SubmissionHead = reinterpret_cast<uint32*>(submissionRing + parameters.sq_off.head);
+	ring->SubmissionTail = reinterpret_cast<uint32*>(submissionRing + parameters.sq_off.tail);
+	ring->SubmissionMask = *reinterpret_cast<uint32*>(submissionRing + parameters.sq_off.ring_mask);
+	ring->SubmissionArray = reinterpret_cast<uint32*>(submissionRing + parameters.sq_off.array);
+
+	auto* completionRing = static_cast<byte*>(ring->CompletionRing);
+	ring->CompletionHead = reinterpret_cast<uint32*>(completionRing + parameters.cq_off.head);
+	ring->CompletionTail = reinterpret_cast<uint32*>(completionRing + parameters.cq_off.tail);
+	ring->CompletionMask = *reinterpret_cast<uint32*>(completionRing + parameters.cq_off.ring_mask);
+	ring->Completions = reinterpret_cast<io_uring_cqe*>(completionRing + parameters.cq_off.cqes);
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+void IOService::destroyRing()
+{
+#if defined(BE_PLATFORM_LINUX)
+	if (!ring) { return; }
+
+	if (ring->Entries) { munmap(ring->Entries, ring->EntriesSize); }
+	if (ring->CompletionRing && ring->CompletionRing != ring->SubmissionRing) { munmap(ring->CompletionRing, ring->CompletionRingSize); }
+	if (ring->SubmissionRing) { munmap(ring->SubmissionRing, ring->SubmissionRingSize); }
+	close(ring->FileDescriptor);
+
+	ring->~Ring();
+	GTSL::Deallocate(sizeof(Ring), ring);
+	ring = nullptr;
+#endif
+}
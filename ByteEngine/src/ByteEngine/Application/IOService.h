@@ -0,0 +1,133 @@
+#pragma once
+
+#include "ByteEngine/Core.h"
+#include "ByteEngine/Object.h"
+
+#include <atomic>
+
+#include <GTSL/Array.hpp>
+#include <GTSL/Delegate.hpp>
+#include <GTSL/Mutex.h>
+#include <GTSL/Ranger.h>
+#include <GTSL/Thread.h>
+
+/**
+ * \brief Reads files asynchronously for resource managers, so loads don't block the task requesting them.
+ * Reads are queued with Read and handed to the OS in batches, once per frame by the application through Submit or earlier when a batch fills up.
+ * On Linux reads go through an io_uring, a single thread waits on it's completion queue and runs the completion callbacks.
+ * Where io_uring isn't available(other platforms or kernels without it) a few I/O threads do blocking positional reads instead.
+ * Completion callbacks run on I/O threads, they should just hand the result over to a dynamic task, see GameInstance::AddDynamicTask.
+ */
+class IOService : public Object
+{
+public:
+	IOService();
+
+	/**
+	 * \brief Waits for every queued and in flight read to complete.
+	 */
+	~IOService();
+
+	using FileHandle = uint64;
+	static constexpr FileHandle INVALID_FILE = ~0ull;
+
+	/**
+	 * \brief Opens a file for reading through the service. Reads don't share a file pointer, so any number of them can be in flight on the same file.
+	 * \return INVALID_FILE if the file couldn't be opened.
+	 */
+	static FileHandle OpenFile(const char* path);
+	static void CloseFile(FileHandle file);
+
+	struct ReadRequest
+	{
+		FileHandle File = INVALID_FILE;
+		uint64 Offset = 0;
+
+		/**
+		 * \brief Buffer to read to, it's size is the number of bytes to read. Must stay alive until the read completes.
+		 */
+		GTSL::Ranger<byte> Buffer;
+
+		/**
+		 * \brief Called from an I/O thread once the read is done, with UserData and the number of bytes read, less than requested if the read failed.
+		 */
+		GTSL::Delegate<void(void*, uint64)> OnDone;
+		void* UserData = nullptr;
+	};
+
+	/**
+	 * \brief Queues a read to be submitted with the current batch. Can be called from any thread.
+	 * Blocks while MAX_IN_FLIGHT reads are already in flight.
+	 */
+	void Read(const ReadRequest& readRequest);
+
+	/**
+	 * \brief Hands every queued read over to the OS.
+	 */
+	void Submit();
+
+	/**
+	 * \brief Submits every queued read and waits for them and every read in flight to complete, including their completion callbacks.
+	 * Reads queued meanwhile are waited for too, so stop whatever issues reads first.
+	 */
+	void Drain();
+
+	[[nodiscard]] uint32 GetInFlightCount() const { return inFlight.load(std::memory_order_relaxed); }
+	[[nodiscard]] bool IsUsingIOUring() const { return ring; }
+
+private:
+	static constexpr uint32 MAX_IN_FLIGHT = 256;
+
+	/**
+	 * \brief Number of queued reads which causes a submission without waiting for Submit.
+	 */
+	static constexpr uint32 BATCH_SIZE = 32;
+	static constexpr uint8 IO_THREADS = 4;
+	static constexpr uint32 NO_REQUEST = 0xFFFFFFFF;
+
+	struct Request
+	{
+		ReadRequest Read;
+		uint32 NextFree = NO_REQUEST;
+	};
+
+	/**
+	 * \brief MAX_IN_FLIGHT request records, a read holds one from Read until it's completion callback has run.
+	 */
+	Request requests[MAX_IN_FLIGHT];
+	uint32 freeRequest{ 0 };
+
+	/**
+	 * \brief Guards the free requests, the queue and the submission queue of the io_uring.
+	 */
+	GTSL::Mutex mutex;
+
+	/**
+	 * \brief Requests in order of arrival for the I/O threads, [queueHead, queueSubmitted) can be taken by them, [queueSubmitted, queueTail) wait for Submit.
+	 * Never holds more than MAX_IN_FLIGHT requests.
+	 */
+	uint32 queue[MAX_IN_FLIGHT];
+	uint32 queueHead{ 0 }, queueSubmitted{ 0 }, queueTail{ 0 };
+
+	/**
+	 * \brief Reads queued in the io_uring's submission queue which haven't been submitted yet.
+	 */
+	uint32 ringQueued{ 0 };
+
+	alignas(64) std::atomic<uint32> inFlight{ 0 };
+	alignas(64) std::atomic<uint32> submitEpoch{ 0 };
+	std::atomic<bool> done{ false };
+
+	struct Ring;
+	Ring* ring{ nullptr };
+
+	GTSL::Array<GTSL::Thread, IO_THREADS> threads;
+
+	bool createRing();
+	void destroyRing();
+
+	void submit();
+	void complete(uint32 request, uint64 bytesRead);
+
+	static uint64 readAt(FileHandle file, uint64 offset, GTSL::Ranger<byte> buffer);
+};
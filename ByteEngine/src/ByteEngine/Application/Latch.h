@@ -0,0 +1,40 @@
+#pragma once
+
+#include "ByteEngine/Core.h"
+
+#include <atomic>
+
+/**
+ * \brief Countdown latch. Threads waiting on it are released once the count reaches zero.
+ * The count may be raised at any point while it's not zero, tasks announce themselves with Add and signal completion with CountDown.
+ */
+class Latch
+{
+public:
+	Latch() = default;
+
+	void Reset(const uint32 count) { counter.store(count, std::memory_order_release); }
+
+	void Add(const uint32 count = 1) { counter.fetch_add(count, std::memory_order_relaxed); }
+
+	void CountDown()
+	{
+		if (counter.fetch_sub(1, std::memory_order_acq_rel) == 1) { counter.notify_all(); }
+	}
+
+	[[nodiscard]] bool IsDone() const { return counter.load(std::memory_order_acquire) == 0; }
+
+	/**
+	 * \brief Blocks the calling thread until the count reaches zero.
+	 */
+	void Wait() const
+	{
+		for (auto count = counter.load(std::memory_order_acquire); count != 0; count = counter.load(std::memory_order_acquire))
+		{
+			counter.wait(count, std::memory_order_acquire);
+		}
+	}
+
+private:
+	std::atomic<uint32> counter{ 0 };
+};
@@ -0,0 +1,88 @@
+#include "MemoryBudget.h"
+
+#include <GTSL/Math/Math.hpp>
+
+#include "PoolAllocator.h"
+#include "SystemAllocator.h"
+#include "ByteEngine/Debug/Assert.h"
+
+MemoryBudget::MemoryBudget(BE::SystemAllocatorReference* allocatorReference, PoolAllocator* fallbackAllocator) : allocatorReference(allocatorReference), fallbackAllocator(fallbackAllocator)
+{
+}
+
+void MemoryBudget::DeclareComponents(const GTSL::Id64 systemName, const uint32 count, const uint32 bytesPerComponent)
+{
+	BE_ASSERT(!arena, "Component budgets have to be declared before the first system is added!")
+
+	for (auto& e : declarations)
+	{
+		if (e.Name == systemName) { e.Count = count; e.BytesPerComponent = bytesPerComponent; return; }
+	}
+
+	BE_ASSERT(declarations.GetLength() < MAX_DECLARATIONS, "Too many component budgets!")
+	declarations.EmplaceBack(Declaration{ systemName, count, bytesPerComponent });
+}
+
+uint32 MemoryBudget::GetComponentCount(const GTSL::Id64 systemName) const
+{
+	for (const auto& e : declarations) { if (e.Name == systemName) { return e.Count; } }
+	return DEFAULT_COMPONENT_COUNT;
+}
+
+void MemoryBudget::Reserve()
+{
+	if (arena || !declarations.GetLength()) { return; }
+
+	uint64 size = 0;
+	for (const auto& e : declarations) { size += static_cast<uint64>(e.Count) * e.BytesPerComponent + ARRAY_ALIGNMENT * ARRAYS_PER_SYSTEM; }
+
+	//big arenas are backed by huge pages since component arrays are walked every frame
+	arenaAlignment = size >= SystemAllocator::HUGE_PAGE_SIZE ? SystemAllocator::HUGE_PAGE_SIZE : SystemAllocator::PAGE_SIZE;
+	arenaSize = GTSL::Math::PowerOf2RoundUp(size, arenaAlignment);
+
+	uint64 allocatedSize{ 0 };
+	allocatorReference->Allocate(arenaSize, arenaAlignment, reinterpret_cast<void**>(&arena), &allocatedSize);
+}
+
+void MemoryBudget::Allocate(const uint64 size, const uint64 alignment, void** memory, uint64* allocatedSize, const char* name)
+{
+	if (framesStarted.load(std::memory_order_relaxed))
+	{
+		overflowCount.fetch_add(1, std::memory_order_relaxed); overflowBytes.fetch_add(size, std::memory_order_relaxed);
+	}
+
+	if (arena)
+	{
+		const uint64 arrayAlignment = alignment > ARRAY_ALIGNMENT ? alignment : ARRAY_ALIGNMENT;
+
+		uint64 offset = arenaOffset.load(std::memory_order_relaxed), start;
+
+		do
+		{
+			start = GTSL::Math::PowerOf2RoundUp(offset, arrayAlignment);
+			if (start + size > arenaSize) { break; }
+		} while (!arenaOffset.compare_exchange_weak(offset, start + size, std::memory_order_relaxed));
+
+		if (start + size <= arenaSize)
+		{
+			*memory = arena + start; *allocatedSize = size;
+			return;
+		}
+	}
+
+	fallbackAllocator->Allocate(size, alignment, memory, allocatedSize, name);
+}
+
+void MemoryBudget::Deallocate(const uint64 size, const uint64 alignment, void* memory, const char* name)
+{
+	//arena memory is only given back when the whole arena is
+	if (isInArena(memory)) { return; }
+
+	fallbackAllocator->Deallocate(size, alignment, memory, name);
+}
+
+void MemoryBudget::Free()
+{
+	if (arena) { allocatorReference->Deallocate(arenaSize, arenaAlignment, arena); }
+	arena = nullptr; arenaSize = 0; arenaOffset.store(0, std::memory_order_relaxed);
+}
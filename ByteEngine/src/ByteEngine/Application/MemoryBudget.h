@@ -0,0 +1,95 @@
+#pragma once
+
+#include "ByteEngine/Core.h"
+
+#include <atomic>
+
+#include <GTSL/Array.hpp>
+#include <GTSL/Id.h>
+
+#include "AllocatorReferences.h"
+
+class PoolAllocator;
+
+/**
+ * \brief Reserves the memory for every system's component arrays at startup, in one arena, so adding components doesn't reallocate during frames.
+ * Applications declare, before adding systems, how many components of each system they expect and how many bytes one takes across all of the system's arrays.
+ * Systems size their arrays from System::InitializeInfo::ScalingFactor, which is the declared count, and allocate them with System::GetComponentAllocator,
+ * which carves them from the arena. Arrays which outgrow the arena fall back to the persistent allocator.
+ * Component allocations made once frames have started are counted as overflows, they are growth reallocations, and are reported so budgets can be raised.
+ */
+class MemoryBudget
+{
+public:
+	/**
+	 * \brief Component count of systems which declared no budget.
+	 */
+	static constexpr uint32 DEFAULT_COMPONENT_COUNT = 16;
+
+	MemoryBudget() = default;
+	MemoryBudget(BE::SystemAllocatorReference* allocatorReference, PoolAllocator* fallbackAllocator);
+
+	/**
+	 * \brief Declares how many components systemName is expected to have and how many bytes one takes. Has to be called before the first system is added.
+	 */
+	void DeclareComponents(GTSL::Id64 systemName, uint32 count, uint32 bytesPerComponent);
+
+	[[nodiscard]] uint32 GetComponentCount(GTSL::Id64 systemName) const;
+
+	/**
+	 * \brief Allocates the arena, sized for every declaration. Called by GameInstance when the first system is added, later calls do nothing.
+	 */
+	void Reserve();
+
+	[[nodiscard]] bool IsReserved() const { return arena; }
+
+	/**
+	 * \brief Starts counting component allocations as overflows.
+	 */
+	void BeginFrames() { framesStarted.store(true, std::memory_order_relaxed); }
+
+	void Allocate(uint64 size, uint64 alignment, void** memory, uint64* allocatedSize, const char* name);
+	void Deallocate(uint64 size, uint64 alignment, void* memory, const char* name);
+
+	/**
+	 * \brief Number of component allocations, and their bytes, made since frames started.
+	 */
+	[[nodiscard]] uint64 GetOverflowCount() const { return overflowCount.load(std::memory_order_relaxed); }
+	[[nodiscard]] uint64 GetOverflowBytes() const { return overflowBytes.load(std::memory_order_relaxed); }
+
+	[[nodiscard]] uint64 GetArenaSize() const { return arenaSize; }
+	[[nodiscard]] uint64 GetArenaUsedBytes() const { return arenaOffset.load(std::memory_order_relaxed); }
+
+	void Free();
+
+private:
+	static constexpr uint32 MAX_DECLARATIONS = 64;
+	/**
+	 * \brief Arrays are placed on their own cache lines so systems' arrays don't share them.
+	 */
+	static constexpr uint64 ARRAY_ALIGNMENT = 64;
+	/**
+	 * \brief Slack added per declaration for the padding between a system's arrays.
+	 */
+	static constexpr uint64 ARRAYS_PER_SYSTEM = 8;
+
+	struct Declaration
+	{
+		GTSL::Id64 Name;
+		uint32 Count = 0;
+		uint32 BytesPerComponent = 0;
+	};
+	GTSL::Array<Declaration, MAX_DECLARATIONS> declarations;
+
+	BE::SystemAllocatorReference* allocatorReference{ nullptr };
+	PoolAllocator* fallbackAllocator{ nullptr };
+
+	byte* arena{ nullptr };
+	uint64 arenaSize{ 0 }, arenaAlignment{ 0 };
+	std::atomic<uint64> arenaOffset{ 0 };
+
+	std::atomic<bool> framesStarted{ false };
+	std::atomic<uint64> overflowCount{ 0 }, overflowBytes{ 0 };
+
+	[[nodiscard]] bool isInArena(const void* memory) const { return memory >= arena && memory < arena + arenaSize; }
+};
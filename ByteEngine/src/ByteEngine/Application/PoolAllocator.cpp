@@ -8,98 +8,354 @@
 
 #include "ByteEngine/Debug/Assert.h"
 
-PoolAllocator::PoolAllocator(BE::SystemAllocatorReference* allocatorReference) : POOL_COUNT(23), systemAllocatorReference(allocatorReference)
+#include "AllocationStatistics.h"
+
+//defined out of the class since ThreadCache's member initializers aren't usable until PoolAllocator is complete
+thread_local PoolAllocator::ThreadCache PoolAllocator::threadCache;
+
+PoolAllocator::PoolAllocator(BE::SystemAllocatorReference* allocatorReference, const bool hugePageSlabs) : systemAllocatorReference(allocatorReference)
 {
 	uint64 allocator_allocated_size{ 0 }; //debug
 	
-	allocatorReference->Allocate(sizeof(Pool) * POOL_COUNT, alignof(Pool), reinterpret_cast<void**>(&poolsData), &allocator_allocated_size);
+	allocatorReference->Allocate(sizeof(Pool) * PoolSizeClasses::COUNT, alignof(Pool), reinterpret_cast<void**>(&poolsData), &allocator_allocated_size);
+
+	//pools get their memory on first use
+	for (uint8 i = 0; i < PoolSizeClasses::COUNT; ++i) { ::new(poolsData + i) Pool(POOL_SIZE_CLASSES.GetSize(i), POOL_SIZE_CLASSES.GetAlignment(i), hugePageSlabs); }
+}
 
-	for (uint8 i = 0, j = POOL_COUNT; i < POOL_COUNT; ++i, --j)
-	{	
-		const auto slot_count = j * POOL_COUNT * 1.5; //pools with smaller slot sizes get more slots
-		const auto slot_size = 1 << i;
+PoolAllocator::Pool::Pool(const uint32 slotsSize, const uint32 slotsAlignment, const bool hugePages) : SLOTS_SIZE(slotsSize), SLOTS_ALIGNMENT(slotsAlignment), HUGE_PAGES(hugePages)
+{
+}
+
+template<typename T>
+static void resizeArray(T*& array, const uint32 count, uint32& capacity, const uint32 newCapacity, BE::SystemAllocatorReference* allocatorReference)
+{
+	T* newArray{ nullptr }; uint64 allocatedSize{ 0 };
+	allocatorReference->Allocate(sizeof(T) * newCapacity, alignof(T), reinterpret_cast<void**>(&newArray), &allocatedSize);
 
-		::new(poolsData + i) Pool(slot_count, slot_size, allocator_allocated_size, allocatorReference);
+	if (array)
+	{
+		GTSL::MemCopy(sizeof(T) * count, array, newArray);
+		allocatorReference->Deallocate(sizeof(T) * capacity, alignof(T), array);
 	}
+
+	array = newArray; capacity = newCapacity;
 }
 
-PoolAllocator::Pool::Pool(const uint16 slotsCount, const uint32 slotsSize, uint64& allocatedSize, BE::SystemAllocatorReference* allocatorReference) : SLOTS_SIZE(slotsSize), MAX_SLOTS_COUNT(slotsCount), slotsCount(MAX_SLOTS_COUNT)
+void PoolAllocator::Pool::addSlab(BE::SystemAllocatorReference* allocatorReference)
 {
-	uint64 pool_allocated_size{ 0 };
-	
-	allocatorReference->Allocate(slotsDataAllocationSize(), slotsDataAllocationAlignment(), reinterpret_cast<void**>(&slotsData), &pool_allocated_size);
-	allocatedSize += pool_allocated_size;
-	allocatorReference->Allocate(freeSlotsStackSize(), freeSlotsStackAlignment(), reinterpret_cast<void**>(&freeSlotsStack), &pool_allocated_size);
-	allocatedSize += pool_allocated_size;
+	if (slabCount == slabCapacity) { resizeArray(slabs, slabCount, slabCapacity, slabCapacity ? slabCapacity * 2 : 8, allocatorReference); }
 
-	BE_DEBUG_ONLY(GTSL::SetMemory(slotsDataAllocationSize(), slotsData));
-	
-	for(uint32 i = 0; i < MAX_SLOTS_COUNT; ++i)
+	const uint32 slots = slotsPerSlab();
+
+	//free stack can hold every slot of every slab, so deallocating never has to grow it
+	if (freeSlotsCapacity < (slabCount + 1) * slots) { resizeArray(freeSlotsStack, freeSlotsCount, freeSlotsCapacity, (slabCount + 1) * slots, allocatorReference); }
+
+	Slab slab; uint64 allocated_size{ 0 };
+	allocatorReference->Allocate(slabDataSize(), slabAlignment(), reinterpret_cast<void**>(&slab.Data), &allocated_size);
+
+	BE_DEBUG_ONLY(GTSL::SetMemory(slabDataSize(), slab.Data));
+
+	uint32 index = slabCount++;
+	for (; index > 0 && slabs[index - 1].Data > slab.Data; --index) { slabs[index] = slabs[index - 1]; }
+	slabs[index] = slab;
+
+	//pushed in reverse so slots are handed out in address order
+	for (uint32 i = slots; i > 0; --i) { freeSlotsStack[freeSlotsCount++] = slab.Data + static_cast<uint64>(i - 1) * SLOTS_SIZE; }
+}
+
+uint32 PoolAllocator::Pool::findSlab(const byte* pointer) const
+{
+	uint32 low = 0, high = slabCount;
+
+	while (low < high)
 	{
-		freeSlotsStack[i] = i;
+		const uint32 middle = (low + high) / 2;
+		if (pointer < slabs[middle].Data) { high = middle; }
+		else if (pointer >= slabs[middle].Data + slabDataSize()) { low = middle + 1; }
+		else { return middle; }
 	}
+
+	return slabCount;
+}
+
+uint8 PoolAllocator::sizeClass(const uint64 size, const uint64 alignment)
+{
+	BE_ASSERT((alignment & (alignment - 1)) == 0, "Alignment is not power of two!");
+	//allocation and deallocation must land on the same class, so both take alignment into account
+	uint8 size_class = POOL_SIZE_CLASSES.GetSizeClass(GTSL::Math::PowerOf2RoundUp(size, alignment));
+	while (size_class < PoolSizeClasses::COUNT && POOL_SIZE_CLASSES.GetAlignment(size_class) < alignment) { ++size_class; }
+	BE_ASSERT(size_class < PoolSizeClasses::COUNT, "No pool big enough!");
+	return size_class;
+}
+
+PoolAllocator::ThreadCache* PoolAllocator::getThreadCache() const
+{
+	if (threadCache.Owner == this) { return &threadCache; }
+	if (threadCache.Owner) { return nullptr; }
+
+	GTSL::Lock lock(threadCachesLock);
+	if (threadCacheCount == MAX_THREAD_CACHES) { return nullptr; }
+
+	threadCaches[threadCacheCount++] = &threadCache;
+	threadCache.Owner = this;
+	return &threadCache;
+}
+
+void PoolAllocator::retireThreadCache(ThreadCache* cache) const
+{
+	FlushThreadCache();
+
+	GTSL::Lock lock(threadCachesLock);
+
+	for (uint8 i = 0; i < PoolSizeClasses::COUNT; ++i)
+	{
+		auto& counters = cache->Counters[i];
+		sharedCounters[i].Allocations.fetch_add(counters.Allocations.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		sharedCounters[i].RequestedBytes.fetch_add(counters.RequestedBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		sharedCounters[i].LiveAllocations.fetch_add(counters.LiveAllocations.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		sharedCounters[i].LiveRequestedBytes.fetch_add(counters.LiveRequestedBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+
+	for (uint32 i = 0; i < threadCacheCount; ++i)
+	{
+		if (threadCaches[i] == cache) { threadCaches[i] = threadCaches[--threadCacheCount]; break; }
+	}
+
+	cache->Owner = nullptr;
+}
+
+template<typename T>
+static void add(std::atomic<T>& counter, const T value, const bool shared)
+{
+	//thread cache counters only have one writer, avoid the locked instruction
+	if (shared) { counter.fetch_add(value, std::memory_order_relaxed); }
+	else { counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed); }
+}
+
+void PoolAllocator::recordAllocation(SizeClassCounters& counters, const uint64 size, const bool shared)
+{
+	add<uint64>(counters.Allocations, 1, shared); add<uint64>(counters.RequestedBytes, size, shared);
+	add<int64>(counters.LiveAllocations, 1, shared); add<int64>(counters.LiveRequestedBytes, static_cast<int64>(size), shared);
+}
+
+void PoolAllocator::recordDeallocation(SizeClassCounters& counters, const uint64 size, const bool shared)
+{
+	add<int64>(counters.LiveAllocations, -1, shared); add<int64>(counters.LiveRequestedBytes, -static_cast<int64>(size), shared);
+}
+
+PoolAllocator::SizeClassStatistics PoolAllocator::GetSizeClassStatistics(const uint8 sizeClass) const
+{
+	SizeClassStatistics statistics;
+	statistics.SlotSize = POOL_SIZE_CLASSES.GetSize(sizeClass);
+	statistics.ReservedBytes = poolsData[sizeClass].GetReservedBytes();
+
+	auto accumulate = [&](const SizeClassCounters& counters)
+	{
+		statistics.Allocations += counters.Allocations.load(std::memory_order_relaxed);
+		statistics.RequestedBytes += counters.RequestedBytes.load(std::memory_order_relaxed);
+		statistics.LiveAllocations += counters.LiveAllocations.load(std::memory_order_relaxed);
+		statistics.LiveRequestedBytes += counters.LiveRequestedBytes.load(std::memory_order_relaxed);
+	};
+
+	GTSL::Lock lock(threadCachesLock);
+
+	accumulate(sharedCounters[sizeClass]);
+	for (uint32 i = 0; i < threadCacheCount; ++i) { accumulate(threadCaches[i]->Counters[sizeClass]); }
+
+	return statistics;
 }
 
 // ALLOCATE //
 
 void PoolAllocator::Allocate(const uint64 size, const uint64 alignment, void** memory, uint64* allocatedSize, const char* name) const
 {
-	GTSL::Lock lock(globalLock);
-	BE_ASSERT((alignment & (alignment - 1)) == 0, "Alignment is not power of two!");
-	uint64 allocation_min_size{ 0 }; GTSL::NextPowerOfTwo(GTSL::Math::PowerOf2RoundUp(size, alignment), allocation_min_size);
+	BE_STATISTICS_ONLY(AllocationStatistics::RecordAllocation(AllocationStatistics::AllocatorType::PERSISTENT, name, size))
+
+	const uint8 size_class = sizeClass(size, alignment);
 
-	uint8 set_bit { 0 }; GTSL::FindFirstSetBit(allocation_min_size, set_bit);
-	BE_ASSERT(POOL_COUNT > set_bit, "No pool big enough!");	
+	auto& pool = poolsData[size_class];
+	byte* slot{ nullptr };
 
-	poolsData[set_bit].Allocate(size, alignment, memory, allocatedSize);
+	auto* cache = getThreadCache();
+
+	if (cache) { recordAllocation(cache->Counters[size_class], size, false); }
+	else { recordAllocation(sharedCounters[size_class], size, true); }
+
+	if (cache && size_class <= MAX_CACHED_SIZE_CLASS)
+	{
+		auto* magazine = &cache->Magazines[size_class];
+		if (!magazine->Count) { magazine->Count = pool.AllocateSlots(MAGAZINE_SIZE / 2, magazine->Slots, systemAllocatorReference); }
+		slot = magazine->Slots[--magazine->Count];
+	}
+	else
+	{
+		pool.AllocateSlots(1, &slot, systemAllocatorReference);
+	}
+
+	//slots are aligned to the requested alignment, so allocations always start at the beginning of their slot and deallocation doesn't need to find it
+	*memory = slot;
+	*allocatedSize = pool.GetSlotsSize();
 }
 
-void PoolAllocator::Pool::Allocate(const uint64 size, const uint64 alignment, void** data, uint64* allocatedSize)
+uint32 PoolAllocator::Pool::AllocateSlots(const uint32 count, byte** slots, BE::SystemAllocatorReference* allocatorReference)
 {
-	BE_ASSERT(slotsCount != 0, "No more free slots remaining!")
-	const uint32 slot = freeSlotsStack[--slotsCount];
-	byte* const slot_address = getSlotAddress(slot);
-	*data = GTSL::AlignPointer(alignment, slot_address);
-	*allocatedSize = (slot_address + SLOTS_SIZE) - static_cast<byte*>(*data);
+	GTSL::Lock poolLock(lock);
+
+	if (!freeSlotsCount) { addSlab(allocatorReference); }
+	const uint32 popped = count < freeSlotsCount ? count : freeSlotsCount;
 
-	BE_ASSERT(*data >= slotsData && *data <= slotsData + slotsDataAllocationSize(), "Allocation does not belong to pool!")
+	for (uint32 i = 0; i < popped; ++i) { slots[i] = freeSlotsStack[--freeSlotsCount]; }
+
+	return popped;
 }
 
 // DEALLOCATE //
 
 void PoolAllocator::Deallocate(const uint64 size, const uint64 alignment, void* memory, const char* name) const
 {
-	GTSL::Lock lock(globalLock);
-	BE_ASSERT((alignment & (alignment - 1)) == 0, "Alignment is not power of two!");
-	uint64 allocation_min_size { 0 }; GTSL::NextPowerOfTwo(size, allocation_min_size);
-	uint8 set_bit{ 0 }; GTSL::FindFirstSetBit(allocation_min_size, set_bit);
-	poolsData[set_bit].Deallocate(size, alignment, memory, systemAllocatorReference);
+	BE_STATISTICS_ONLY(AllocationStatistics::RecordDeallocation(AllocationStatistics::AllocatorType::PERSISTENT, name, size))
+
+	const uint8 size_class = sizeClass(size, alignment);
+
+	auto& pool = poolsData[size_class];
+	byte* const slot = static_cast<byte*>(memory);
+
+	auto* cache = getThreadCache();
+
+	if (cache) { recordDeallocation(cache->Counters[size_class], size, false); }
+	else { recordDeallocation(sharedCounters[size_class], size, true); }
+
+	if (cache && size_class <= MAX_CACHED_SIZE_CLASS)
+	{
+		auto* magazine = &cache->Magazines[size_class];
+		if (magazine->Count == MAGAZINE_SIZE)
+		{
+			pool.DeallocateSlots(MAGAZINE_SIZE / 2, magazine->Slots + MAGAZINE_SIZE / 2);
+			magazine->Count = MAGAZINE_SIZE / 2;
+		}
+
+		magazine->Slots[magazine->Count++] = slot;
+	}
+	else
+	{
+		pool.DeallocateSlots(1, &slot);
+	}
 }
 
-void PoolAllocator::Pool::Deallocate(uint64 size, const uint64 alignment, void* memory, BE::SystemAllocatorReference* allocatorReference)
+void PoolAllocator::Pool::DeallocateSlots(const uint32 count, byte* const* slots)
 {
-	BE_ASSERT(memory >= slotsData && memory <= slotsData + slotsDataAllocationSize(), "Allocation does not belong to pool!")
+	GTSL::Lock poolLock(lock);
 
-	const auto index = getSlotIndexFromPointer(memory);
-	freeSlotsStack[slotsCount++] = index;
+	BE_ASSERT(freeSlotsCount + count <= freeSlotsCapacity, "More allocations have been freed than there are slots!")
 
-	BE_ASSERT(slotsCount <= MAX_SLOTS_COUNT, "More allocations have been freed than there are slots!")
+	for (uint32 i = 0; i < count; ++i)
+	{
+		BE_ASSERT(findSlab(slots[i]) != slabCount, "Allocation does not belong to pool!")
+		freeSlotsStack[freeSlotsCount++] = slots[i];
+	}
+}
+
+void PoolAllocator::FlushThreadCache() const
+{
+	if (threadCache.Owner != this) { return; }
+
+	for (uint8 i = 0; i <= MAX_CACHED_SIZE_CLASS; ++i)
+	{
+		auto& magazine = threadCache.Magazines[i];
+		if (magazine.Count) { poolsData[i].DeallocateSlots(magazine.Count, magazine.Slots); magazine.Count = 0; }
+	}
+}
+
+// TRIM //
+
+uint64 PoolAllocator::Trim() const
+{
+	FlushThreadCache();
+
+	uint64 released_bytes{ 0 };
+
+	for (auto& pool : pools()) { released_bytes += pool.Trim(systemAllocatorReference); }
+
+	return released_bytes;
+}
+
+uint64 PoolAllocator::Pool::Trim(BE::SystemAllocatorReference* allocatorReference)
+{
+	GTSL::Lock poolLock(lock);
+
+	if (!slabCount) { return 0; }
+
+	//count free slots per slab, slabs whose slots are all free are unused
+	uint32* freeCounts{ nullptr }; uint64 allocatedSize{ 0 };
+	allocatorReference->Allocate(sizeof(uint32) * slabCount, alignof(uint32), reinterpret_cast<void**>(&freeCounts), &allocatedSize);
+	for (uint32 i = 0; i < slabCount; ++i) { freeCounts[i] = 0; }
+
+	for (uint32 i = 0; i < freeSlotsCount; ++i) { ++freeCounts[findSlab(freeSlotsStack[i])]; }
+
+	const uint32 slots = slotsPerSlab();
+
+	uint32 keptSlots = 0;
+	for (uint32 i = 0; i < freeSlotsCount; ++i)
+	{
+		if (freeCounts[findSlab(freeSlotsStack[i])] != slots) { freeSlotsStack[keptSlots++] = freeSlotsStack[i]; }
+	}
+	freeSlotsCount = keptSlots;
+
+	uint64 released_bytes{ 0 };
+	uint32 keptSlabs = 0;
+
+	for (uint32 i = 0; i < slabCount; ++i)
+	{
+		if (freeCounts[i] == slots)
+		{
+			allocatorReference->Deallocate(slabDataSize(), slabAlignment(), slabs[i].Data);
+			released_bytes += slabDataSize();
+		}
+		else
+		{
+			slabs[keptSlabs++] = slabs[i];
+		}
+	}
+
+	allocatorReference->Deallocate(sizeof(uint32) * slabCount, alignof(uint32), freeCounts);
+	slabCount = keptSlabs;
+
+	return released_bytes;
+}
+
+uint64 PoolAllocator::Pool::GetReservedBytes()
+{
+	GTSL::Lock poolLock(lock);
+	return slabCount * slabDataSize();
 }
 
 // FREE //
 
 void PoolAllocator::Free() const
 {
+	if (threadCache.Owner == this) { retireThreadCache(&threadCache); }
+
 	uint64 freed_bytes{ 0 };
 
 	for (auto& pool : pools()) { pool.Free(freed_bytes, systemAllocatorReference); }
+
+	systemAllocatorReference->Deallocate(sizeof(Pool) * PoolSizeClasses::COUNT, alignof(Pool), poolsData);
 }
 
-void PoolAllocator::Pool::Free(uint64& freedBytes, BE::SystemAllocatorReference* allocatorReference) const
+void PoolAllocator::Pool::Free(uint64& freedBytes, BE::SystemAllocatorReference* allocatorReference)
 {
-	allocatorReference->Deallocate(slotsDataAllocationSize(), slotsDataAllocationAlignment(), slotsData);
-	allocatorReference->Deallocate(freeSlotsStackSize(), freeSlotsStackAlignment(), freeSlotsStack);
+	for (uint32 i = 0; i < slabCount; ++i)
+	{
+		allocatorReference->Deallocate(slabDataSize(), slabAlignment(), slabs[i].Data);
+		freedBytes += slabDataSize();
+	}
 
-	freedBytes += slotsDataAllocationSize();
-	freedBytes += freeSlotsStackSize();
-}
\ No newline at end of file
+	if (slabs) { allocatorReference->Deallocate(sizeof(Slab) * slabCapacity, alignof(Slab), slabs); }
+	if (freeSlotsStack) { allocatorReference->Deallocate(sizeof(byte*) * freeSlotsCapacity, alignof(byte*), freeSlotsStack); }
+
+	freedBytes += sizeof(Slab) * slabCapacity + sizeof(byte*) * freeSlotsCapacity;
+
+	slabs = nullptr; freeSlotsStack = nullptr;
+	slabCount = slabCapacity = freeSlotsCount = freeSlotsCapacity = 0;
+}
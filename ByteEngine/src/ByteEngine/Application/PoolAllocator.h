@@ -2,18 +2,29 @@
 
 #include "ByteEngine/Core.h"
 
+#include <atomic>
+
 #include <GTSL/Allocator.h>
-#include <GTSL/Atomic.hpp>
 #include <GTSL/Mutex.h>
 #include <GTSL/Ranger.h>
 
 #include "ByteEngine/Game/System.h"
 
+#include "PoolSizeClasses.h"
+#include "SystemAllocator.h"
+
+/**
+ * \brief Allocator made of pools of fixed size slots, one per size class in PoolSizeClasses.
+ * Pools start empty and grow by slabs allocated from the system allocator when they run out of slots, Trim returns slabs which have no used slots.
+ * Slabs can be made of huge pages, which cuts TLB misses when walking lots of objects at the cost of reserving 2MB per used size class.
+ * Every thread keeps a magazine of free slots per small size class, so most allocations and deallocations touch no lock. Magazines are refilled from and flushed
+ * to the shared pools in batches of half a magazine, which are the only operations that take a pool's lock.
+ */
 class PoolAllocator
 {
 public:
 	PoolAllocator() = default;
-	PoolAllocator(BE::SystemAllocatorReference* allocatorReference);
+	PoolAllocator(BE::SystemAllocatorReference* allocatorReference, bool hugePageSlabs = false);
 
 	~PoolAllocator() = default;
 
@@ -21,6 +32,54 @@ public:
 
 	void Deallocate(uint64 size, uint64 alignment, void* memory, const char* name) const;
 
+	/**
+	 * \brief Returns the slots cached by the calling thread to the shared pools. Threads flush their cache automatically when they exit.
+	 */
+	void FlushThreadCache() const;
+
+	/**
+	 * \brief Returns every slab with no used slots to the system allocator. Slots cached by threads other than the calling one count as used.
+	 * \return Number of bytes released.
+	 */
+	uint64 Trim() const;
+
+	struct SizeClassStatistics
+	{
+		uint32 SlotSize = 0;
+		/**
+		 * \brief Allocations ever made from this class and the bytes they asked for.
+		 */
+		uint64 Allocations = 0, RequestedBytes = 0;
+		/**
+		 * \brief Allocations currently alive and the bytes they asked for.
+		 */
+		int64 LiveAllocations = 0, LiveRequestedBytes = 0;
+		/**
+		 * \brief Bytes of slabs the class' pool holds.
+		 */
+		uint64 ReservedBytes = 0;
+
+		/**
+		 * \brief Bytes of the slots of live allocations not asked for, internal fragmentation.
+		 */
+		[[nodiscard]] int64 GetWastedBytes() const { return LiveAllocations * SlotSize - LiveRequestedBytes; }
+
+		/**
+		 * \brief Bytes not asked for over all allocations ever made from this class.
+		 */
+		[[nodiscard]] uint64 GetTotalWastedBytes() const { return Allocations * SlotSize - RequestedBytes; }
+	};
+
+	/**
+	 * \brief Sums the statistics every thread has recorded for a size class. Counters are updated without synchronization, so the result is approximate while other threads allocate.
+	 */
+	[[nodiscard]] SizeClassStatistics GetSizeClassStatistics(uint8 sizeClass) const;
+
+	static constexpr uint8 GetSizeClassCount() { return PoolSizeClasses::COUNT; }
+
+	/**
+	 * \brief Frees all pools. Every thread other than the calling one which allocated from this allocator must have exited before.
+	 */
 	void Free() const;
 
 	class Pool
@@ -28,40 +87,136 @@ public:
 	public:
 		Pool() = default;
 		
-		Pool(uint16 slotsCount, uint32 slotsSize, uint64& allocatedSize, BE::SystemAllocatorReference* allocatorReference);
+		Pool(uint32 slotsSize, uint32 slotsAlignment, bool hugePages);
 
-		void Allocate(uint64 size, uint64 alignment, void** data, uint64* allocatedSize);
+		/**
+		 * \brief Pops up to count free slots into slots, growing the pool if it has none left, returns how many were popped.
+		 */
+		uint32 AllocateSlots(uint32 count, byte** slots, BE::SystemAllocatorReference* allocatorReference);
 
-		void Deallocate(uint64 size, uint64 alignment, void* memory, BE::SystemAllocatorReference* allocatorReference);
+		void DeallocateSlots(uint32 count, byte* const* slots);
 
-		void Free(uint64& freedBytes, BE::SystemAllocatorReference* allocatorReference) const;
+		[[nodiscard]] uint32 GetSlotsSize() const { return SLOTS_SIZE; }
 
-	private:
-		using free_slots_type = uint32;
-		
-		free_slots_type* freeSlotsStack{ nullptr };
-		byte* slotsData{ nullptr };
-		
-		const uint32 SLOTS_SIZE{ 0 };
-		const uint32 MAX_SLOTS_COUNT{ 0 };
-		GTSL::Atomic<free_slots_type> slotsCount{ 0 };
+		/**
+		 * \brief Slots are aligned to this, allocations with up to this alignment start at the beginning of their slot.
+		 */
+		[[nodiscard]] uint32 GetSlotsAlignment() const { return SLOTS_ALIGNMENT; }
 
-		[[nodiscard]] byte* getSlotAddress(const uint32 slotIndex) const { return &slotsData[slotIndex * SLOTS_SIZE]; }
-		uint64 getSlotIndexFromPointer(void* pointer) const { return (static_cast<byte*>(pointer) - slotsData) / SLOTS_SIZE; }
+		uint64 Trim(BE::SystemAllocatorReference* allocatorReference);
 
-		[[nodiscard]] uint64 slotsDataAllocationSize() const { return static_cast<uint64>(MAX_SLOTS_COUNT) * SLOTS_SIZE; }
-		static uint64 slotsDataAllocationAlignment() { return alignof(uint64); }
+		[[nodiscard]] uint64 GetReservedBytes();
+		
+		void Free(uint64& freedBytes, BE::SystemAllocatorReference* allocatorReference);
 
-		[[nodiscard]] uint64 freeSlotsStackSize() const { return MAX_SLOTS_COUNT * sizeof(free_slots_type); }
-		static uint64 freeSlotsStackAlignment() { return alignof(free_slots_type); }
+	private:
+		static constexpr uint32 SLAB_SIZE = 65536;
+		static constexpr uint32 MAX_SLOTS_PER_SLAB = 1024;
+
+		struct Slab
+		{
+			byte* Data{ nullptr };
+		};
+
+		/**
+		 * \brief Slabs sorted by address so the one a slot belongs to can be found with a binary search.
+		 */
+		Slab* slabs{ nullptr };
+		uint32 slabCount{ 0 }, slabCapacity{ 0 };
+
+		byte** freeSlotsStack{ nullptr };
+		uint32 freeSlotsCount{ 0 }, freeSlotsCapacity{ 0 };
+		
+		const uint32 SLOTS_SIZE{ 0 };
+		const uint32 SLOTS_ALIGNMENT{ 0 };
+		/**
+		 * \brief Whether slabs are HUGE_PAGE_SIZE aligned so the system allocator backs them with huge pages.
+		 */
+		const bool HUGE_PAGES{ false };
+
+		GTSL::Mutex lock;
+
+		[[nodiscard]] uint32 slotsPerSlab() const
+		{
+			if (HUGE_PAGES) { const auto slots = static_cast<uint32>(SystemAllocator::HUGE_PAGE_SIZE / SLOTS_SIZE); return slots == 0 ? 1 : slots; }
+			const uint32 slots = SLAB_SIZE / SLOTS_SIZE;
+			return slots == 0 ? 1 : slots > MAX_SLOTS_PER_SLAB ? MAX_SLOTS_PER_SLAB : slots;
+		}
+
+		[[nodiscard]] uint64 slabDataSize() const { return static_cast<uint64>(slotsPerSlab()) * SLOTS_SIZE; }
+		[[nodiscard]] uint64 slabAlignment() const { return HUGE_PAGES ? SystemAllocator::HUGE_PAGE_SIZE : SLOTS_ALIGNMENT; }
+
+		/**
+		 * \brief Returns the index of the slab which holds pointer, or slabCount if no slab does.
+		 */
+		[[nodiscard]] uint32 findSlab(const byte* pointer) const;
+
+		void addSlab(BE::SystemAllocatorReference* allocatorReference);
 	};
 
 private:
 	Pool* poolsData{ nullptr };
-	const uint32 POOL_COUNT{ 0 };
 	BE::SystemAllocatorReference* systemAllocatorReference{ nullptr };
 
-	mutable GTSL::Mutex globalLock;
+	[[nodiscard]] GTSL::Ranger<Pool> pools() const { return GTSL::Ranger<Pool>(PoolSizeClasses::COUNT, poolsData); }
+
+	static constexpr uint32 MAGAZINE_SIZE = 16;
+	/**
+	 * \brief Biggest size class which is cached per thread, caching bigger slots would pin too much memory on every thread.
+	 */
+	static constexpr uint8 MAX_CACHED_SIZE_CLASS = POOL_SIZE_CLASSES.GetSizeClass(2048);
+	static constexpr uint32 MAX_THREAD_CACHES = 256;
+
+	struct Magazine
+	{
+		uint32 Count = 0;
+		byte* Slots[MAGAZINE_SIZE];
+	};
+
+	struct SizeClassCounters
+	{
+		std::atomic<uint64> Allocations{ 0 }, RequestedBytes{ 0 };
+		std::atomic<int64> LiveAllocations{ 0 }, LiveRequestedBytes{ 0 };
+	};
+
+	struct ThreadCache
+	{
+		/**
+		 * \brief Allocator the cached slots belong to, threads only cache slots for the first allocator they use.
+		 */
+		const PoolAllocator* Owner = nullptr;
+		Magazine Magazines[MAX_CACHED_SIZE_CLASS + 1];
+		/**
+		 * \brief Only written by the owning thread, so updates are plain loads and stores, other threads read them to build statistics.
+		 */
+		SizeClassCounters Counters[PoolSizeClasses::COUNT];
+
+		~ThreadCache() { if (Owner) { Owner->retireThreadCache(this); } }
+	};
+
+	static thread_local ThreadCache threadCache;
+
+	/**
+	 * \brief Counters of allocations which didn't go through a thread cache and of threads which have exited.
+	 */
+	mutable SizeClassCounters sharedCounters[PoolSizeClasses::COUNT];
+
+	mutable GTSL::Mutex threadCachesLock;
+	mutable ThreadCache* threadCaches[MAX_THREAD_CACHES]{};
+	mutable uint32 threadCacheCount{ 0 };
+
+	/**
+	 * \brief Returns the calling thread's cache if it caches slots for this allocator, registering it on first use, else nullptr.
+	 */
+	ThreadCache* getThreadCache() const;
+
+	/**
+	 * \brief Flushes a thread's cache, moves it's counters to the shared ones and unregisters it.
+	 */
+	void retireThreadCache(ThreadCache* cache) const;
+
+	static void recordAllocation(SizeClassCounters& counters, uint64 size, bool shared);
+	static void recordDeallocation(SizeClassCounters& counters, uint64 size, bool shared);
 
-	[[nodiscard]] GTSL::Ranger<Pool> pools() const { return GTSL::Ranger<Pool>(POOL_COUNT, poolsData); }
+	static uint8 sizeClass(uint64 size, uint64 alignment);
 };
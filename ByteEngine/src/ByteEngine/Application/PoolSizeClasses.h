@@ -0,0 +1,76 @@
+#pragma once
+
+#include "ByteEngine/Core.h"
+
+/**
+ * \brief Slot sizes of the PoolAllocator's pools, four per doubling past 128 bytes(jemalloc style) so no allocation wastes more than 20% of it's slot.
+ * 8, 16 to 128 in steps of 16, then 160, 192, 224, 256, 320... up to 4MB. Built at compile time along with a table which maps small sizes to their class.
+ */
+struct PoolSizeClasses
+{
+	static constexpr uint8 COUNT = 69;
+	static constexpr uint32 MAX_SIZE = 1 << 22;
+
+	/**
+	 * \brief Sizes up to this are mapped to their class with a table lookup, bigger ones with a binary search.
+	 */
+	static constexpr uint32 MAX_LOOKUP_SIZE = 4096;
+	static constexpr uint32 LOOKUP_GRANULARITY = 8;
+
+	uint32 Sizes[COUNT]{};
+	uint8 Lookup[MAX_LOOKUP_SIZE / LOOKUP_GRANULARITY + 1]{};
+
+	constexpr PoolSizeClasses()
+	{
+		uint8 count = 0;
+
+		Sizes[count++] = 8;
+		for (uint32 size = 16; size <= 128; size += 16) { Sizes[count++] = size; }
+
+		for (uint32 base = 128; base < MAX_SIZE; base *= 2)
+		{
+			for (uint32 step = 1; step <= 4; ++step) { Sizes[count++] = base + base / 4 * step; }
+		}
+
+		uint8 sizeClass = 0;
+		for (uint32 i = 0; i < MAX_LOOKUP_SIZE / LOOKUP_GRANULARITY + 1; ++i)
+		{
+			while (Sizes[sizeClass] < i * LOOKUP_GRANULARITY) { ++sizeClass; }
+			Lookup[i] = sizeClass;
+		}
+	}
+
+	/**
+	 * \brief Returns the smallest class whose slots can hold size bytes.
+	 */
+	[[nodiscard]] constexpr uint8 GetSizeClass(const uint64 size) const
+	{
+		if (size <= MAX_LOOKUP_SIZE) { return Lookup[(size + LOOKUP_GRANULARITY - 1) / LOOKUP_GRANULARITY]; }
+
+		uint8 low = Lookup[MAX_LOOKUP_SIZE / LOOKUP_GRANULARITY], high = COUNT;
+
+		while (low < high)
+		{
+			const uint8 middle = (low + high) / 2;
+			if (Sizes[middle] < size) { low = middle + 1; } else { high = middle; }
+		}
+
+		return low;
+	}
+
+	[[nodiscard]] constexpr uint32 GetSize(const uint8 sizeClass) const { return Sizes[sizeClass]; }
+
+	/**
+	 * \brief Alignment of every slot of a class when slabs are aligned to it, the biggest power of two the size is a multiple of, up to a page.
+	 */
+	[[nodiscard]] constexpr uint32 GetAlignment(const uint8 sizeClass) const
+	{
+		const uint32 alignment = Sizes[sizeClass] & (~Sizes[sizeClass] + 1);
+		return alignment < 4096 ? alignment : 4096;
+	}
+};
+
+inline constexpr PoolSizeClasses POOL_SIZE_CLASSES;
+
+static_assert(POOL_SIZE_CLASSES.Sizes[PoolSizeClasses::COUNT - 1] == PoolSizeClasses::MAX_SIZE, "Size class table doesn't end at MAX_SIZE!");
+static_assert(POOL_SIZE_CLASSES.GetSize(POOL_SIZE_CLASSES.GetSizeClass(33)) == 48 && POOL_SIZE_CLASSES.GetSize(POOL_SIZE_CLASSES.GetSizeClass(1025)) == 1280, "Size class lookup is wrong!");
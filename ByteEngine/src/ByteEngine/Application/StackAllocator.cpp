@@ -1,13 +1,17 @@
 #include "StackAllocator.h"
 
+#include <new>
 #include <GTSL/Math/Math.hpp>
 #include "ByteEngine/Debug/Assert.h"
 
-void StackAllocator::Block::AllocateBlock(const uint64 minimumSize, BE::SystemAllocatorReference* allocatorReference, uint64& allocatedSize)
+#include "AllocationStatistics.h"
+
+void StackAllocator::Block::AllocateBlock(const uint64 minimumSize, const uint64 blockAlignment, BE::SystemAllocatorReference* allocatorReference, uint64& allocatedSize)
 {
 	uint64 allocated_size{ 0 };
 
-	allocatorReference->Allocate(minimumSize, alignof(byte), reinterpret_cast<void**>(&start), &allocated_size);
+	alignment = blockAlignment;
+	allocatorReference->Allocate(minimumSize, alignment, reinterpret_cast<void**>(&start), &allocated_size);
 
 	allocatedSize = allocated_size;
 
@@ -17,7 +21,7 @@ void StackAllocator::Block::AllocateBlock(const uint64 minimumSize, BE::SystemAl
 
 void StackAllocator::Block::DeallocateBlock(BE::SystemAllocatorReference* allocatorReference, uint64& deallocatedBytes) const
 {
-	allocatorReference->Deallocate(end - start, alignof(byte), start);
+	allocatorReference->Deallocate(end - start, alignment, start);
 	deallocatedBytes += end - start;
 }
 
@@ -30,10 +34,11 @@ void StackAllocator::Block::AllocateInBlock(const uint64 size, const uint64 alig
 bool StackAllocator::Block::TryAllocateInBlock(const uint64 size, const uint64 alignment, void** data, uint64& allocatedSize)
 {
 	allocatedSize = GTSL::Math::PowerOf2RoundUp(size, alignment);
-	if (at + allocatedSize < end)
+	byte* const aligned = GTSL::AlignPointer(alignment, at);
+	if (aligned + allocatedSize <= end)
 	{
-		*data = GTSL::AlignPointer(alignment, at);
-		at += allocatedSize;
+		*data = aligned;
+		at = aligned + allocatedSize;
 		return true;
 	}
 	return false;
@@ -41,228 +46,151 @@ bool StackAllocator::Block::TryAllocateInBlock(const uint64 size, const uint64 a
 
 void StackAllocator::Block::Clear() { at = start; }
 
-StackAllocator::StackAllocator(BE::SystemAllocatorReference* allocatorReference, const uint8 stackCount, const uint8 defaultBlocksPerStackCount, const uint64 blockSizes) :
-	blockSize(blockSizes), stacks(stackCount, *allocatorReference), stacksMutexes(stackCount, *allocatorReference), allocatorReference(allocatorReference), MAX_STACKS(stackCount)
+StackAllocator::StackAllocator(BE::SystemAllocatorReference* allocatorReference, const uint64 blockSize, const bool hugePages) :
+	blockSize(hugePages ? GTSL::Math::PowerOf2RoundUp(blockSize, SystemAllocator::HUGE_PAGE_SIZE) : blockSize), blockAlignment(hugePages ? SystemAllocator::HUGE_PAGE_SIZE : alignof(uint64)),
+	allocatorReference(allocatorReference)
 {
-	uint64 allocated_size = 0;
-
-	for (uint8 stack = 0; stack < stackCount; ++stack)
-	{
-		stacks.EmplaceBack(defaultBlocksPerStackCount, *allocatorReference);
-
-		for (uint32 block = 0; block < defaultBlocksPerStackCount; ++block)
-		{
-			stacks[stack].EmplaceBack(); //construct a default block
-
-			stacks[stack][block].AllocateBlock(blockSizes, allocatorReference, allocated_size);
-
-			if constexpr (BE_DEBUG)
-			{
-				GTSL::Lock<GTSL::Mutex> lock(debugDataMutex);
-				++allocatorAllocationsCount;
-				++totalAllocatorAllocationsCount;
-				allocatorAllocatedBytes += allocated_size;
-				totalAllocatorAllocatedBytes += allocated_size;
-			}
-		}
-
-		stacksMutexes.EmplaceBack();
-	}
 }
 
 StackAllocator::~StackAllocator()
 {
 }
 
-#if BE_DEBUG
-void StackAllocator::GetDebugData(DebugData& debugData)
+uint32 StackAllocator::getThreadIndex()
 {
-	GTSL::Lock<GTSL::Mutex> lock(debugDataMutex);
-
-	debugData.BlockMisses = blockMisses;
-
-	debugData.PerNameAllocationsData = perNameData;
-
-	debugData.AllocationsCount = allocationsCount;
-	debugData.TotalAllocationsCount = totalAllocationsCount;
-
-	debugData.DeallocationsCount = deallocationsCount;
-	debugData.TotalDeallocationsCount = totalDeallocationsCount;
-
-	debugData.BytesAllocated = bytesAllocated;
-	debugData.TotalBytesAllocated = totalBytesAllocated;
-
-	debugData.BytesDeallocated = bytesDeallocated;
-	debugData.TotalBytesDeallocated = totalBytesDeallocated;
-
-	debugData.AllocatorAllocationsCount = allocatorAllocationsCount;
-	debugData.TotalAllocatorAllocationsCount = totalAllocatorAllocationsCount;
-
-	debugData.AllocatorDeallocationsCount = allocatorDeallocationsCount;
-	debugData.TotalAllocatorDeallocationsCount = totalAllocatorDeallocationsCount;
-
-	debugData.AllocatorAllocatedBytes = allocatorAllocatedBytes;
-	debugData.TotalAllocatorAllocatedBytes = totalAllocatorAllocatedBytes;
-
-	debugData.AllocatorDeallocatedBytes = allocatorDeallocatedBytes;
-	debugData.TotalAllocatorDeallocatedBytes = totalAllocatorDeallocatedBytes;
-
-	for (auto& e : perNameData)
+	if (threadIndex == 0xFFFFFFFF)
 	{
-		e.second.DeallocationCount = 0;
-		e.second.AllocationCount = 0;
-		e.second.BytesAllocated = 0;
-		e.second.BytesDeallocated = 0;
+		const auto index = threadCount.fetch_add(1, std::memory_order_relaxed);
+		threadIndex = index < MAX_THREADS ? index : MAX_THREADS;
 	}
 
-	blockMisses = 0;
+	return threadIndex;
+}
 
-	bytesAllocated = 0;
-	bytesDeallocated = 0;
+StackAllocator::Stack& StackAllocator::getStack(const uint32 thread, const uint64 frame)
+{
+	auto* stacks = threadStacks[thread].load(std::memory_order_acquire);
 
-	allocationsCount = 0;
-	deallocationsCount = 0;
+	if (!stacks)
+	{
+		uint64 allocated_size{ 0 };
+		allocatorReference->Allocate(sizeof(Stack) * FRAME_COUNT, alignof(Stack), reinterpret_cast<void**>(&stacks), &allocated_size);
+		for (uint8 i = 0; i < FRAME_COUNT; ++i) { ::new(stacks + i) Stack(*allocatorReference); }
 
-	allocatorAllocationsCount = 0;
-	allocatorDeallocationsCount = 0;
+		//only the owning thread creates it's stacks, Clear may read them from another thread right away
+		threadStacks[thread].store(stacks, std::memory_order_release);
+	}
 
-	allocatorAllocatedBytes = 0;
-	allocatorDeallocatedBytes = 0;
+	return stacks[frame % FRAME_COUNT];
 }
-#endif
 
 void StackAllocator::Clear()
 {
-	for (auto& stack : stacks)
-	{
-		for (auto& block : stack)
-		{
-			block.Clear();
-		}
-	}
-}
+	const uint64 next_frame = frame.load(std::memory_order_relaxed) + 1;
 
-void StackAllocator::LockedClear()
-{
-	for (auto& stack : stacks)
+	//stacks of the new frame aren't touched by other threads until they see the new frame
+	for (auto& thread_stacks : threadStacks)
 	{
-		for (auto& block : stack)
-		{
-			const auto i = static_cast<uint32>(&stack - stacks.begin());
-			stacksMutexes[i].Lock();
-			block.Clear();
-			stacksMutexes[i].Unlock();
-		}
+		auto* stacks = thread_stacks.load(std::memory_order_acquire);
+		if (!stacks) { continue; }
+
+		auto& stack = stacks[next_frame % FRAME_COUNT];
+		for (auto& block : stack.Blocks) { block.Clear(); }
+		stack.CurrentBlock = 0;
+		freeLargeBlocks(stack);
 	}
+
+	frame.store(next_frame, std::memory_order_release);
 }
 
 void StackAllocator::Allocate(const uint64 size, const uint64 alignment, void** memory, uint64* allocatedSize, const char* name)
 {
-	const auto i{ stackIndex % MAX_STACKS }; ++stackIndex;
-
 	BE_ASSERT((alignment & (alignment - 1)) == 0, "Alignment is not power of two!")
-	BE_ASSERT(size <= blockSize, "Single allocation is larger than block sizes! An allocation larger than block size can't happen.")
+	BE_STATISTICS_ONLY(AllocationStatistics::RecordAllocation(AllocationStatistics::AllocatorType::TRANSIENT, name, size))
 
-	uint64 allocated_size{0};
+	const auto thread = getThreadIndex();
+	const auto current_frame = frame.load(std::memory_order_acquire);
 
-	if constexpr (BE_DEBUG)
+	if (thread == MAX_THREADS)
 	{
-		GTSL::Lock<GTSL::Mutex> lock(debugDataMutex);
-		perNameData.try_emplace(GTSL::Id64(name)).first->second.Name = name;
+		GTSL::Lock<GTSL::Mutex> lock(overflowMutex);
+		allocateInStack(getStack(thread, current_frame), size, alignment, memory, allocatedSize);
 	}
-
-	stacksMutexes[i].Lock();
-	for (auto& block : stacks[i])
+	else
 	{
-		if (block.TryAllocateInBlock(size, alignment, memory, allocated_size))
-		{
-			stacksMutexes[i].Unlock();
-			*allocatedSize = allocated_size;
+		allocateInStack(getStack(thread, current_frame), size, alignment, memory, allocatedSize);
+	}
+}
 
-			if constexpr (BE_DEBUG)
-			{
-				GTSL::Lock<GTSL::Mutex> lock(debugDataMutex);
-				perNameData[GTSL::Id64(name)].BytesAllocated += allocated_size;
-				perNameData[GTSL::Id64(name)].AllocationCount += 1;
-				bytesAllocated += allocated_size;
-				totalBytesAllocated += allocated_size;
-				++allocationsCount;
-				++totalAllocationsCount;
-			}
+void StackAllocator::allocateInStack(Stack& stack, const uint64 size, const uint64 alignment, void** memory, uint64* allocatedSize)
+{
+	//would waste most of a block, or not fit at all
+	if (size > blockSize / 2) { allocateLarge(stack, size, alignment, memory, allocatedSize); return; }
 
-			return;
-		}
+	uint64 allocated_size{ 0 };
 
-		if constexpr (BE_DEBUG)
+	for (; stack.CurrentBlock < stack.Blocks.GetLength(); ++stack.CurrentBlock)
+	{
+		if (stack.Blocks[stack.CurrentBlock].TryAllocateInBlock(size, alignment, memory, allocated_size))
 		{
-			debugDataMutex.Lock();
-			++blockMisses;
-			debugDataMutex.Unlock();
+			*allocatedSize = allocated_size;
+			return;
 		}
 	}
 
-	const auto last_block = stacks[i].EmplaceBack();
-	stacks[i][last_block].AllocateBlock(blockSize, allocatorReference, allocated_size);
-	stacks[i][last_block].AllocateInBlock(size, alignment, memory, allocated_size);
-	stacksMutexes[i].Unlock();
+	uint64 block_size{ 0 };
+	const auto last_block = stack.Blocks.EmplaceBack();
+	stack.Blocks[last_block].AllocateBlock(blockSize, blockAlignment, allocatorReference, block_size);
+	stack.Blocks[last_block].AllocateInBlock(size, alignment, memory, allocated_size);
 	
 	*allocatedSize = allocated_size;
+}
 
-	if constexpr (BE_DEBUG)
-	{
-		GTSL::Lock<GTSL::Mutex> lock(debugDataMutex);
-		perNameData[GTSL::Id64(name)].BytesAllocated += allocated_size;
-		perNameData[GTSL::Id64(name)].AllocationCount += 1;
-		bytesAllocated += allocated_size;
-		totalBytesAllocated += allocated_size;
-		allocatorAllocatedBytes += allocated_size;
-		totalAllocatorAllocatedBytes += allocated_size;
-		++allocatorAllocationsCount;
-		++totalAllocatorAllocationsCount;
-		++allocationsCount;
-		++totalAllocationsCount;
-	}
+void StackAllocator::allocateLarge(Stack& stack, const uint64 size, const uint64 alignment, void** memory, uint64* allocatedSize)
+{
+	uint64 block_size{ 0 }, allocated_size{ 0 };
+
+	const auto last_block = stack.LargeBlocks.EmplaceBack();
+	stack.LargeBlocks[last_block].AllocateBlock(GTSL::Math::PowerOf2RoundUp(size, SystemAllocator::PAGE_SIZE), alignment > SystemAllocator::PAGE_SIZE ? alignment : SystemAllocator::PAGE_SIZE, allocatorReference, block_size);
+	stack.LargeBlocks[last_block].AllocateInBlock(size, alignment, memory, allocated_size);
+
+	*allocatedSize = allocated_size;
+}
+
+void StackAllocator::freeLargeBlocks(Stack& stack)
+{
+	uint64 freed_bytes{ 0 };
+
+	for (auto& block : stack.LargeBlocks) { block.DeallocateBlock(allocatorReference, freed_bytes); }
+
+	stack.LargeBlocks.ResizeDown(0);
 }
 
 void StackAllocator::Deallocate(const uint64 size, const uint64 alignment, void* memory, const char* name)
 {
 	BE_ASSERT((alignment & (alignment - 1)) == 0, "Alignment is not power of two!")
-	BE_ASSERT(size <= blockSize, "Deallocation size is larger than block size! An allocation larger than block size can't happen. Trying to deallocate more bytes than allocated!")
-
-	if constexpr (BE_DEBUG)
-	{
-		const auto bytes_deallocated{ GTSL::Math::PowerOf2RoundUp(size, alignment) };
-
-		GTSL::Lock<GTSL::Mutex> lock(debugDataMutex);
-		perNameData[GTSL::Id64(name)].BytesDeallocated += bytes_deallocated;
-		perNameData[GTSL::Id64(name)].DeallocationCount += 1;
-		bytesDeallocated += bytes_deallocated;
-		totalBytesDeallocated += bytes_deallocated;
-		++deallocationsCount;
-		++totalDeallocationsCount;
-	}
+	BE_STATISTICS_ONLY(AllocationStatistics::RecordDeallocation(AllocationStatistics::AllocatorType::TRANSIENT, name, size))
 }
 
 void StackAllocator::Free()
 {
 	uint64 freed_bytes{ 0 };
 	
-	for(auto& stack : stacks)
+	for (auto& thread_stacks : threadStacks)
 	{
-		for(auto& block : stack)
+		auto* stacks = thread_stacks.load(std::memory_order_acquire);
+		if (!stacks) { continue; }
+
+		for (uint8 i = 0; i < FRAME_COUNT; ++i)
 		{
-			block.DeallocateBlock(allocatorReference, freed_bytes);
-			if constexpr (BE_DEBUG)
-			{
-				++allocatorDeallocationsCount;
-				++totalAllocatorDeallocationsCount;
-			}
+			for (auto& block : stacks[i].Blocks) { block.DeallocateBlock(allocatorReference, freed_bytes); }
+
+			freeLargeBlocks(stacks[i]);
+
+			stacks[i].~Stack();
 		}
-	}
-	
-	if constexpr (BE_DEBUG)
-	{
-		allocatorDeallocatedBytes += freed_bytes;
-		totalAllocatorDeallocatedBytes += freed_bytes;
+
+		allocatorReference->Deallocate(sizeof(Stack) * FRAME_COUNT, alignof(Stack), stacks);
+		thread_stacks.store(nullptr, std::memory_order_relaxed);
 	}
 }
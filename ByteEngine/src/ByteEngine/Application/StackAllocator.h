@@ -2,94 +2,42 @@
 
 #include "ByteEngine/Core.h"
 
-#include <unordered_map>
-#include <GTSL/Id.h>
+#include <atomic>
 #include <GTSL/Mutex.h>
-#include <GTSL/Atomic.hpp>
-#include <GTSL/StaticString.hpp>
 #include <GTSL/Vector.hpp>
 #include "AllocatorReferences.h"
-
+#include "SystemAllocator.h"
+
+/**
+ * \brief Linear allocator for memory which only has to live for a frame, deallocations do nothing and everything is released at once by Clear.
+ * Every thread bumps it's own blocks, so allocating takes no locks. Each thread keeps a set of blocks per frame for FRAME_COUNT frames, memory allocated
+ * while a frame is the current one stays valid until FRAME_COUNT - 1 more frames have been started, so pipelined frames can keep using it.
+ * Allocations bigger than half a block get their own page rounded chunk from the system allocator, released when the frame's blocks are emptied,
+ * so blocks can be kept small. Blocks can be made of huge pages.
+ */
 class StackAllocator
 {
 public:
-	struct DebugData
-	{
-		explicit DebugData(BE::SystemAllocatorReference* allocatorReference)
-		{
-		}
-		
-		struct PerNameData
-		{
-			const char* Name{ nullptr };
-			uint64 AllocationCount{ 0 };
-			uint64 DeallocationCount{ 0 };
-			uint64 BytesAllocated{ 0 };
-			uint64 BytesDeallocated{ 0 };
-		};
-		
-		std::unordered_map<GTSL::Id64::HashType, PerNameData> PerNameAllocationsData;
-		
-		/**
-		 * \brief Number of times it was tried to allocate on different blocks to no avail.
-		 * To improve this number(lower it) try to make the blocks bigger.
-		 * Don't make it so big that in the event that a new block has to be allocated it takes up too much space.
-		 * Reset to 0 on every call to GetDebugInfo()
-		 */
-		uint64 BlockMisses{ 0 };
-
-		uint64 BytesAllocated{ 0 };
-		uint64 TotalBytesAllocated{ 0 };
-		
-		uint64 BytesDeallocated{ 0 };
-		uint64 TotalBytesDeallocated{ 0 };
-		
-		uint64 AllocatorAllocatedBytes{ 0 };
-		uint64 TotalAllocatorAllocatedBytes{ 0 };
-
-		uint64 AllocatorDeallocatedBytes{ 0 };
-		uint64 TotalAllocatorDeallocatedBytes{ 0 };
-		
-		uint64 AllocationsCount{ 0 };
-		uint64 TotalAllocationsCount{ 0 };
-		
-		uint64 DeallocationsCount{ 0 };
-		uint64 TotalDeallocationsCount{ 0 };
-		
-		uint64 AllocatorAllocationsCount{ 0 };
-		uint64 TotalAllocatorAllocationsCount{ 0 };
-		
-		uint64 AllocatorDeallocationsCount{ 0 };
-		uint64 TotalAllocatorDeallocationsCount{ 0 };
-
-		operator GTSL::StaticString<1024>() const
-		{
-#define ADD_FIELD(string, var) string += #var; (string) += ": "; (string) += (var); (string) += '\n';
-			
-			GTSL::StaticString<1024> result;
-			ADD_FIELD(result, BytesAllocated)
-			ADD_FIELD(result, TotalBytesAllocated)
-			ADD_FIELD(result, TotalAllocatorAllocatedBytes)
-			ADD_FIELD(result, TotalAllocatorDeallocatedBytes)
-
-#undef ADD_FIELD
-			return result;
-		}
-	};
+	/**
+	 * \brief Frames a thread's allocations are kept for. Allocations made during a frame can be used by the next frame(dynamic tasks), which can still be running
+	 * while GameInstance::MAX_FRAMES_IN_FLIGHT newer frames have started.
+	 */
+	static constexpr uint8 FRAME_COUNT = 5;
 
 	StackAllocator() = default;
-	explicit StackAllocator(BE::SystemAllocatorReference* allocatorReference, uint8 stackCount = 8, uint8 defaultBlocksPerStackCount = 2, uint64 blockSizes = 512);
+	/**
+	 * \param hugePages Whether blocks are rounded up to and aligned to SystemAllocator::HUGE_PAGE_SIZE so they are backed by huge pages.
+	 */
+	explicit StackAllocator(BE::SystemAllocatorReference* allocatorReference, uint64 blockSize = 512, bool hugePages = false);
 
 	~StackAllocator();
 
-#if BE_DEBUG
-	void GetDebugData(DebugData& debugData);
-#endif
-
+	/**
+	 * \brief Starts a new frame and makes every thread's blocks for it empty, O(threads).
+	 * The emptied blocks are the ones which were used FRAME_COUNT frames ago, nothing allocated back then can still be in use.
+	 */
 	void Clear();
 
-	void LockedClear();
-
 	void Allocate(uint64 size, uint64 alignment, void** memory, uint64* allocatedSize, const char* name);
 
 	void Deallocate(uint64 size, uint64 alignment, void* memory, const char* name);
@@ -105,7 +53,9 @@ protected:
 		byte* at{ nullptr };
 		byte* end{ nullptr };
 
-		void AllocateBlock(uint64 minimumSize, BE::SystemAllocatorReference* allocatorReference, uint64& allocatedSize);
+		uint64 alignment{ 0 };
+
+		void AllocateBlock(uint64 minimumSize, uint64 blockAlignment, BE::SystemAllocatorReference* allocatorReference, uint64& allocatedSize);
 
 		void DeallocateBlock(BE::SystemAllocatorReference* allocatorReference, uint64& deallocatedBytes) const;
 
@@ -119,42 +69,49 @@ protected:
 		[[nodiscard]] uint64 GetRemainingSize() const { return end - at; }
 	};
 
-	const uint64 blockSize{ 0 };
-	GTSL::Atomic<uint32> stackIndex{ 0 };
-	GTSL::Vector<GTSL::Vector<Block, BE::SystemAllocatorReference>, BE::SystemAllocatorReference> stacks;
-	GTSL::Vector<GTSL::Mutex, BE::SystemAllocatorReference> stacksMutexes;
-	BE::SystemAllocatorReference* allocatorReference{ nullptr };
+	struct Stack
+	{
+		explicit Stack(const BE::SystemAllocatorReference& allocatorReference) : Blocks(4, allocatorReference), LargeBlocks(4, allocatorReference) {}
 
-#if BE_DEBUG
-	uint64 blockMisses{ 0 };
-	std::unordered_map<GTSL::Id64::HashType, DebugData::PerNameData> perNameData;
-	GTSL::Mutex debugDataMutex;
+		GTSL::Vector<Block, BE::SystemAllocatorReference> Blocks;
+		/**
+		 * \brief Chunks holding a single allocation too big for the blocks, deallocated instead of reused.
+		 */
+		GTSL::Vector<Block, BE::SystemAllocatorReference> LargeBlocks;
+		/**
+		 * \brief Index of the first block which might have room, blocks before it are full.
+		 */
+		uint32 CurrentBlock = 0;
+	};
+
+	static constexpr uint32 MAX_THREADS = 64;
 
-	uint64 bytesAllocated{ 0 };
-	uint64 bytesDeallocated{ 0 };
+	const uint64 blockSize{ 0 };
+	const uint64 blockAlignment{ 0 };
+	BE::SystemAllocatorReference* allocatorReference{ nullptr };
 
-	uint64 totalAllocatorAllocatedBytes{ 0 };
-	uint64 totalAllocatorDeallocatedBytes{ 0 };
+	std::atomic<uint64> frame{ 0 };
 
-	uint64 allocationsCount{ 0 };
-	uint64 deallocationsCount{ 0 };
+	/**
+	 * \brief FRAME_COUNT stacks per thread, created on a thread's first allocation. The last entry is shared by the threads past MAX_THREADS, behind overflowMutex.
+	 */
+	std::atomic<Stack*> threadStacks[MAX_THREADS + 1]{};
+	GTSL::Mutex overflowMutex;
 
-	uint64 allocatorAllocationsCount{ 0 };
-	uint64 allocatorDeallocationsCount{ 0 };
+	/**
+	 * \brief Index every thread gets the first time it allocates from any stack allocator, MAX_THREADS for threads past the limit.
+	 */
+	inline static thread_local uint32 threadIndex{ 0xFFFFFFFF };
+	inline static std::atomic<uint32> threadCount{ 0 };
 
-	uint64 allocatorAllocatedBytes{ 0 };
-	uint64 allocatorDeallocatedBytes{ 0 };
+	static uint32 getThreadIndex();
 
-	uint64 totalBytesAllocated{ 0 };
-	uint64 totalBytesDeallocated{ 0 };
+	Stack& getStack(uint32 thread, uint64 frame);
 
-	uint64 totalAllocationsCount{ 0 };
-	uint64 totalDeallocationsCount{ 0 };
+	void allocateInStack(Stack& stack, uint64 size, uint64 alignment, void** memory, uint64* allocatedSize);
 
-	uint64 totalAllocatorAllocationsCount{ 0 };
-	uint64 totalAllocatorDeallocationsCount{ 0 };
-#endif
+	void allocateLarge(Stack& stack, uint64 size, uint64 alignment, void** memory, uint64* allocatedSize);
 
-	const uint8 MAX_STACKS{ 8 };
+	void freeLargeBlocks(Stack& stack);
 
 };
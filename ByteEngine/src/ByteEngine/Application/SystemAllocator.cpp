@@ -1,39 +1,70 @@
 #include "SystemAllocator.h"
 
-#include <GTSL/Memory.h>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
 #include <GTSL/Math/Math.hpp>
 
+#include "ByteEngine/Debug/Assert.h"
+
+#ifdef BE_PLATFORM_LINUX
+#include <sys/mman.h>
+#endif
+
+static std::align_val_t heapAlignment(const uint64 alignment)
+{
+	//aligned operator new and delete have to agree on alignment, small ones are all treated the same
+	return std::align_val_t(alignment < alignof(std::max_align_t) ? alignof(std::max_align_t) : alignment);
+}
+
 void SystemAllocator::Allocate(const uint64 size, const uint64 alignment, void** data)
 {
-	const uint64 allocated_size{ GTSL::Math::PowerOf2RoundUp(size, alignment) };
+	BE_ASSERT((alignment & (alignment - 1)) == 0, "Alignment is not power of two!")
 
-	allocatorMutex.Lock();
-	GTSL::Allocate(allocated_size, data);
-	allocatorMutex.Unlock();
+#ifdef BE_PLATFORM_LINUX
+	if (isMapped(size, alignment))
+	{
+		const uint64 length = GTSL::Math::PowerOf2RoundUp(size, PAGE_SIZE);
+		//mappings are only page aligned, map more and cut off what's before and after the aligned range
+		const uint64 extra = alignment > PAGE_SIZE ? alignment - PAGE_SIZE : 0;
 
-	//*data = GTSL::AlignPointer(alignment, data);
+		void* mapping = mmap(nullptr, length + extra, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (mapping == MAP_FAILED)
+		{
+			//can't fall back to the heap, deallocation tells mapped memory apart by size and alignment alone. The logger allocates, so report straight to stderr
+			fprintf(stderr, "Fatal: couldn't map %llu bytes aligned to %llu: %s\n", static_cast<unsigned long long>(size), static_cast<unsigned long long>(alignment), std::strerror(errno));
+			std::abort();
+		}
 
-	BE_DEBUG_ONLY(GTSL::Lock<GTSL::Mutex> lock(debugDataMutex))
-	BE_DEBUG_ONLY(allocatedBytes += allocated_size)
-	BE_DEBUG_ONLY(totalAllocatedBytes += allocated_size)
-	BE_DEBUG_ONLY(++allocationCount)
-	BE_DEBUG_ONLY(++totalAllocationCount)
+		byte* start = static_cast<byte*>(mapping);
+		byte* aligned = reinterpret_cast<byte*>((reinterpret_cast<uint64>(start) + alignment - 1) & ~(alignment - 1));
+
+		if (aligned != start) { munmap(start, aligned - start); }
+		if (start + length + extra != aligned + length) { munmap(aligned + length, (start + length + extra) - (aligned + length)); }
+
+		if (alignment >= HUGE_PAGE_SIZE) { madvise(aligned, length, MADV_HUGEPAGE); }
+
+		*data = aligned;
+		return;
+	}
+#endif
+
+	*data = ::operator new(size, heapAlignment(alignment));
 }
 
 void SystemAllocator::Deallocate(const uint64 size, const uint64 alignment, void* data)
 {
-	const uint64 allocation_size{GTSL::Math::PowerOf2RoundUp(size, alignment)};
-
-	//byte* dealigned_pointer = static_cast<byte*>(data) - (allocation_size - size);
-	byte* dealigned_pointer = static_cast<byte*>(data);
-	
-	allocatorMutex.Lock();
-	GTSL::Deallocate(allocation_size, dealigned_pointer);
-	allocatorMutex.Unlock();
-
-	BE_DEBUG_ONLY(GTSL::Lock<GTSL::Mutex> lock(debugDataMutex))
-	BE_DEBUG_ONLY(deallocatedBytes += allocation_size)
-	BE_DEBUG_ONLY(totalDeallocatedBytes += allocation_size)
-	BE_DEBUG_ONLY(++deallocationCount)
-	BE_DEBUG_ONLY(++totalDeallocationCount)
+#ifdef BE_PLATFORM_LINUX
+	if (isMapped(size, alignment))
+	{
+		munmap(data, GTSL::Math::PowerOf2RoundUp(size, PAGE_SIZE));
+		return;
+	}
+#endif
+
+	::operator delete(data, heapAlignment(alignment));
 }
@@ -1,64 +1,42 @@
 #pragma once
 
 #include "ByteEngine/Core.h"
-#include <GTSL/Mutex.h>
 
 /**
  * \brief Allocates memory directly from the OS. Useful for all other allocators.
+ * Honors the requested alignment. On Linux big or page aligned requests are mapped straight from the OS with mmap, and requests aligned to HUGE_PAGE_SIZE
+ * are advised to be backed by huge pages, which is how pool and stack allocators ask for huge page slabs. Everything else goes through the aligned global operator new.
+ * Takes no locks of it's own.
  */
 class SystemAllocator
 {
 public:
-	struct DebugData
-	{
-		uint64 AllocatedBytes{ 0 };
-		uint64 DeallocatedBytes{ 0 };
-		uint64 TotalAllocatedBytes{ 0 };
-		uint64 TotalDeallocatedBytes{ 0 };
-		uint64 AllocationCount{ 0 };
-		uint64 TotalAllocationCount{ 0 };
-		uint64 DeallocationCount{ 0 };
-		uint64 TotalDeallocationCount{ 0 };
-	};
-protected:
-	GTSL::Mutex allocatorMutex;
-	
-#if BE_DEBUG
-	GTSL::Mutex debugDataMutex;
-	uint64 allocatedBytes{ 0 };
-	uint64 deallocatedBytes{ 0 };
-	uint64 totalAllocatedBytes{ 0 };
-	uint64 totalDeallocatedBytes{ 0 };
-	uint64 allocationCount{ 0 };
-	uint64 deallocationCount{ 0 };
-	uint64 totalAllocationCount{ 0 };
-	uint64 totalDeallocationCount{ 0 };
-#endif
-	
-public:
+	static constexpr uint64 PAGE_SIZE = 4096;
+	static constexpr uint64 HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+	/**
+	 * \brief Requests of at least this size are mapped instead of going through the heap, on platforms which support it.
+	 */
+	static constexpr uint64 LARGE_ALLOCATION_SIZE = 256 * 1024;
+
 	SystemAllocator()
 	{
 		
 	}
 
-#if BE_DEBUG
-	void GetDebugData(DebugData& debugData)
-	{
-		GTSL::Lock<GTSL::Mutex> lock(debugDataMutex);
-		debugData.AllocationCount = allocationCount;
-		debugData.AllocatedBytes = allocatedBytes;
-		debugData.DeallocatedBytes = deallocatedBytes;
-		debugData.TotalAllocatedBytes = totalAllocatedBytes;
-		debugData.TotalDeallocatedBytes = totalDeallocatedBytes;
-		debugData.TotalAllocationCount = totalAllocationCount;
-
-		allocationCount = 0;
-		allocatedBytes = 0;
-		deallocatedBytes = 0;
-	}
-#endif
-
 	void Allocate(const uint64 size, const uint64 alignment, void** data);
 
 	void Deallocate(const uint64 size, const uint64 alignment, void* data);
+
+private:
+	/**
+	 * \brief Whether a request is served by mapping pages, has to give the same answer for an allocation and it's deallocation.
+	 */
+	static bool isMapped(const uint64 size, const uint64 alignment)
+	{
+#ifdef BE_PLATFORM_LINUX
+		return size >= LARGE_ALLOCATION_SIZE || alignment > PAGE_SIZE;
+#else
+		return false;
+#endif
+	}
 };
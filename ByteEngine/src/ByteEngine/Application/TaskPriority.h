@@ -0,0 +1,21 @@
+#pragma once
+
+#include "ByteEngine/Core.h"
+
+/**
+ * \brief Priority class of a task. Higher priority tasks are dispatched and picked up by workers before lower priority ones.
+ */
+enum class TaskPriority : uint8
+{
+	/**
+	 * \brief Work the frame can't be presented without, like render setup and submission.
+	 */
+	HIGH,
+	NORMAL,
+	/**
+	 * \brief Background work like resource load callbacks, can be deferred to later frames when the frame is over budget.
+	 */
+	LOW
+};
+
+static constexpr uint8 TASK_PRIORITY_COUNT = 3;
@@ -0,0 +1,184 @@
+#include "BenchmarkApplication.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "Benchmarks/AllocatorBenchmark.h"
+#include "Benchmarks/BenchmarkThreads.h"
+#include "Benchmarks/ProfilerBenchmark.h"
+#include "Benchmarks/TLBBenchmark.h"
+#include "ByteEngine/Application/ThreadPool.h"
+#include "ByteEngine/Game/GameInstance.h"
+#include "ByteEngine/Game/System.h"
+
+/**
+ * \brief System which owns no data, only exists so tasks have objects to declare accesses to.
+ */
+class BenchmarkSystem : public System
+{
+public:
+	BenchmarkSystem() : System("BenchmarkSystem") {}
+
+	void Initialize(const InitializeInfo& initializeInfo) override {}
+	void Shutdown(const ShutdownInfo& shutdownInfo) override {}
+};
+
+void BenchmarkApplication::Initialize()
+{
+	Application::Initialize();
+
+	BE_ASSERT(settings.Systems && settings.Systems <= MAX_SYSTEMS, "Invalid number of systems!")
+	BE_ASSERT(settings.RecurringTasks <= MAX_RECURRING_TASKS, "Too many recurring tasks!")
+
+	gameInstance = GTSL::SmartPointer<GameInstance, BE::SystemAllocatorReference>::Create<GameInstance>(systemAllocatorReference);
+
+	uint64 allocatedSize{ 0 };
+	GetPersistentAllocator().Allocate(sizeof(uint32) * MAX_LATENCY_SAMPLES, alignof(uint32), reinterpret_cast<void**>(&latencySamples), &allocatedSize);
+
+	randomState = settings.Seed ? settings.Seed : 1;
+}
+
+void BenchmarkApplication::PostInitialize()
+{
+	if (settings.AllocatorIterations) { AllocatorBenchmark(settings.AllocatorIterations, settings.Seed).Run(); }
+	if (settings.TLBWalkMegabytes) { TLBBenchmark(settings.TLBWalkMegabytes, settings.Seed).Run(); }
+	if (settings.ProfilerEvents) { ProfilerBenchmark(settings.ProfilerEvents).Run(); }
+
+	for (uint32 i = 0; i < GOAL_COUNT; ++i) { gameInstance->AddGoal(GOALS[i]); }
+
+	gameInstance->SetFramesInFlight(settings.FramesInFlight);
+
+	for (uint32 i = 0; i < settings.Systems; ++i)
+	{
+		systemNames.EmplaceBack("BenchmarkSystem"); systemNames.back() += i;
+		gameInstance->AddSystem<BenchmarkSystem>(systemNames.back().begin());
+	}
+
+	GTSL::Array<TaskDependency, 8> dependencies;
+
+	for (uint32 i = 0; i < settings.RecurringTasks; ++i)
+	{
+		taskNames.EmplaceBack("BenchmarkTask"); taskNames.back() += i;
+
+		buildDependencies(dependencies);
+		const uint32 startOn = random(GOAL_COUNT); const uint32 doneFor = startOn + random(GOAL_COUNT - startOn);
+
+		gameInstance->AddTask(taskNames.back().begin(), GTSL::Delegate<void(TaskInfo)>::Create<BenchmarkApplication, &BenchmarkApplication::work>(this), dependencies, GOALS[startOn], GOALS[doneFor]);
+	}
+
+	printf("Benchmark: %u systems, %u recurring tasks, %u dynamic tasks per frame, %u frames, %u frames in flight, %u worker threads\n", settings.Systems, settings.RecurringTasks,
+		settings.DynamicTasksPerFrame, settings.Frames, static_cast<uint32>(settings.FramesInFlight), static_cast<uint32>(ThreadPool::GetNumberOfThreads()));
+
+	benchmarkStart = BenchmarkThreads::Now();
+}
+
+void BenchmarkApplication::OnUpdate(const OnUpdateInfo& updateInfo)
+{
+	addDynamicTasks();
+
+	Application::OnUpdate(updateInfo);
+
+	if (++frameCount >= settings.Frames)
+	{
+		//with one frame in flight it has finished by now and nothing else enqueues tasks, so no more tasks than a frame's are ever alive at once, which bounds what the pool can allocate
+		if (settings.FramesInFlight == 1 && gameInstance->GetSteadyStateTaskAllocations() > ThreadPool::GetMaxTaskAllocations(settings.RecurringTasks + settings.DynamicTasksPerFrame))
+		{
+			static constexpr UTF8 REASON[] = "Thread pool kept allocating task records in frames";
+			Close(CloseMode::ERROR, GTSL::Ranger<const UTF8>(sizeof(REASON) - 1, REASON));
+			return;
+		}
+
+		Close(CloseMode::OK, GTSL::Ranger<const UTF8>());
+	}
+}
+
+void BenchmarkApplication::Shutdown()
+{
+	gameInstance->WaitForFrames(this);
+
+	const uint64 elapsed = BenchmarkThreads::Now() - benchmarkStart;
+	const float64 seconds = static_cast<float64>(elapsed) / 1000000000.0;
+
+	const uint32 samples = latencySampleCount.load() < MAX_LATENCY_SAMPLES ? latencySampleCount.load() : MAX_LATENCY_SAMPLES;
+	std::sort(latencySamples, latencySamples + samples);
+
+	auto percentile = [&](const uint32 p) -> float64 { return samples ? static_cast<float64>(latencySamples[(samples - 1) * p / 100]) / 1000.0 : 0.0; };
+
+	//main thread takes part in running tasks too
+	const float64 utilization = static_cast<float64>(busyTime.load()) / (static_cast<float64>(elapsed) * (ThreadPool::GetNumberOfThreads() + 1)) * 100.0;
+
+	//printed directly since logs are compiled out of release builds, which is what should be benchmarked
+	printf("Benchmark results: %.2f frames/sec over %llu frames\n", static_cast<float64>(frameCount) / seconds, frameCount);
+	printf("Dynamic task dispatch latency(us): p50 %.2f, p90 %.2f, p99 %.2f, max %.2f\n", percentile(50), percentile(90), percentile(99), percentile(100));
+	printf("Core utilization: %.1f%%\n", utilization);
+	printf("Task record allocations after warm-up: %llu\n", gameInstance->GetSteadyStateTaskAllocations());
+
+	printf("Persistent allocator size classes(slot size: allocations, live, wasted bytes live/total):\n");
+
+	for (uint8 i = 0; i < PoolAllocator::GetSizeClassCount(); ++i)
+	{
+		const auto statistics = GetNormalAllocator()->GetSizeClassStatistics(i);
+		if (!statistics.Allocations) { continue; }
+
+		printf("  %u: %llu, %lld, %lld/%llu\n", statistics.SlotSize, statistics.Allocations, statistics.LiveAllocations, statistics.GetWastedBytes(), statistics.GetTotalWastedBytes());
+	}
+
+	GetPersistentAllocator().Deallocate(sizeof(uint32) * MAX_LATENCY_SAMPLES, alignof(uint32), latencySamples);
+
+	Application::Shutdown();
+}
+
+uint32 BenchmarkApplication::random(const uint32 max)
+{
+	//xorshift64, same sequence for the same seed on every platform
+	randomState ^= randomState << 13; randomState ^= randomState >> 7; randomState ^= randomState << 17;
+	return static_cast<uint32>(randomState % max);
+}
+
+void BenchmarkApplication::buildDependencies(GTSL::Array<TaskDependency, 8>& dependencies)
+{
+	dependencies.Resize(0);
+
+	const uint32 count = 1 + random(settings.MaxDependencies < 8 ? settings.MaxDependencies : 8);
+
+	for (uint32 i = 0; i < count; ++i)
+	{
+		const auto access = random(100) < settings.WritePercentage ? AccessType::READ_WRITE : AccessType::READ;
+		dependencies.EmplaceBack(Id(systemNames[random(settings.Systems)].begin()), access);
+	}
+}
+
+void BenchmarkApplication::addDynamicTasks()
+{
+	GTSL::Array<TaskDependency, 8> dependencies;
+
+	for (uint32 i = 0; i < settings.DynamicTasksPerFrame; ++i)
+	{
+		buildDependencies(dependencies);
+		const uint32 startOn = random(GOAL_COUNT); const uint32 doneFor = startOn + random(GOAL_COUNT - startOn);
+
+		uint64 addedTime = BenchmarkThreads::Now();
+		gameInstance->AddDynamicTask("BenchmarkDynamicTask", GTSL::Delegate<void(TaskInfo, uint64)>::Create<BenchmarkApplication, &BenchmarkApplication::dynamicWork>(this), dependencies,
+			GOALS[startOn], GOALS[doneFor], GTSL::MoveRef(addedTime));
+	}
+}
+
+void BenchmarkApplication::work(TaskInfo taskInfo)
+{
+	const uint64 start = BenchmarkThreads::Now();
+
+	volatile uint64 accumulator = 0;
+	for (uint32 i = 0; i < settings.WorkIterations; ++i) { accumulator = accumulator * 6364136223846793005ull + i; }
+
+	busyTime.fetch_add(BenchmarkThreads::Now() - start, std::memory_order_relaxed);
+}
+
+void BenchmarkApplication::dynamicWork(const TaskInfo taskInfo, const uint64 addedTime)
+{
+	const uint64 start = BenchmarkThreads::Now();
+
+	const auto sample = latencySampleCount.fetch_add(1, std::memory_order_relaxed);
+	if (sample < MAX_LATENCY_SAMPLES) { latencySamples[sample] = static_cast<uint32>(start - addedTime); }
+
+	work(taskInfo);
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "ByteEngine/Application/Application.h"
+
+#include <atomic>
+
+#include <GTSL/Array.hpp>
+#include <GTSL/StaticString.hpp>
+
+#include "ByteEngine/Game/Tasks.h"
+
+/**
+ * \brief Headless application which stresses the GameInstance scheduler with a synthetic, reproducible load and reports how it performed.
+ * Creates a number of systems which do nothing but burn CPU, registers the same goal chain as GameApplication and adds recurring tasks plus
+ * dynamic tasks every frame, all with random dependency sets generated from a fixed seed. Needs no window or GPU.
+ * After running the requested number of frames it logs frames per second, dynamic task dispatch latency percentiles and core utilization, then closes.
+ * The benchmarks in Benchmarks/ whose setting isn't 0 run first.
+ */
+class BenchmarkApplication : public BE::Application
+{
+public:
+	struct BenchmarkSettings
+	{
+		uint32 Systems = 16;
+		uint32 RecurringTasks = 64;
+		uint32 DynamicTasksPerFrame = 32;
+		/**
+		 * \brief Maximum number of systems a task depends on, every task depends on at least one.
+		 */
+		uint32 MaxDependencies = 3;
+		/**
+		 * \brief Percentage of dependencies which are READ_WRITE, the rest are READ.
+		 */
+		uint32 WritePercentage = 30;
+		/**
+		 * \brief Iterations of busy work every task does.
+		 */
+		uint32 WorkIterations = 2000;
+		uint32 Frames = 1000;
+		uint8 FramesInFlight = 1;
+		uint64 Seed = 1;
+		/**
+		 * \brief Allocation and deallocation pairs per thread of AllocatorBenchmark. 0 skips it, like every setting below.
+		 */
+		uint32 AllocatorIterations = 0;
+		/**
+		 * \brief Size of the arrays walked by TLBBenchmark.
+		 */
+		uint32 TLBWalkMegabytes = 0;
+		/**
+		 * \brief Empty tasks per measurement of the Benchmark executable's ThreadPoolBenchmark, which isn't part of the engine.
+		 */
+		uint32 ThreadPoolTasks = 0;
+		/**
+		 * \brief Events per thread of ProfilerBenchmark.
+		 */
+		uint32 ProfilerEvents = 0;
+	};
+
+	BenchmarkApplication(const char* name, const BenchmarkSettings& settings) : Application(BE::ApplicationCreateInfo{ name }), settings(settings)
+	{
+	}
+
+	~BenchmarkApplication() = default;
+
+	void Initialize() override;
+	void PostInitialize() override;
+	void OnUpdate(const OnUpdateInfo& updateInfo) override;
+	void Shutdown() override;
+
+	const char* GetApplicationName() override { return "Benchmark"; }
+
+protected:
+	[[nodiscard]] const BenchmarkSettings& getSettings() const { return settings; }
+
+private:
+	static constexpr uint32 MAX_SYSTEMS = 64;
+	static constexpr uint32 MAX_RECURRING_TASKS = 512;
+	static constexpr uint32 MAX_LATENCY_SAMPLES = 1 << 20;
+
+	BenchmarkSettings settings;
+
+	/**
+	 * \brief Names are kept alive here since Id only stores a pointer to it's string.
+	 */
+	GTSL::Array<GTSL::StaticString<32>, MAX_SYSTEMS> systemNames;
+	GTSL::Array<GTSL::StaticString<32>, MAX_RECURRING_TASKS> taskNames;
+
+	uint64 randomState = 0;
+
+	/**
+	 * \brief Time from the frame a dynamic task was added on starting until it starts running, in nanoseconds.
+	 */
+	uint32* latencySamples = nullptr;
+	std::atomic<uint32> latencySampleCount{ 0 };
+
+	/**
+	 * \brief Time spent by all threads running task bodies, in nanoseconds.
+	 */
+	std::atomic<uint64> busyTime{ 0 };
+
+	uint64 benchmarkStart = 0;
+	uint64 frameCount = 0;
+
+	uint32 random(uint32 max);
+	void buildDependencies(GTSL::Array<TaskDependency, 8>& dependencies);
+	void addDynamicTasks();
+
+	void work(TaskInfo taskInfo);
+	void dynamicWork(TaskInfo taskInfo, uint64 addedTime);
+
+	static constexpr const char* GOALS[] = { "FrameStart", "GameplayStart", "GameplayEnd", "RenderStart", "RenderSetup", "RenderFinished", "RenderEnd", "FrameEnd" };
+	static constexpr uint32 GOAL_COUNT = 8;
+};
@@ -0,0 +1,44 @@
+#include "AllocatorBenchmark.h"
+
+#include "BenchmarkThreads.h"
+#include "ByteEngine/Application/Application.h"
+
+void AllocatorBenchmark::Run()
+{
+	static constexpr uint8 MAX_ALLOCATOR_THREADS = 32;
+
+	for (uint8 threadCount = 1; threadCount <= MAX_ALLOCATOR_THREADS; threadCount *= 2)
+	{
+		const float64 seconds = BenchmarkThreads::Run(threadCount, GTSL::Delegate<void(uint8)>::Create<AllocatorBenchmark, &AllocatorBenchmark::work>(this));
+		BenchmarkThreads::Report(true, "Allocator contention: %u threads, %.0f allocations/sec", static_cast<uint32>(threadCount), static_cast<float64>(iterations) * threadCount / seconds);
+	}
+}
+
+void AllocatorBenchmark::work(const uint8 thread)
+{
+	static constexpr uint32 LIVE_ALLOCATIONS = 64;
+
+	struct Allocation { void* Memory = nullptr; uint64 Size = 0; };
+	Allocation allocations[LIVE_ALLOCATIONS];
+
+	auto* allocator = BE::Application::Get()->GetNormalAllocator();
+
+	uint64 state = seed + thread;
+	auto size = [&]() -> uint64 { state ^= state << 13; state ^= state >> 7; state ^= state << 17; return 8 + state % 1024; };
+
+	//keeps a window of live allocations so frees happen in a different order than allocations, like real code
+	for (uint32 i = 0; i < iterations; ++i)
+	{
+		auto& allocation = allocations[i % LIVE_ALLOCATIONS];
+		if (allocation.Memory) { allocator->Deallocate(allocation.Size, alignof(uint64), allocation.Memory, GetName()); }
+
+		uint64 allocatedSize{ 0 };
+		allocation.Size = size();
+		allocator->Allocate(allocation.Size, alignof(uint64), &allocation.Memory, &allocatedSize, GetName());
+	}
+
+	for (auto& allocation : allocations)
+	{
+		if (allocation.Memory) { allocator->Deallocate(allocation.Size, alignof(uint64), allocation.Memory, GetName()); }
+	}
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "ByteEngine/Object.h"
+
+/**
+ * \brief Allocates and deallocates from the persistent allocator on 1 to 32 threads at once and reports allocations per second, to measure lock contention.
+ */
+class AllocatorBenchmark : public Object
+{
+public:
+	/**
+	 * \param iterations Allocation and deallocation pairs every thread does.
+	 */
+	AllocatorBenchmark(const uint32 iterations, const uint64 seed) : Object("Allocator Benchmark"), iterations(iterations), seed(seed ? seed : 1)
+	{
+	}
+
+	void Run();
+
+private:
+	uint32 iterations; uint64 seed;
+
+	void work(uint8 thread);
+};
@@ -0,0 +1,74 @@
+#include "BenchmarkThreads.h"
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <thread>
+
+#include "ByteEngine/Application/ThreadPool.h"
+#include "ByteEngine/Debug/Assert.h"
+
+BenchmarkThreads::BenchmarkThreads(const uint8 threadCount, const GTSL::Delegate<void(uint8)>& work) : Object("Benchmark Threads"), work(work), threadCount(threadCount)
+{
+	BE_ASSERT(threadCount <= MAX_THREADS, "Too many benchmark threads!")
+
+	for (uint8 i = 0; i < threadCount; ++i)
+	{
+		threads.EmplaceBack(GetPersistentAllocator(), i, GTSL::Delegate<void(BenchmarkThreads*, uint8)>::Create([](BenchmarkThreads* benchmarkThreads, const uint8 thread)
+		{
+			while (!benchmarkThreads->start.load(std::memory_order_acquire)) { std::this_thread::yield(); }
+			benchmarkThreads->work(thread);
+		}), this, i);
+	}
+}
+
+BenchmarkThreads::~BenchmarkThreads()
+{
+	if (!joined) { start.store(true, std::memory_order_release); Join(); } //threads which were never started would wait forever
+}
+
+void BenchmarkThreads::Start()
+{
+	startTime = Now();
+	start.store(true, std::memory_order_release);
+}
+
+float64 BenchmarkThreads::Join()
+{
+	for (auto& thread : threads) { thread.Join(GetPersistentAllocator()); }
+	joined = true;
+
+	return static_cast<float64>(Now() - startTime) / 1000000000.0;
+}
+
+float64 BenchmarkThreads::Run(const uint8 threadCount, const GTSL::Delegate<void(uint8)>& work)
+{
+	BenchmarkThreads threads(threadCount, work);
+	threads.Start();
+	return threads.Join();
+}
+
+uint8 BenchmarkThreads::GetTaskThreadCount(const uint8 max)
+{
+	const uint32 count = ThreadPool::GetNumberOfThreads() + 1u;
+	return static_cast<uint8>(count < max ? count : max);
+}
+
+uint64 BenchmarkThreads::Now()
+{
+	return static_cast<uint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+bool BenchmarkThreads::Report(const bool passed, const char* format, ...)
+{
+	if (!passed) { printf("FAILED: "); }
+
+	va_list arguments;
+	va_start(arguments, format);
+	vprintf(format, arguments);
+	va_end(arguments);
+
+	printf("\n");
+
+	return passed;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "ByteEngine/Object.h"
+
+#include <atomic>
+
+#include <GTSL/Array.hpp>
+#include <GTSL/Delegate.hpp>
+#include <GTSL/Thread.h>
+
+/**
+ * \brief Threads of a benchmark or stress test. They are all released at once by Start, so every thread contends from it's first operation.
+ */
+class BenchmarkThreads : public Object
+{
+public:
+	static constexpr uint8 MAX_THREADS = 64;
+
+	/**
+	 * \brief Creates threadCount threads which wait for Start and then call work with their index.
+	 */
+	BenchmarkThreads(uint8 threadCount, const GTSL::Delegate<void(uint8)>& work);
+
+	/**
+	 * \brief Joins the threads if Join wasn't called, releasing them first if they weren't started.
+	 */
+	~BenchmarkThreads();
+
+	void Start();
+
+	/**
+	 * \brief Waits for every thread to return from work.
+	 * \return Seconds from Start until every thread was done.
+	 */
+	float64 Join();
+
+	/**
+	 * \brief Runs work on threadCount threads released all at once and returns the seconds it took.
+	 */
+	static float64 Run(uint8 threadCount, const GTSL::Delegate<void(uint8)>& work);
+
+	[[nodiscard]] uint8 GetThreadCount() const { return threadCount; }
+
+	/**
+	 * \brief As many threads as can run tasks at once, the thread pool's workers plus the main thread, but no more than max.
+	 */
+	static uint8 GetTaskThreadCount(uint8 max = MAX_THREADS);
+
+	static uint64 Now();
+
+	/**
+	 * \brief Prints a line of results. Printed directly since logs are compiled out of release builds, which is what should be benchmarked.
+	 * \return passed, lines of checks which failed are marked as such.
+	 */
+	static bool Report(bool passed, const char* format, ...);
+
+private:
+	GTSL::Delegate<void(uint8)> work;
+	GTSL::Array<GTSL::Thread, MAX_THREADS> threads;
+	uint8 threadCount = 0;
+	bool joined = false;
+
+	std::atomic<bool> start{ false };
+	uint64 startTime = 0;
+};
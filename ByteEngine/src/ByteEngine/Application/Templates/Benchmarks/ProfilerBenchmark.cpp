@@ -0,0 +1,33 @@
+#include "ProfilerBenchmark.h"
+
+#include "BenchmarkThreads.h"
+#include "ByteEngine/Debug/TaskProfiler.h"
+
+void ProfilerBenchmark::Run()
+{
+#ifdef BE_DEBUG
+	//profiler buffers are per thread and never given back, leave room for the ones of the workers and the main thread
+	static constexpr uint8 MAX_PROFILER_THREADS = 32;
+	const uint8 threadCount = BenchmarkThreads::GetTaskThreadCount(MAX_PROFILER_THREADS);
+	BenchmarkThreads::Run(threadCount, GTSL::Delegate<void(uint8)>::Create<ProfilerBenchmark, &ProfilerBenchmark::work>(this));
+
+	BenchmarkThreads::Report(true, "Task profiler: %u threads, %.1f ns per event, budget is 50 ns", static_cast<uint32>(threadCount), static_cast<float64>(nanoseconds.load()) / (static_cast<float64>(events) * threadCount));
+#else
+	BenchmarkThreads::Report(true, "Task profiler: skipped, the profiler is only compiled in debug builds");
+#endif
+}
+
+void ProfilerBenchmark::work(const uint8 thread)
+{
+#ifdef BE_DEBUG
+	const Id name("Profiler Benchmark");
+
+	//the first event allocates the thread's buffer, which isn't what is being measured
+	{ TaskProfiler::TaskScope scope(name, 0); }
+
+	//a TaskScope is what every task pays, both clock reads and the write to the thread's buffer
+	const uint64 start = BenchmarkThreads::Now();
+	for (uint32 i = 0; i < events; ++i) { TaskProfiler::TaskScope scope(name, i % 8); }
+	nanoseconds.fetch_add(BenchmarkThreads::Now() - start, std::memory_order_relaxed);
+#endif
+}
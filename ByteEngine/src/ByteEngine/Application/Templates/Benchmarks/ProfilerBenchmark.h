@@ -0,0 +1,27 @@
+#pragma once
+
+#include "ByteEngine/Object.h"
+
+#include <atomic>
+
+/**
+ * \brief Measures what recording a TaskProfiler event costs while as many threads as run tasks record at once. The profiler is only compiled in debug builds.
+ */
+class ProfilerBenchmark : public Object
+{
+public:
+	/**
+	 * \param events Events every thread records.
+	 */
+	explicit ProfilerBenchmark(const uint32 events) : Object("Profiler Benchmark"), events(events)
+	{
+	}
+
+	void Run();
+
+private:
+	uint32 events;
+	std::atomic<uint64> nanoseconds{ 0 };
+
+	void work(uint8 thread);
+};
@@ -0,0 +1,54 @@
+#include "TLBBenchmark.h"
+
+#include <GTSL/Math/Math.hpp>
+
+#include "BenchmarkThreads.h"
+#include "ByteEngine/Application/SystemAllocator.h"
+
+void TLBBenchmark::Run()
+{
+	const uint64 size = GTSL::Math::PowerOf2RoundUp(static_cast<uint64>(megabytes) * 1024 * 1024, SystemAllocator::HUGE_PAGE_SIZE);
+
+	const float64 smallPages = walkPages(size, SystemAllocator::PAGE_SIZE);
+	const float64 hugePages = walkPages(size, SystemAllocator::HUGE_PAGE_SIZE);
+
+	BenchmarkThreads::Report(true, "TLB walk: %u MB, small pages %.2f ns/access, huge pages %.2f ns/access", megabytes, smallPages, hugePages);
+}
+
+float64 TLBBenchmark::walkPages(const uint64 size, const uint64 alignment)
+{
+	const BE::SystemAllocatorReference allocator(GetName());
+	const uint64 pages = size / SystemAllocator::PAGE_SIZE;
+
+	byte* data{ nullptr }; uint64 allocatedSize{ 0 };
+	allocator.Allocate(size, alignment, reinterpret_cast<void**>(&data), &allocatedSize);
+
+	//every page stores the offset of the next one to visit at it's start, shuffled so the hardware prefetcher can't guess it
+	uint64* order{ nullptr };
+	allocator.Allocate(pages * sizeof(uint64), alignof(uint64), reinterpret_cast<void**>(&order), &allocatedSize);
+	for (uint64 i = 0; i < pages; ++i) { order[i] = i; }
+
+	uint64 state = seed;
+	for (uint64 i = pages - 1; i > 0; --i)
+	{
+		state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+		const uint64 j = state % (i + 1); const uint64 t = order[i]; order[i] = order[j]; order[j] = t;
+	}
+
+	for (uint64 i = 0; i < pages; ++i) { *reinterpret_cast<uint64*>(data + order[i] * SystemAllocator::PAGE_SIZE) = order[(i + 1) % pages] * SystemAllocator::PAGE_SIZE; }
+
+	allocator.Deallocate(pages * sizeof(uint64), alignof(uint64), order);
+
+	static constexpr uint32 WALKS = 8;
+
+	const uint64 start = BenchmarkThreads::Now();
+
+	volatile uint64 offset = 0;
+	for (uint64 i = 0; i < pages * WALKS; ++i) { offset = *reinterpret_cast<const uint64*>(data + offset); }
+
+	const uint64 elapsed = BenchmarkThreads::Now() - start;
+
+	allocator.Deallocate(size, alignment, data);
+
+	return static_cast<float64>(elapsed) / static_cast<float64>(pages * WALKS);
+}
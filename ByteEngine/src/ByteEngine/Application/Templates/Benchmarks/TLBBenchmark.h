@@ -0,0 +1,27 @@
+#pragma once
+
+#include "ByteEngine/Object.h"
+
+/**
+ * \brief Walks arrays backed by small and by huge pages a page at a time in random order, to measure the cost of TLB misses.
+ */
+class TLBBenchmark : public Object
+{
+public:
+	/**
+	 * \param megabytes Size of the arrays walked, rounded up to a huge page.
+	 */
+	TLBBenchmark(const uint32 megabytes, const uint64 seed) : Object("TLB Benchmark"), megabytes(megabytes), seed(seed ? seed : 1)
+	{
+	}
+
+	void Run();
+
+private:
+	uint32 megabytes; uint64 seed;
+
+	/**
+	 * \brief Follows a random chain through every page of an array allocated with alignment and returns the nanoseconds per access.
+	 */
+	float64 walkPages(uint64 size, uint64 alignment);
+};
@@ -63,6 +63,12 @@ void GameApplication::Initialize()
 	CreateResourceManager<AudioResourceManager>();
 	CreateResourceManager<PipelineCacheResourceManager>();
 	CreateResourceManager<FontResourceManager>();
+
+	//defaults, games can declare their own budgets in their Initialize or before calling GameApplication::PostInitialize
+	memoryBudget.DeclareComponents("StaticMeshRenderGroup", 256, StaticMeshRenderGroup::GetBytesPerComponent());
+	memoryBudget.DeclareComponents("CameraSystem", 4, CameraSystem::GetBytesPerComponent());
+	memoryBudget.DeclareComponents("TextureSystem", 64, TextureSystem::GetBytesPerComponent());
+	memoryBudget.DeclareComponents("TextSystem", 64, TextSystem::GetBytesPerComponent());
 }
 
 void GameApplication::PostInitialize()
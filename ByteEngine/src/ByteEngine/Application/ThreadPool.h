@@ -4,40 +4,73 @@
 #include "ByteEngine/Object.h"
 
 #include "ByteEngine/Debug/Logger.h"
+#include "ByteEngine/Debug/TaskProfiler.h"
+
+#include <atomic>
 
 #include <GTSL/Array.hpp>
-#include <GTSL/Atomic.hpp>
 #include <GTSL/Algorithm.h>
-#include <GTSL/Semaphore.h>
 #include <GTSL/Delegate.hpp>
-#include <GTSL/BlockingQueue.h>
+#include <GTSL/Memory.h>
+#include <GTSL/Mutex.h>
 #include <GTSL/Thread.h>
 #include <GTSL/Tuple.h>
 
-//https://github.com/mvorbrodt/blog
+#include "Latch.h"
+#include "TaskPriority.h"
+#include "WorkStealingDeque.h"
 
+/**
+ * \brief Work stealing thread pool.
+ * Every worker owns a Chase-Lev deque, tasks enqueued from a worker go to the bottom of it's own deque and are popped LIFO,
+ * idle workers steal FIFO from the top of other worker's deques. Tasks enqueued from threads not belonging to the pool
+ * go to a shared injection deque which can only be stolen from.
+ * There is a full set of deques per TaskPriority, workers look for higher priority tasks everywhere before lower priority ones.
+ * Workers that can't find work after spinning for a while park on an atomic wait and are woken up when new work is enqueued.
+ */
 class ThreadPool : public Object
 {
 	using TaskDelegate = GTSL::Delegate<void(ThreadPool*, void*)>;
-	using Tasks = GTSL::Tuple<TaskDelegate, void*, GTSL::Semaphore*>;
 public:
-	explicit ThreadPool() : Object("Thread Pool"), queues(threadCount)
-	{		
+	explicit ThreadPool() : Object("Thread Pool")
+	{
+		for (auto& priorityDeques : deques)
+		{
+			for (uint8 i = 0; i < threadCount + 1; ++i) { ::new(priorityDeques + i) WorkStealingDeque<TaskHeader*, BE::PersistentAllocatorReference>(DEQUE_CAPACITY, GetPersistentAllocator()); }
+		}
+
 		//lambda
 		auto workers_loop = [](ThreadPool* pool, const uint8 i)
-		{			
+		{
+			currentWorker = i;
+			BE_DEBUG_ONLY(TaskProfiler::SetCurrentWorker(i))
+
 			while (true)
-			{		
-				Tasks task;
-				
-				for (auto n = 0; n < threadCount * K; ++n)
+			{
+				TaskHeader* task{ nullptr };
+
+				for (uint32 n = 0; n < SPIN_COUNT; ++n) { if (pool->tryGetTask(i, task)) { break; } }
+
+				if (!task) //park
 				{
-					if (pool->queues[(i + n) % threadCount].TryPop(task)) { break; }
+					const auto epoch = pool->wakeEpoch.load(std::memory_order_seq_cst);
+					pool->sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+
+					if (!pool->tryGetTask(i, task))
+					{
+						if (pool->done.load(std::memory_order_acquire)) { pool->sleepingWorkers.fetch_sub(1, std::memory_order_seq_cst); break; }
+
+						BE_DEBUG_ONLY(const uint64 parkStart = TaskProfiler::Now())
+						pool->wakeEpoch.wait(epoch, std::memory_order_seq_cst);
+						BE_DEBUG_ONLY(TaskProfiler::Record("Parked", TaskProfiler::EventType::PARKED, 0xFFFF, parkStart))
+					}
+
+					pool->sleepingWorkers.fetch_sub(1, std::memory_order_seq_cst);
+
+					if (!task) { continue; }
 				}
 
-				if (!GTSL::Get<TUPLE_LAMBDA_DELEGATE_INDEX>(task) && !pool->queues[i].Pop(task)) { break;	}
-				
-				GTSL::Get<TUPLE_LAMBDA_DELEGATE_INDEX>(task)(pool, &task);
+				task->Work(pool, task);
 			}
 		};
 
@@ -51,51 +84,258 @@ public:
 
 	~ThreadPool()
 	{
-		for (auto& queue : queues) { queue.Done(); }
+		done.store(true, std::memory_order_release);
+		wakeEpoch.fetch_add(1, std::memory_order_seq_cst); wakeEpoch.notify_all();
+
 		for (auto& thread : threads) { thread.Join(GetPersistentAllocator()); }
+
+		for (uint8 i = 0; i < threadCount + 1; ++i)
+		{
+			auto* slab = caches[i].Slabs;
+
+			while (slab)
+			{
+				auto* next = slab->Next;
+				GetPersistentAllocator().Deallocate(slab->AllocationSize, alignof(uint64), slab->Allocation);
+				slab = next;
+			}
+		}
+	}
+
+	template<typename F, typename... ARGS>
+	void EnqueueTask(const GTSL::Delegate<F>& task, Latch* latch, ARGS&&... args)
+	{
+		EnqueueTask(TaskPriority::NORMAL, task, latch, GTSL::ForwardRef<ARGS>(args)...);
 	}
 
 	template<typename F, typename... ARGS>
-	void EnqueueTask(const GTSL::Delegate<F>& task, GTSL::Semaphore* semaphore, ARGS&&... args)
+	void EnqueueTask(const TaskPriority priority, const GTSL::Delegate<F>& task, Latch* latch, ARGS&&... args)
 	{
-		TaskInfo<F, ARGS...>* taskInfoAlloc = GTSL::New<TaskInfo<F, ARGS...>>(GetPersistentAllocator(), task, GTSL::ForwardRef<ARGS>(args)...);
+		auto& priorityDeques = deques[static_cast<uint8>(priority)];
 
 		auto work = [](ThreadPool* threadPool, void* voidTask) -> void
 		{
-			Tasks* task = static_cast<Tasks*>(voidTask);
-			TaskInfo<F, ARGS...>* taskInfo = static_cast<TaskInfo<F, ARGS...>*>(GTSL::Get<TUPLE_LAMBDA_TASK_INFO_INDEX>(*task));
-			
+			TaskInfo<F, ARGS...>* taskInfo = static_cast<TaskInfo<F, ARGS...>*>(static_cast<TaskHeader*>(voidTask));
+
 			GTSL::Call(taskInfo->Delegate, taskInfo->Arguments);
-			static_cast<GTSL::Semaphore*>(GTSL::Get<TUPLE_SEMAPHORE_INDEX>(*task))->Post();
+			if (taskInfo->DoneLatch) { taskInfo->DoneLatch->CountDown(); }
 
-			GTSL::Delete<TaskInfo<F, ARGS...>>(taskInfo, threadPool->GetPersistentAllocator());
+			auto* owner = taskInfo->Owner; const auto sizeClass = taskInfo->SizeClass;
+			taskInfo->~TaskInfo();
+			threadPool->freeTask(taskInfo, owner, sizeClass);
 		};
-		
-		const auto currentIndex = ++index;
 
-		for (auto n = 0; n < threadCount * K; ++n)
+		if (currentWorker != NO_WORKER) //called from inside a task, push to this worker's own deque
 		{
-			//Try to Push work into queues, if success return else when Done looping place into some queue.
+			auto* taskInfo = allocateTask<TaskInfo<F, ARGS...>>(&caches[currentWorker], task, GTSL::ForwardRef<ARGS>(args)...);
+			taskInfo->Work = TaskDelegate::Create(work); taskInfo->DoneLatch = latch;
+			priorityDeques[currentWorker].Push(taskInfo);
+		}
+		else //only the injection deque and it's task cache can be written to by more than one thread
+		{
+			GTSL::Lock lock(injectionMutex);
+			auto* taskInfo = allocateTask<TaskInfo<F, ARGS...>>(&caches[threadCount], task, GTSL::ForwardRef<ARGS>(args)...);
+			taskInfo->Work = TaskDelegate::Create(work); taskInfo->DoneLatch = latch;
+			priorityDeques[threadCount].Push(taskInfo);
+		}
+
+		wakeWorker();
+	}
+
+	/**
+	 * \brief Runs one pending task on the calling thread, if there is any.
+	 * Lets threads which are waiting on other tasks help instead of blocking.
+	 * \return Whether a task was run.
+	 */
+	bool TryRunTask()
+	{
+		TaskHeader* task{ nullptr };
 
-			if (queues[(currentIndex + n) % threadCount].TryPush(Tasks(TaskDelegate::Create(work), GTSL::MoveRef((void*)taskInfoAlloc), GTSL::MoveRef(semaphore)))) { return; }
+		if (currentWorker != NO_WORKER)
+		{
+			if (!tryGetTask(currentWorker, task)) { return false; }
+		}
+		else
+		{
+			for (uint8 p = 0; p < TASK_PRIORITY_COUNT && !task; ++p)
+			{
+				for (uint8 n = 0; n < threadCount + 1 && !task; ++n) { if (!deques[p][n].Steal(task)) { task = nullptr; } }
+			}
+			if (!task) { return false; }
 		}
 
-		queues[currentIndex % threadCount].Push(Tasks(TaskDelegate::Create(work), GTSL::MoveRef((void*)taskInfoAlloc), GTSL::MoveRef(semaphore)));
+		task->Work(this, task);
+		return true;
+	}
+
+	/**
+	 * \brief Returns the number of worker threads in the pool, not counting threads which help through TryRunTask.
+	 */
+	[[nodiscard]] static uint8 GetNumberOfThreads() { return threadCount; }
+
+	/**
+	 * \brief Returns the number of times the pool had to go to the persistent allocator to get memory for task records.
+	 * Task records are recycled so once the pool has warmed up this number should stay the same from frame to frame.
+	 */
+	[[nodiscard]] uint64 GetAllocationCount() const { return allocationCount.load(std::memory_order_relaxed); }
+
+	/**
+	 * \brief Returns the most slab allocations the pool can make for task records while no more than maxLiveTasks tasks are alive at once.
+	 * A cache only allocates when every record it owns is in use, records freed by other threads included, so it never owns more slabs than maxLiveTasks records fill,
+	 * plus one for a record on it's way back, for each slab size class.
+	 */
+	[[nodiscard]] static uint64 GetMaxTaskAllocations(const uint64 maxLiveTasks)
+	{
+		return (threadCount + 1ull) * ((maxLiveTasks + TASKS_PER_SLAB - 1) / TASKS_PER_SLAB + 1) * SLAB_TASK_SIZE_CLASSES;
 	}
 
 private:
 	inline const static uint8 threadCount{ static_cast<uint8>(GTSL::Thread::ThreadCount() - 1) };
-	GTSL::Atomic<uint32> index{ 0 };
 
-	static constexpr uint8 TUPLE_LAMBDA_DELEGATE_INDEX = 0;
-	static constexpr uint8 TUPLE_LAMBDA_TASK_INFO_INDEX = 1;
-	static constexpr uint8 TUPLE_SEMAPHORE_INDEX = 2;
-	
-	GTSL::Array<GTSL::BlockingQueue<Tasks>, 32> queues;
-	GTSL::Array<GTSL::Thread, 32> threads;
+	static constexpr uint8 MAX_THREADS = 32;
+	static constexpr uint8 NO_WORKER = 0xFF;
+	static constexpr uint32 DEQUE_CAPACITY = 1024;
+
+	/**
+	 * \brief Number of times a worker will try to find a task in all the deques before parking.
+	 */
+	static constexpr uint32 SPIN_COUNT = 64;
+
+	/**
+	 * \brief Index of the worker running on the current thread, NO_WORKER for threads not belonging to the pool.
+	 */
+	inline static thread_local uint8 currentWorker{ NO_WORKER };
+
+	/**
+	 * \brief Task records are carved from cache line aligned slabs in fixed size classes, the smallest class holds the delegate and arguments of
+	 * common tasks inline. Bigger tasks get a record from the next size class big enough.
+	 * Records bigger than the slab classes are allocated one at a time, but are recycled through the same per thread free lists as the rest,
+	 * so an oversized task only costs an allocation when the thread enqueuing it has none of it's size class left.
+	 */
+	static constexpr uint32 TASK_ALIGNMENT = 64;
+	static constexpr uint32 SLAB_TASK_SIZE_CLASSES = 4;
+	static constexpr uint32 MIN_TASK_SIZE = 128;
+	/**
+	 * \brief Enough size classes for any task record up to 2GB.
+	 */
+	static constexpr uint32 TASK_SIZE_CLASSES = 25;
+	static constexpr uint32 TASKS_PER_SLAB = 32;
+
+	static constexpr uint8 getTaskSizeClass(const uint64 size)
+	{
+		uint8 sizeClass = 0; while ((MIN_TASK_SIZE << sizeClass) < size) { ++sizeClass; } return sizeClass;
+	}
+
+	struct TaskCache;
+
+	struct TaskHeader
+	{
+		TaskDelegate Work;
+		Latch* DoneLatch{ nullptr };
+		TaskCache* Owner{ nullptr };
+		uint8 SizeClass{ 0 };
+	};
+
+	struct FreeTask
+	{
+		FreeTask* Next{ nullptr };
+	};
+
+	struct Slab
+	{
+		Slab* Next{ nullptr };
+		void* Allocation{ nullptr };
+		uint64 AllocationSize{ 0 };
+	};
+
+	/**
+	 * \brief Per thread free lists of task records. Only the owning thread takes records from FreeTasks,
+	 * records freed by other threads are pushed to ReturnedTasks and reclaimed by the owner in one go when it runs out.
+	 */
+	struct TaskCache
+	{
+		FreeTask* FreeTasks[TASK_SIZE_CLASSES]{};
+		Slab* Slabs{ nullptr };
+		alignas(64) std::atomic<FreeTask*> ReturnedTasks[TASK_SIZE_CLASSES]{};
+	};
+
+	/**
+	 * \brief One cache per worker plus the one used by threads not belonging to the pool, protected by the injection mutex.
+	 */
+	TaskCache caches[MAX_THREADS + 1];
+	std::atomic<uint64> allocationCount{ 0 };
 
 	template<typename T, typename... ARGS>
-	struct TaskInfo
+	T* allocateTask(TaskCache* cache, ARGS&&... args)
+	{
+		static_assert(alignof(T) <= TASK_ALIGNMENT, "Task alignment is bigger than supported.");
+		constexpr uint8 sizeClass = getTaskSizeClass(sizeof(T));
+
+		if (!cache->FreeTasks[sizeClass]) { cache->FreeTasks[sizeClass] = cache->ReturnedTasks[sizeClass].exchange(nullptr, std::memory_order_acquire); }
+		if (!cache->FreeTasks[sizeClass]) { allocateSlab(cache, sizeClass); }
+
+		FreeTask* freeTask = cache->FreeTasks[sizeClass];
+		cache->FreeTasks[sizeClass] = freeTask->Next;
+
+		T* task = ::new(static_cast<void*>(freeTask)) T(GTSL::ForwardRef<ARGS>(args)...);
+		task->Owner = cache; task->SizeClass = sizeClass;
+		return task;
+	}
+
+	void freeTask(void* task, TaskCache* owner, const uint8 sizeClass)
+	{
+		auto* freeTask = static_cast<FreeTask*>(task);
+
+		if (currentWorker != NO_WORKER && owner == &caches[currentWorker])
+		{
+			freeTask->Next = owner->FreeTasks[sizeClass];
+			owner->FreeTasks[sizeClass] = freeTask;
+			return;
+		}
+
+		auto* head = owner->ReturnedTasks[sizeClass].load(std::memory_order_relaxed);
+		do { freeTask->Next = head; } while (!owner->ReturnedTasks[sizeClass].compare_exchange_weak(head, freeTask, std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	void allocateSlab(TaskCache* cache, const uint8 sizeClass)
+	{
+		const uint64 taskSize = MIN_TASK_SIZE << sizeClass;
+		const uint32 tasksPerSlab = sizeClass < SLAB_TASK_SIZE_CLASSES ? TASKS_PER_SLAB : 1; //oversized records get a slab of their own
+		const uint64 allocationSize = TASK_ALIGNMENT + TASK_ALIGNMENT + taskSize * tasksPerSlab; //alignment slack + slab header
+
+		void* allocation{ nullptr }; uint64 allocatedSize{ 0 };
+		GetPersistentAllocator().Allocate(allocationSize, alignof(uint64), &allocation, &allocatedSize);
+		allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+		byte* start = GTSL::AlignPointer(TASK_ALIGNMENT, static_cast<byte*>(allocation));
+
+		auto* slab = ::new(start) Slab();
+		slab->Allocation = allocation; slab->AllocationSize = allocationSize;
+		slab->Next = cache->Slabs; cache->Slabs = slab;
+
+		byte* tasks = start + TASK_ALIGNMENT;
+
+		for (uint32 i = 0; i < tasksPerSlab; ++i)
+		{
+			auto* freeTask = ::new(tasks + taskSize * i) FreeTask();
+			freeTask->Next = cache->FreeTasks[sizeClass];
+			cache->FreeTasks[sizeClass] = freeTask;
+		}
+	}
+
+	/**
+	 * \brief Per priority, one deque per worker plus the injection deque(last one) for tasks enqueued from outside the pool.
+	 */
+	WorkStealingDeque<TaskHeader*, BE::PersistentAllocatorReference> deques[TASK_PRIORITY_COUNT][MAX_THREADS + 1];
+	GTSL::Array<GTSL::Thread, MAX_THREADS> threads;
+	GTSL::Mutex injectionMutex;
+
+	alignas(64) std::atomic<uint32> wakeEpoch{ 0 };
+	alignas(64) std::atomic<uint32> sleepingWorkers{ 0 };
+	std::atomic<bool> done{ false };
+
+	template<typename T, typename... ARGS>
+	struct TaskInfo : TaskHeader
 	{
 		TaskInfo(const GTSL::Delegate<T>& delegate, GTSL::Tuple<ARGS...>&& args) : Delegate(delegate), Arguments(GTSL::MoveRef(args))
 		{
@@ -104,12 +344,40 @@ private:
 		TaskInfo(const GTSL::Delegate<T>& delegate, ARGS&&... args) : Delegate(delegate), Arguments(GTSL::ForwardRef<ARGS>(args)...)
 		{
 		}
-		
+
 		GTSL::Delegate<T> Delegate;
 		GTSL::Tuple<ARGS...> Arguments;
 	};
+
 	/**
-	 * \brief Number of times to loop around the queues to find one that is free.
+	 * \brief Pops from the worker's own deque and if empty tries stealing from every other deque, injection deque included.
+	 * Done for every priority, from highest to lowest.
 	 */
-	inline static constexpr uint8 K{ 2 };
-};
\ No newline at end of file
+	bool tryGetTask(const uint8 worker, TaskHeader*& task)
+	{
+		for (auto& priorityDeques : deques)
+		{
+			if (priorityDeques[worker].Pop(task)) { return true; }
+
+			for (uint8 n = 1; n < threadCount + 1; ++n)
+			{
+				if (priorityDeques[(worker + n) % (threadCount + 1)].Steal(task)) { return true; }
+			}
+		}
+
+		task = nullptr;
+		return false;
+	}
+
+	void wakeWorker()
+	{
+		//order push before reading the sleepers count, pairs with the increment of sleepingWorkers before re-checking the deques
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (sleepingWorkers.load(std::memory_order_seq_cst) != 0)
+		{
+			wakeEpoch.fetch_add(1, std::memory_order_seq_cst);
+			wakeEpoch.notify_one();
+		}
+	}
+};
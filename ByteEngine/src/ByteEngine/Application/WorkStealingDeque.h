@@ -0,0 +1,143 @@
+#pragma once
+
+#include "ByteEngine/Core.h"
+#include "ByteEngine/Debug/Assert.h"
+
+#include <atomic>
+#include <new>
+
+/**
+ * \brief Chase-Lev work stealing deque.
+ * Only the owning thread may call Push and Pop, which operate on the bottom end(LIFO) of the deque.
+ * Any thread may call Steal, which takes elements from the top end(FIFO) of the deque.
+ * Based on "Correct and Efficient Work-Stealing for Weak Memory Models" (Le, Pop, Cohen, Zappa Nardelli).
+ * \tparam T Type of the elements. Must be trivially copyable since a thief may read a slot which is being concurrently overwritten, usually a pointer.
+ * \tparam ALLOCATOR Allocator used to get memory for the ring buffers, only called when the deque has to grow.
+ */
+template<typename T, class ALLOCATOR>
+class WorkStealingDeque
+{
+public:
+	WorkStealingDeque() = default;
+
+	/**
+	 * \param capacity Initial number of slots, must be a power of two.
+	 */
+	WorkStealingDeque(const uint32 capacity, const ALLOCATOR& allocatorReference) : allocator(allocatorReference)
+	{
+		buffer.store(allocateBuffer(capacity, nullptr), std::memory_order_relaxed);
+	}
+
+	~WorkStealingDeque()
+	{
+		auto* ringBuffer = buffer.load(std::memory_order_relaxed);
+
+		while (ringBuffer)
+		{
+			auto* previous = ringBuffer->Previous;
+			deallocateBuffer(ringBuffer);
+			ringBuffer = previous;
+		}
+	}
+
+	void Push(const T& element)
+	{
+		const int64 b = bottom.load(std::memory_order_relaxed);
+		const int64 t = top.load(std::memory_order_acquire);
+		auto* ringBuffer = buffer.load(std::memory_order_relaxed);
+
+		if (b - t > ringBuffer->Mask) { ringBuffer = grow(ringBuffer, b, t); }
+
+		ringBuffer->Store(b, element);
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom.store(b + 1, std::memory_order_relaxed);
+	}
+
+	bool Pop(T& element)
+	{
+		const int64 b = bottom.load(std::memory_order_relaxed) - 1;
+		auto* ringBuffer = buffer.load(std::memory_order_relaxed);
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64 t = top.load(std::memory_order_relaxed);
+
+		if (t > b) //empty
+		{
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return false;
+		}
+
+		element = ringBuffer->Load(b);
+
+		if (t != b) { return true; }
+
+		//last element, race against thieves for it
+		const bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return won;
+	}
+
+	bool Steal(T& element)
+	{
+		int64 t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const int64 b = bottom.load(std::memory_order_acquire);
+
+		if (t >= b) { return false; }
+
+		auto* ringBuffer = buffer.load(std::memory_order_acquire);
+		element = ringBuffer->Load(t);
+		return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+	}
+
+	[[nodiscard]] bool IsEmpty() const { return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed); }
+
+private:
+	struct RingBuffer
+	{
+		RingBuffer(const int64 capacity, RingBuffer* previous) : Mask(capacity - 1), Previous(previous) {}
+
+		const int64 Mask{ 0 };
+		/**
+		 * \brief Buffer this one replaced when growing. Retired buffers are kept alive until destruction as thieves might still be reading from them.
+		 */
+		RingBuffer* Previous{ nullptr };
+
+		std::atomic<T>* Slots() { return reinterpret_cast<std::atomic<T>*>(this + 1); }
+
+		[[nodiscard]] T Load(const int64 i) { return Slots()[i & Mask].load(std::memory_order_relaxed); }
+		void Store(const int64 i, const T& element) { Slots()[i & Mask].store(element, std::memory_order_relaxed); }
+	};
+
+	alignas(64) std::atomic<int64> top{ 0 };
+	alignas(64) std::atomic<int64> bottom{ 0 };
+	alignas(64) std::atomic<RingBuffer*> buffer{ nullptr };
+	ALLOCATOR allocator;
+
+	static uint64 bufferAllocationSize(const int64 capacity) { return sizeof(RingBuffer) + sizeof(std::atomic<T>) * capacity; }
+
+	RingBuffer* allocateBuffer(const int64 capacity, RingBuffer* previous)
+	{
+		BE_ASSERT((capacity & (capacity - 1)) == 0, "Capacity is not power of two!")
+
+		void* memory{ nullptr }; uint64 allocatedSize{ 0 };
+		allocator.Allocate(bufferAllocationSize(capacity), alignof(RingBuffer), &memory, &allocatedSize);
+
+		auto* ringBuffer = ::new(memory) RingBuffer(capacity, previous);
+		for (int64 i = 0; i < capacity; ++i) { ::new(ringBuffer->Slots() + i) std::atomic<T>(); }
+		return ringBuffer;
+	}
+
+	void deallocateBuffer(RingBuffer* ringBuffer)
+	{
+		allocator.Deallocate(bufferAllocationSize(ringBuffer->Mask + 1), alignof(RingBuffer), ringBuffer);
+	}
+
+	RingBuffer* grow(RingBuffer* ringBuffer, const int64 b, const int64 t)
+	{
+		auto* newBuffer = allocateBuffer((ringBuffer->Mask + 1) * 2, ringBuffer);
+		for (int64 i = t; i < b; ++i) { newBuffer->Store(i, ringBuffer->Load(i)); }
+		buffer.store(newBuffer, std::memory_order_release);
+		return newBuffer;
+	}
+};
@@ -17,8 +17,37 @@ using UTF8 = char;
 using float32 = float;
 using float64 = double;
 
+//project files only define the platform for Windows builds, other platforms are detected from the compiler so their code paths aren't silently left out
+#if defined(_WIN32) && !defined(BE_PLATFORM_WIN)
+#define BE_PLATFORM_WIN
+#elif defined(__linux__) && !defined(BE_PLATFORM_LINUX)
+#define BE_PLATFORM_LINUX
+#endif
+
 #ifdef BE_DEBUG
 #define BE_DEBUG_ONLY(...) __VA_ARGS__;
 #else
 #define BE_DEBUG_ONLY(...)
-#endif
\ No newline at end of file
+#endif
+
+//allocation tracking(leak reports) is always done by debug builds, release builds can define BE_ALLOCATION_TRACKING to find slow leaks
+#if defined(BE_DEBUG) && !defined(BE_ALLOCATION_TRACKING)
+#define BE_ALLOCATION_TRACKING
+#endif
+
+#ifdef BE_ALLOCATION_TRACKING
+#define BE_TRACKING_ONLY(...) __VA_ARGS__;
+#else
+#define BE_TRACKING_ONLY(...)
+#endif
+
+//allocation statistics are always collected by debug builds, release builds can define BE_ALLOCATION_STATISTICS to profile with them, tracking needs them
+#if (defined(BE_DEBUG) || defined(BE_ALLOCATION_TRACKING)) && !defined(BE_ALLOCATION_STATISTICS)
+#define BE_ALLOCATION_STATISTICS
+#endif
+
+#ifdef BE_ALLOCATION_STATISTICS
+#define BE_STATISTICS_ONLY(...) __VA_ARGS__;
+#else
+#define BE_STATISTICS_ONLY(...)
+#endif
@@ -0,0 +1,122 @@
+#include "TaskProfiler.h"
+
+#ifdef BE_DEBUG
+
+#include <chrono>
+#include <cstdio>
+#include <new>
+
+#include <GTSL/File.h>
+#include <GTSL/Memory.h>
+
+#include "ByteEngine/Debug/Assert.h"
+
+uint64 TaskProfiler::Now()
+{
+	return static_cast<uint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void TaskProfiler::Record(const Event& event)
+{
+	if (!threadBuffer) { threadBuffer = createThreadBuffer(); if (!threadBuffer) { return; } }
+
+	const auto head = threadBuffer->Head.load(std::memory_order_relaxed);
+	auto& slot = threadBuffer->Events[head % EVENTS_PER_THREAD];
+	slot = event; slot.Worker = currentWorker;
+	threadBuffer->Head.store(head + 1, std::memory_order_release);
+}
+
+TaskProfiler::ThreadBuffer* TaskProfiler::createThreadBuffer()
+{
+	const auto index = threadBufferCount.fetch_add(1, std::memory_order_relaxed);
+	BE_ASSERT(index < MAX_THREADS, "Too many threads for the task profiler!")
+	if (index >= MAX_THREADS) { return nullptr; }
+
+	//straight from the OS and kept alive until the process exits so the trace can be written at any point, through an engine allocator it would be reported as leaked
+	void* memory{ nullptr };
+	GTSL::Allocate(sizeof(ThreadBuffer), &memory);
+
+	auto* buffer = ::new(memory) ThreadBuffer();
+	buffer->ThreadIndex = index;
+	threadBuffers[index].store(buffer, std::memory_order_release);
+	return buffer;
+}
+
+/**
+ * \brief Copies string to escaped as the contents of a JSON string, truncated to fit size bytes including the terminator.
+ */
+static void escapeJSON(const char* string, char* escaped, const uint32 size)
+{
+	uint32 length = 0;
+
+	for (; string && *string; ++string)
+	{
+		const unsigned char c = static_cast<unsigned char>(*string);
+
+		if (c == '"' || c == '\\')
+		{
+			if (length + 2 >= size) { break; }
+			escaped[length++] = '\\'; escaped[length++] = static_cast<char>(c);
+		}
+		else if (c < 0x20) //control characters can't appear unescaped
+		{
+			if (length + 6 >= size) { break; }
+			length += snprintf(escaped + length, size - length, "\\u%04x", c);
+		}
+		else
+		{
+			if (length + 1 >= size) { break; }
+			escaped[length++] = static_cast<char>(c);
+		}
+	}
+
+	escaped[length] = '\0';
+}
+
+void TaskProfiler::WriteChromeTrace(const GTSL::Ranger<const UTF8> path)
+{
+	GTSL::File file;
+	file.OpenFile(path, static_cast<uint8>(GTSL::File::AccessMode::WRITE), GTSL::File::OpenMode::CLEAR);
+
+	char text[512]; char name[256];
+
+	//snprintf returns the length it would have written, so a truncated line must only write what's in text
+	auto write = [&](const int32 length)
+	{
+		if (length > 0) { file.WriteToFile(GTSL::Ranger<const byte>(length < static_cast<int32>(sizeof(text)) ? static_cast<uint32>(length) : static_cast<uint32>(sizeof(text) - 1), reinterpret_cast<const byte*>(text))); }
+	};
+
+	write(snprintf(text, sizeof(text), "{\"traceEvents\":[\n"));
+
+	bool first = true;
+	const uint32 threadCount = threadBufferCount.load(std::memory_order_acquire);
+
+	for (uint32 t = 0; t < threadCount && t < MAX_THREADS; ++t)
+	{
+		const auto* buffer = threadBuffers[t].load(std::memory_order_acquire);
+		if (!buffer) { continue; }
+
+		const auto head = buffer->Head.load(std::memory_order_acquire);
+
+		for (uint64 e = head > EVENTS_PER_THREAD ? head - EVENTS_PER_THREAD : 0; e < head; ++e)
+		{
+			const auto& event = buffer->Events[e % EVENTS_PER_THREAD];
+
+			escapeJSON(event.Name.GetString(), name, sizeof(name));
+			const char* category = event.Type == EventType::TASK ? "task" : event.Type == EventType::PARKED ? "parked" : "wait";
+
+			//trace_event timestamps are in microseconds
+			write(snprintf(text, sizeof(text), "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%u,\"args\":{\"goal\":%d,\"worker\":%d,\"wait_us\":%.3f}}",
+				first ? "" : ",\n", name, category, static_cast<float64>(event.Begin) / 1000.0, static_cast<float64>(event.End - event.Begin) / 1000.0, buffer->ThreadIndex,
+				event.Goal == 0xFFFF ? -1 : static_cast<int32>(event.Goal), event.Worker == 0xFF ? -1 : static_cast<int32>(event.Worker), static_cast<float64>(event.WaitNanoseconds) / 1000.0));
+
+			first = false;
+		}
+	}
+
+	write(snprintf(text, sizeof(text), "\n]}\n"));
+
+	file.CloseFile();
+}
+
+#endif
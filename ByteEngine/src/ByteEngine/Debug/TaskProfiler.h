@@ -0,0 +1,127 @@
+#pragma once
+
+#include "ByteEngine/Core.h"
+
+#ifdef BE_DEBUG
+
+#include <atomic>
+
+#include <GTSL/Ranger.h>
+
+#include "ByteEngine/Id.h"
+
+/**
+ * \brief Records a timeline of the tasks run by every thread and writes it as a Chrome trace(chrome://tracing, https://ui.perfetto.dev).
+ * Every thread writes to it's own ring buffer so recording takes no locks, when a buffer is full the oldest events are overwritten.
+ * The trace is written next to the executable as TaskTrace.json when the application shuts down. BenchmarkApplication's ProfilerEvents measures what an event costs.
+ * Only compiled in debug builds, call sites wrap calls in BE_DEBUG_ONLY.
+ */
+class TaskProfiler
+{
+public:
+	enum class EventType : uint8
+	{
+		/**
+		 * \brief A task ran.
+		 */
+		TASK,
+		/**
+		 * \brief A worker had nothing to do and slept.
+		 */
+		PARKED,
+		/**
+		 * \brief A dynamic task couldn't be dispatched because the objects it accesses were in use, blocking the ones after it.
+		 */
+		WAIT
+	};
+
+	struct Event
+	{
+		Id Name;
+		uint64 Begin = 0, End = 0;
+		/**
+		 * \brief Time the task spent waiting for CanRunTask to let it run before starting.
+		 */
+		uint64 WaitNanoseconds = 0;
+		uint16 Goal = 0xFFFF;
+		uint8 Worker = 0xFF;
+		EventType Type = EventType::TASK;
+	};
+
+	/**
+	 * \brief Nanoseconds from a steady clock, cheap enough to be called at the start and end of every task.
+	 */
+	static uint64 Now();
+
+	static void Record(const Event& event);
+
+	/**
+	 * \brief Records an event which started at begin and ends now.
+	 */
+	static void Record(const Id name, const EventType type, const uint16 goal, const uint64 begin)
+	{
+		Event event;
+		event.Name = name; event.Type = type; event.Goal = goal; event.Begin = begin; event.End = Now();
+		Record(event);
+	}
+
+	/**
+	 * \brief Sets the ThreadPool worker index the calling thread's events are tagged with.
+	 */
+	static void SetCurrentWorker(const uint8 worker) { currentWorker = worker; }
+
+	/**
+	 * \brief Sets the time the next task started on this thread waited on CanRunTask, picked up by the next TaskScope created.
+	 */
+	static void SetNextTaskWait(const uint64 waitNanoseconds) { nextTaskWait = waitNanoseconds; }
+
+	/**
+	 * \brief Records a TASK event spanning it's lifetime.
+	 */
+	struct TaskScope
+	{
+		//the wait is taken when the task starts, tasks run inside this one(TryRunTask while waiting) would take it otherwise
+		TaskScope(const Id name, const uint32 goal) : begin(Now()), wait(nextTaskWait), name(name), goal(static_cast<uint16>(goal)) { nextTaskWait = 0; }
+
+		~TaskScope()
+		{
+			Event event;
+			event.Name = name; event.Begin = begin; event.End = Now(); event.WaitNanoseconds = wait; event.Goal = goal;
+			Record(event);
+		}
+
+	private:
+		uint64 begin, wait; Id name; uint16 goal;
+	};
+
+	/**
+	 * \brief Writes the events currently held by every thread's buffer as Chrome trace_event JSON.
+	 * Threads keep recording while writing, events overwritten during the write may show up with wrong data.
+	 */
+	static void WriteChromeTrace(GTSL::Ranger<const UTF8> path);
+
+private:
+	static constexpr uint32 EVENTS_PER_THREAD = 16384;
+	static constexpr uint32 MAX_THREADS = 64;
+
+	struct ThreadBuffer
+	{
+		/**
+		 * \brief Number of events ever recorded, only written by the owning thread.
+		 */
+		std::atomic<uint64> Head{ 0 };
+		uint32 ThreadIndex = 0;
+		Event Events[EVENTS_PER_THREAD];
+	};
+
+	inline static thread_local ThreadBuffer* threadBuffer{ nullptr };
+	inline static thread_local uint8 currentWorker{ 0xFF };
+	inline static thread_local uint64 nextTaskWait{ 0 };
+
+	inline static std::atomic<uint32> threadBufferCount{ 0 };
+	inline static std::atomic<ThreadBuffer*> threadBuffers[MAX_THREADS]{};
+
+	static ThreadBuffer* createThreadBuffer();
+};
+
+#endif
@@ -4,27 +4,36 @@
 #include <GTSL/Math/Math.hpp>
 #include <GTSL/Vector.hpp>
 
+#include "SlotMap.h"
+
 class CameraSystem : public System
 {
 public:
-	CameraSystem() : positionMatrices(4, GetPersistentAllocator()), rotationMatrices(4, GetPersistentAllocator()), fovs(4, GetPersistentAllocator())
-	{}
+	CameraSystem() : System("CameraSystem") {}
 
-	void Initialize(const InitializeInfo& initializeInfo) override {}
+	void Initialize(const InitializeInfo& initializeInfo) override
+	{
+		cameras.Initialize(initializeInfo.ScalingFactor, GetComponentAllocator());
+		positionMatrices.Initialize(initializeInfo.ScalingFactor, GetComponentAllocator());
+		rotationMatrices.Initialize(initializeInfo.ScalingFactor, GetComponentAllocator());
+		fovs.Initialize(initializeInfo.ScalingFactor, GetComponentAllocator());
+	}
 	void Shutdown(const ShutdownInfo& shutdownInfo) override {}
 	
-	void AddCamera()
+	ComponentHandle AddCamera()
 	{
 		positionMatrices.EmplaceBack(1);
 		rotationMatrices.EmplaceBack(1);
 		fovs.EmplaceBack(45.0f);
+		return cameras.Emplace();
 	}
 	
-	ComponentReference AddCamera(const GTSL::Vector3 pos)
+	ComponentHandle AddCamera(const GTSL::Vector3 pos)
 	{
+		positionMatrices.EmplaceBack(GTSL::Math::Translation(pos));
 		rotationMatrices.EmplaceBack(1);
 		fovs.EmplaceBack(45.0f);
-		return positionMatrices.EmplaceBack(GTSL::Math::Translation(pos));
+		return cameras.Emplace();
 	}
 	
 	//ComponentReference AddCamera(const GTSL::Matrix4& matrix)
@@ -32,45 +41,59 @@ public:
 	//	return viewMatrices.EmplaceBack(matrix);
 	//}
 
-	void RemoveCamera(const ComponentReference reference)
+	void RemoveCamera(const ComponentHandle reference)
 	{
-		positionMatrices.Pop(reference);
-		rotationMatrices.Pop(reference);
-		fovs.Pop(reference);
+		const auto index = cameras.Remove(reference);
+		SlotMap<BE::ComponentAllocatorReference>::SwapRemove(positionMatrices, index);
+		SlotMap<BE::ComponentAllocatorReference>::SwapRemove(rotationMatrices, index);
+		SlotMap<BE::ComponentAllocatorReference>::SwapRemove(fovs, index);
 	}
 
-	void SetCameraRotation(const ComponentReference reference, const GTSL::Matrix4 matrix4)
+	/**
+	 * \brief Bytes one camera takes across all arrays, for declaring the system's memory budget.
+	 */
+	static constexpr uint32 GetBytesPerComponent() { return sizeof(GTSL::Matrix4) * 2 + sizeof(float32) + SlotMap<BE::ComponentAllocatorReference>::BYTES_PER_HANDLE; }
+
+	[[nodiscard]] bool IsCameraValid(const ComponentHandle reference) const { return cameras.IsValid(reference); }
+
+	void SetCameraRotation(const ComponentHandle reference, const GTSL::Matrix4 matrix4)
 	{
-		rotationMatrices[reference] = matrix4;
+		rotationMatrices[cameras.GetIndex(reference)] = matrix4;
 	}
 	
-	void SetCameraPosition(const ComponentReference reference, const GTSL::Vector3 pos)
+	void SetCameraPosition(const ComponentHandle reference, const GTSL::Vector3 pos)
 	{
-		positionMatrices[reference] = GTSL::Math::Translation(pos);
+		positionMatrices[cameras.GetIndex(reference)] = GTSL::Math::Translation(pos);
 	}
 
-	void AddCameraPosition(const ComponentReference reference, GTSL::Vector3 pos)
+	void AddCameraPosition(const ComponentHandle reference, GTSL::Vector3 pos)
 	{
-		GTSL::Math::Translate(positionMatrices[reference], pos);
+		GTSL::Math::Translate(positionMatrices[cameras.GetIndex(reference)], pos);
 	}
 
-	void AddCameraRotation(const ComponentReference reference, const GTSL::Quaternion quaternion)
+	void AddCameraRotation(const ComponentHandle reference, const GTSL::Quaternion quaternion)
 	{
-		GTSL::Math::Rotate(rotationMatrices[reference], quaternion);
+		GTSL::Math::Rotate(rotationMatrices[cameras.GetIndex(reference)], quaternion);
 	}
 
-	void AddCameraRotation(const ComponentReference reference, const GTSL::Matrix4 matrix)
+	void AddCameraRotation(const ComponentHandle reference, const GTSL::Matrix4 matrix)
 	{
-		rotationMatrices[reference] = matrix * rotationMatrices[reference];
+		auto& rotation = rotationMatrices[cameras.GetIndex(reference)];
+		rotation = matrix * rotation;
 	}
 	
 	[[nodiscard]] GTSL::Ranger<const GTSL::Matrix4> GetPositionMatrices() const { return positionMatrices; }
 	[[nodiscard]] GTSL::Ranger<const GTSL::Matrix4> GetRotationMatrices() const { return rotationMatrices; }
 	[[nodiscard]] GTSL::Ranger<const float32> GetFieldOfViews() const { return fovs; }
-	void SetFieldOfView(const ComponentReference componentReference, const float32 fov) { fovs[componentReference] = fov; }
+	void SetFieldOfView(const ComponentHandle componentReference, const float32 fov) { fovs[cameras.GetIndex(componentReference)] = fov; }
 
 private:
-	GTSL::Vector<GTSL::Matrix4, BE::PersistentAllocatorReference> positionMatrices;
-	GTSL::Vector<GTSL::Matrix4, BE::PersistentAllocatorReference> rotationMatrices;
-	GTSL::Vector<float32, BE::PersistentAllocatorReference> fovs;
+	/**
+	 * \brief Maps camera handles to their index in the arrays below, which stay packed so they can be handed out as ranges.
+	 */
+	SlotMap<BE::ComponentAllocatorReference> cameras;
+
+	GTSL::Vector<GTSL::Matrix4, BE::ComponentAllocatorReference> positionMatrices;
+	GTSL::Vector<GTSL::Matrix4, BE::ComponentAllocatorReference> rotationMatrices;
+	GTSL::Vector<float32, BE::ComponentAllocatorReference> fovs;
 };
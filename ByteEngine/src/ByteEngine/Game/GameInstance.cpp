@@ -8,8 +8,10 @@
 
 #include "ByteEngine/Application/ThreadPool.h"
 #include "ByteEngine/Application/Application.h"
+#include "ByteEngine/Application/Clock.h"
 
-#include <GTSL/Semaphore.h>
+#include <atomic>
+#include <thread>
 
 const char* AccessTypeToString(const AccessType access)
 {
@@ -53,7 +55,11 @@ recurringGoals(16, GetPersistentAllocator()), goalNames(8, GetPersistentAllocato
 dynamicGoals(32, GetPersistentAllocator()),
 taskSorter(64, GetPersistentAllocator()),
 recurringTasksInfo(32, GetPersistentAllocator()),
-dynamicTasksInfo(32, GetPersistentAllocator())
+retiredTasksInfo(8, GetPersistentAllocator()),
+dynamicTasksInfo(32, GetPersistentAllocator()),
+taskGraphs{ { 64, GetPersistentAllocator() }, { 64, GetPersistentAllocator() } },
+frames{ FrameState(GetPersistentAllocator()), FrameState(GetPersistentAllocator()), FrameState(GetPersistentAllocator()) },
+parallelForTimes(16, GetPersistentAllocator())
 {
 }
 
@@ -76,24 +82,100 @@ GameInstance::~GameInstance()
 	World::DestroyInfo destroy_info;
 	destroy_info.GameInstance = this;
 	for (auto& world : worlds) { world->DestroyWorld(destroy_info); }
+
+	//tasks which ran already freed their info and were popped at the end of their frame, what's left was deferred or added after the last frame
+	for (auto& goalTasksInfo : dynamicTasksInfo)
+	{
+		for (auto& e : goalTasksInfo) { e.Delete(this, e.Info); }
+	}
+
+	if (steadyStateTaskAllocations)
+	{
+		BE_LOG_MESSAGE("Thread pool allocated ", steadyStateTaskAllocations, " task records in ", steadyStateAllocatingFrames, " frames after warming up")
+	}
 }
 
 void GameInstance::OnUpdate(BE::Application* application)
 {
 	PROFILE;
 
-	GTSL::Vector<Goal<FunctionType, BE::TAR>, BE::TAR> localRecurringGoals(64, GetTransientAllocator());
+	static_assert(StackAllocator::FRAME_COUNT >= MAX_FRAMES_IN_FLIGHT + 2, "Transient allocations could be reused while frames in flight still use them!");
+
+	frameStartTime = application->GetClock()->GetCurrentMicroseconds();
+
 	GTSL::Vector<Goal<FunctionType, BE::TAR>, BE::TAR> localDynamicGoals(64, GetTransientAllocator());
-	GTSL::Vector<GTSL::Vector<GTSL::Semaphore, BE::TAR>, BE::TAR> semaphores(64, GetTransientAllocator());
+
+	//goal and index of the LOW priority dynamic tasks deferred to the next frame
+	GTSL::Vector<GTSL::Pair<uint16, uint16>, BE::TAR> deferredDynamicTasks(16, GetTransientAllocator());
+
+	//frames which would be too far behind this one, and the frame that last used the slot this frame is going to use, have to be done
+	for (uint64 f = frameCount > MAX_FRAMES_IN_FLIGHT ? frameCount - MAX_FRAMES_IN_FLIGHT : 0; f + framesInFlight <= frameCount; ++f)
+	{
+		waitForFrame(frames[f % MAX_FRAMES_IN_FLIGHT], application);
+	}
+
+	bool swapTaskGraph;
+
+	{
+		GTSL::ReadLock lock(recurringGoalsMutex);
+		swapTaskGraph = taskGraphDirty;
+	}
+
+	if (swapTaskGraph) //nodes of frames in flight refer to the active graph and next frame's nodes would depend on them, let them all finish before swapping
+	{
+		for (uint64 f = frameCount > MAX_FRAMES_IN_FLIGHT ? frameCount - MAX_FRAMES_IN_FLIGHT : 0; f < frameCount; ++f) { waitForFrame(frames[f % MAX_FRAMES_IN_FLIGHT], application); }
+
+		GTSL::WriteLock lock(recurringTasksInfoMutex);
+		GTSL::WriteLock lock2(recurringGoalsMutex);
+		activeTaskGraph = !activeTaskGraph; taskGraphDirty = false;
+
+		//tasks removed up to now aren't in the new graph, and no frame runs the old one anymore
+		while (retiredTasksInfo.GetLength()) { retiredTasksInfo.Pop(retiredTasksInfo.GetLength() - 1); }
+	}
+
+	//only read from here on, recompilations go to the inactive graph
+	const auto& taskGraph = taskGraphs[activeTaskGraph];
+
+	const uint8 frameSlot = frameCount % MAX_FRAMES_IN_FLIGHT;
+	auto& frame = frames[frameSlot];
+	auto& previousFrame = frames[(frameCount + MAX_FRAMES_IN_FLIGHT - 1) % MAX_FRAMES_IN_FLIGHT];
+
+	//previous frame might still be running, it's nodes will have to release the conflicting nodes of this frame
+	const bool overlapsPreviousFrame = frameCount && previousFrame.TaskGraph == activeTaskGraph;
 
 	uint32 goalCount;
 	
 	{
 		GTSL::ReadLock lock(goalNamesMutex); //use goalNames vector to get length from since it has much less contention
 		goalCount = goalNames.GetLength();
-		for (uint32 i = 0; i < goalNames.GetLength(); ++i) //beware of semaphores vector resizing invalidating pointers!
+	}
+
+	frame.TaskGraph = activeTaskGraph; frame.Frame = frameCount; frame.GoalCount = static_cast<uint16>(goalCount);
+
+	frame.NodeDependencyCounters.ResizeDown(0); frame.NodeDependencyCounters.PushBack(taskGraph.GetDependencyCounts());
+	frame.NodeStates.ResizeDown(0); for (uint16 node = 0; node < taskGraph.GetNumberOfNodes(); ++node) { frame.NodeStates.EmplaceBack(0); }
+	frame.PendingNodes.store(taskGraph.GetNumberOfNodes(), std::memory_order_release);
+	frame.DynamicTasks.Reset(0);
+
+	if (overlapsPreviousFrame)
+	{
+		for (uint16 node = 0; node < taskGraph.GetNumberOfNodes(); ++node) { frame.NodeDependencyCounters[node] += taskGraph.GetFrameDependencyCounts()[node]; }
+	}
+
+	for (uint16 goal = 0; goal < goalCount; ++goal)
+	{
+		const bool isInGraph = goal < taskGraph.GetNumberOfGoals(); //goal might have been added after the graph was compiled
+		frame.GoalLatches[goal].Reset(isInGraph ? static_cast<uint32>(taskGraph.GetGoalWaitNodes(goal).ElementCount()) : 0);
+		frame.GoalPendingNodes[goal] = isInGraph ? static_cast<uint16>(taskGraph.GetGoalNodes(goal).Second - taskGraph.GetGoalNodes(goal).First) : 0;
+	}
+
+	++frameCount;
+
+	if (overlapsPreviousFrame) //whoever gets here last, this thread or the previous frame's node, releases the node's successors in this frame
+	{
+		for (uint16 node = 0; node < taskGraph.GetNumberOfNodes(); ++node)
 		{
-			semaphores.EmplaceBack(128, GetTransientAllocator());
+			if (std::atomic_ref<uint8>(previousFrame.NodeStates[node]).fetch_or(NEXT_FRAME_READY, std::memory_order_acq_rel) & NODE_DONE) { releaseNextFrameNodes(frameSlot, node); }
 		}
 	}
 	
@@ -103,100 +185,329 @@ void GameInstance::OnUpdate(BE::Application* application)
 	for(uint32 goal = 0; goal < goalCount; ++goal)
 	{
 		{
-			GTSL::ReadLock lock(recurringGoalsMutex);
-			localRecurringGoals.EmplaceBack(recurringGoals[goal], GetTransientAllocator());
+			GTSL::ReadLock lock(dynamicGoalsMutex);
+			localDynamicGoals.EmplaceBack(dynamicGoals[goal], GetTransientAllocator());
 		}
 		
-		uint16 recurringGoalNumberOfTasks = localRecurringGoals[goal].GetNumberOfTasks();
+		waitForGoal(frame, goal, application);
 
+		frame.GoalTimings[goal].Start = application->GetClock()->GetCurrentMicroseconds();
+		if (!frame.GoalPendingNodes[goal]) { frame.GoalTimings[goal].End = frame.GoalTimings[goal].Start; }
+
+		if (goal < taskGraph.GetNumberOfGoals()) //start goal, nodes which don't depend on other running nodes are dispatched right away
 		{
-			GTSL::ReadLock lock(dynamicGoalsMutex);
-			localDynamicGoals.EmplaceBack(dynamicGoals[goal], GetTransientAllocator());
+			const auto goalNodes = taskGraph.GetGoalNodes(goal);
+
+			for (uint16 node = goalNodes.First; node < goalNodes.Second; ++node)
+			{
+				if (std::atomic_ref<uint16>(frame.NodeDependencyCounters[node]).fetch_sub(1, std::memory_order_acq_rel) == 1) { dispatchRecurringNode(frameSlot, node); }
+			}
 		}
 		
-		uint16 dynamicGoalNumberOfTasks = localDynamicGoals[goal].GetNumberOfTasks();
+		//pending dynamic tasks, in dispatch order. Highest priority and earliest deadline first, else last added first
+		GTSL::Vector<uint16, BE::TAR> dynamicTaskOrder(32, GetTransientAllocator());
+		uint16 queuedDynamicTasks = 0;
+		BE_DEBUG_ONLY(uint64 blockedSince = 0)
 
-		uint16 recurringGoalTask = recurringGoalNumberOfTasks;
-		uint16 dynamicGoalTask = dynamicGoalNumberOfTasks;
-		
-		for (auto& semaphore : semaphores[goal]) { semaphore.Wait(); }
-		
-		while(recurringGoalNumberOfTasks + dynamicGoalNumberOfTasks > 0)
+		do
 		{
-			--recurringGoalTask;
-			
-			while (recurringGoalNumberOfTasks > 0) //try recurring goals
+			for (uint16 task = localDynamicGoals[goal].GetNumberOfTasks(); task-- > queuedDynamicTasks;) //queue tasks added since last time
 			{
-				if (auto res = taskSorter.CanRunTask(localRecurringGoals[goal].GetTaskAccessedObjects(recurringGoalTask), localRecurringGoals[goal].GetTaskAccessTypes(recurringGoalTask)))
-				{
-					const uint16 targetGoalIndex = localRecurringGoals[goal].GetTaskGoalIndex(recurringGoalTask);
-					const auto semaphoreIndex = semaphores[targetGoalIndex].EmplaceBack();
-					
-					application->GetThreadPool()->EnqueueTask(localRecurringGoals[goal].GetTask(recurringGoalTask), &semaphores[targetGoalIndex][semaphoreIndex], this, GTSL::MoveRef(goal), GTSL::MoveRef(recurringGoalTask), GTSL::MoveRef(res.Get()));
-
-					//BE_LOG_MESSAGE(localRecurringGoals[goal].GetTaskName(recurringGoalTask).GetString())
-					
-					//BE_LOG_WARNING(genTaskLog("Dispatched recurring task ", localRecurringGoals[goal].GetTaskName(recurringGoalTask), goalNames[goal], localRecurringGoals[goal].GetTaskAccessTypes(recurringGoalTask), localRecurringGoals[goal].GetTaskAccessedObjects(recurringGoalTask), objectNames));
-					
-					--recurringGoalNumberOfTasks;
-					--recurringGoalTask;
-				}
-				else
-				{
-					++recurringGoalTask;
-					break;
-				}
+				const auto schedule = localDynamicGoals[goal].GetTaskSchedule(task);
+				uint32 i = dynamicTaskOrder.GetLength(); dynamicTaskOrder.EmplaceBack(task);
+				for (; i > 0 && schedule.GoesBefore(localDynamicGoals[goal].GetTaskSchedule(dynamicTaskOrder[i - 1])); --i) { dynamicTaskOrder[i] = dynamicTaskOrder[i - 1]; }
+				dynamicTaskOrder[i] = task;
 			}
-			
-			--dynamicGoalTask;
-			
-			while (dynamicGoalNumberOfTasks > 0) //try dynamic goals
+
+			queuedDynamicTasks = localDynamicGoals[goal].GetNumberOfTasks();
+
+			while (dynamicTaskOrder.GetLength())
 			{
-				if (auto res = taskSorter.CanRunTask(localDynamicGoals[goal].GetTaskAccessedObjects(dynamicGoalTask), localDynamicGoals[goal].GetTaskAccessTypes(dynamicGoalTask)))
+				uint16 dynamicGoalTask = dynamicTaskOrder[0];
+				const auto schedule = localDynamicGoals[goal].GetTaskSchedule(dynamicGoalTask);
+
+				if (schedule.Priority == TaskPriority::LOW && schedule.DeferredFrames < MAX_DEFERRED_FRAMES && isOverBudget(application))
 				{
-					const uint16 targetGoalIndex = localDynamicGoals[goal].GetTaskGoalIndex(dynamicGoalTask);
-					const auto semaphoreIndex = semaphores[targetGoalIndex].EmplaceBack();
-					
-					application->GetThreadPool()->EnqueueTask(localDynamicGoals[goal].GetTask(dynamicGoalTask), &semaphores[targetGoalIndex][semaphoreIndex], this, GTSL::MoveRef(goal), GTSL::MoveRef(dynamicGoalTask), GTSL::MoveRef(res.Get()));
-
-					//BE_LOG_WARNING(genTaskLog("Dispatched dynamic task ", localDynamicGoals[goal].GetTaskName(dynamicGoalTask), goalNames[goal], localDynamicGoals[goal].GetTaskAccessTypes(dynamicGoalTask), localDynamicGoals[goal].GetTaskAccessedObjects(dynamicGoalTask), objectNames));
-					
-					--dynamicGoalNumberOfTasks;
-					--dynamicGoalTask;
+					deferredDynamicTasks.EmplaceBack(static_cast<uint16>(goal), dynamicGoalTask);
+					dynamicTaskOrder.Pop(0);
+					continue;
 				}
-				else
+
+				auto res = taskSorter.CanRunTask(localDynamicGoals[goal].GetTaskAccessedObjects(dynamicGoalTask), localDynamicGoals[goal].GetTaskAccessTypes(dynamicGoalTask));
+				if (!res) //keep dispatch order, wait for the accesses of the first task to be free
 				{
-					++dynamicGoalTask;
+					BE_DEBUG_ONLY(if (!blockedSince) { blockedSince = TaskProfiler::Now(); })
 					break;
 				}
-			}
 
-			{
-				GTSL::ReadLock lock(recurringGoalsMutex);
-				localRecurringGoals[goal].AddTask(recurringGoals[goal], localRecurringGoals[goal].GetNumberOfTasks(), recurringGoals[goal].GetNumberOfTasks(), GetTransientAllocator());
-				recurringGoalNumberOfTasks += localRecurringGoals[goal].GetNumberOfTasks() - recurringGoals[goal].GetNumberOfTasks();
+				BE_DEBUG_ONLY(if (blockedSince) { TaskProfiler::Record(localDynamicGoals[goal].GetTaskName(dynamicGoalTask), TaskProfiler::EventType::WAIT, static_cast<uint16>(goal), blockedSince); blockedSince = 0; })
+
+				const uint16 targetGoalIndex = localDynamicGoals[goal].GetTaskGoalIndex(dynamicGoalTask);
+
+				//only goals which haven't started yet wait for their tasks, the rest are waited for at the end of the frame
+				Latch* latch = targetGoalIndex > goal ? &frame.GoalLatches[targetGoalIndex] : &frame.DynamicTasks;
+				latch->Add();
+
+				application->GetThreadPool()->EnqueueTask(schedule.Priority, localDynamicGoals[goal].GetTask(dynamicGoalTask), latch, this, GTSL::MoveRef(goal), GTSL::MoveRef(dynamicGoalTask), GTSL::MoveRef(res.Get()));
+
+				//BE_LOG_WARNING(genTaskLog("Dispatched dynamic task ", localDynamicGoals[goal].GetTaskName(dynamicGoalTask), goalNames[goal], localDynamicGoals[goal].GetTaskAccessTypes(dynamicGoalTask), localDynamicGoals[goal].GetTaskAccessedObjects(dynamicGoalTask), objectNames));
+
+				dynamicTaskOrder.Pop(0);
 			}
+
+			if (dynamicTaskOrder.GetLength()) { if (!application->GetThreadPool()->TryRunTask()) { std::this_thread::yield(); } }
 			
 			{
 				GTSL::ReadLock lock(dynamicGoalsMutex);
 				localDynamicGoals[goal].AddTask(dynamicGoals[goal], localDynamicGoals[goal].GetNumberOfTasks(), dynamicGoals[goal].GetNumberOfTasks(), GetTransientAllocator());
-				dynamicGoalNumberOfTasks += localDynamicGoals[goal].GetNumberOfTasks() - dynamicGoals[goal].GetNumberOfTasks();
 			}
-		}
+		} while (dynamicTaskOrder.GetLength() || queuedDynamicTasks != localDynamicGoals[goal].GetNumberOfTasks());
 	} //goals
 
+	//dynamic tasks read their info from the dynamic goals which are cleared below, help run them instead of blocking
+	while (!frame.DynamicTasks.IsDone())
+	{
+		if (!application->GetThreadPool()->TryRunTask()) { frame.DynamicTasks.Wait(); }
+	}
+
+	{
+		//task records are recycled, once every thread has as many as the heaviest frame needs running a frame shouldn't allocate. Which thread enqueues or frees which record
+		//depends on scheduling though, so a thread can still run out now and then. Only counted, see GetSteadyStateTaskAllocations
+		uint32 frameDynamicTasks = 0;
+		for (uint16 goal = 0; goal < goalCount; ++goal) { frameDynamicTasks += localDynamicGoals[goal].GetNumberOfTasks(); }
+
+		const uint64 allocationCount = application->GetThreadPool()->GetAllocationCount();
+
+		if (swapTaskGraph || frameDynamicTasks > maxFrameDynamicTasks)
+		{
+			taskAllocationWarmUpFrames = TASK_ALLOCATION_WARM_UP_FRAMES;
+			if (frameDynamicTasks > maxFrameDynamicTasks) { maxFrameDynamicTasks = frameDynamicTasks; }
+		}
+		else if (taskAllocationWarmUpFrames)
+		{
+			--taskAllocationWarmUpFrames;
+		}
+		else if (allocationCount != taskAllocationCount)
+		{
+			steadyStateTaskAllocations += allocationCount - taskAllocationCount; ++steadyStateAllocatingFrames;
+		}
+
+		taskAllocationCount = allocationCount;
+	}
+
+	//when not pipelining the task graph's counters are reused next frame
+	if (framesInFlight == 1) { waitForFrame(frame, application); }
+
 	{
 		GTSL::WriteLock lock(dynamicGoalsMutex);
 		GTSL::WriteLock lock2(dynamicTasksInfoMutex);
 		
-		for (uint32 i = 0; i < goalCount; ++i)
+		for (uint16 i = 0; i < goalCount; ++i) //keep only deferred tasks, they are tried again next frame
+		{
+			//only tasks seen by the goal's dispatch loop were run or deferred, tasks added after it finished(like I/O completions) are left for the next frame
+			for (uint16 task = localDynamicGoals[i].GetNumberOfTasks(); task-- > 0;)
+			{
+				bool isDeferred = false;
+				for (const auto& e : deferredDynamicTasks) { if (e.First == i && e.Second == task) { isDeferred = true; break; } }
+
+				if (isDeferred)
+				{
+					auto schedule = dynamicGoals[i].GetTaskSchedule(task); ++schedule.DeferredFrames;
+					dynamicGoals[i].SetTaskSchedule(task, schedule);
+				}
+				else
+				{
+					dynamicGoals[i].PopTask(task);
+					dynamicTasksInfo[i].Pop(task);
+				}
+			}
+		}
+	}
+}
+
+void GameInstance::WaitForFrames(BE::Application* application)
+{
+	for (uint64 f = frameCount > MAX_FRAMES_IN_FLIGHT ? frameCount - MAX_FRAMES_IN_FLIGHT : 0; f < frameCount; ++f) { waitForFrame(frames[f % MAX_FRAMES_IN_FLIGHT], application); }
+}
+
+bool GameInstance::isOverBudget(BE::Application* application) const
+{
+	return frameBudget.GetCount() && frameBudget < application->GetClock()->GetCurrentMicroseconds() - frameStartTime;
+}
+
+void GameInstance::waitForGoal(FrameState& frame, const uint16 goal, BE::Application* application)
+{
+	while (!frame.GoalLatches[goal].IsDone())
+	{
+		if (!application->GetThreadPool()->TryRunTask()) { frame.GoalLatches[goal].Wait(); }
+	}
+}
+
+void GameInstance::waitForFrame(const FrameState& frame, BE::Application* application)
+{
+	while (frame.PendingNodes.load(std::memory_order_acquire) != 0)
+	{
+		if (!application->GetThreadPool()->TryRunTask()) { std::this_thread::yield(); }
+	}
+}
+
+void GameInstance::dispatchRecurringNode(const uint8 frame, const uint16 node)
+{
+	auto runNode = [](GameInstance* gameInstance, const uint8 frameSlot, const uint16 graphNode) -> void { gameInstance->runRecurringNode(frameSlot, graphNode); };
+
+	uint8 frameSlot = frame; uint16 graphNode = node;
+	BE::Application::Get()->GetThreadPool()->EnqueueTask(taskGraphs[frames[frame].TaskGraph].GetNodePriority(node), GTSL::Delegate<void(GameInstance*, uint8, uint16)>::Create(runNode), nullptr, this, GTSL::MoveRef(frameSlot), GTSL::MoveRef(graphNode));
+}
+
+void GameInstance::runRecurringNode(const uint8 frameSlot, const uint16 node)
+{
+	auto& frame = frames[frameSlot];
+	const auto& taskGraph = taskGraphs[frame.TaskGraph];
+
+	uint32 taskIndex;
+	BE_DEBUG_ONLY(const uint64 waitStart = TaskProfiler::Now())
+
+	//recurring tasks never conflict with each other when following the graph, but might with dynamic tasks holding the same objects
+	while (true)
+	{
+		if (auto res = taskSorter.CanRunTask(taskGraph.GetNodeAccessedObjects(node), taskGraph.GetNodeAccessTypes(node))) { taskIndex = res.Get(); break; }
+		if (!BE::Application::Get()->GetThreadPool()->TryRunTask()) { std::this_thread::yield(); }
+	}
+
+	BE_DEBUG_ONLY(TaskProfiler::SetNextTaskWait(TaskProfiler::Now() - waitStart))
+
+	taskGraph.GetNodeTask(node)(this, taskGraph.GetNodeGoal(node), taskGraph.GetNodeGoalTask(node), taskIndex); //releases resources when done
+
+	for (const auto successor : taskGraph.GetNodeSuccessors(node))
+	{
+		if (std::atomic_ref<uint16>(frame.NodeDependencyCounters[successor]).fetch_sub(1, std::memory_order_acq_rel) == 1) { dispatchRecurringNode(frameSlot, successor); }
+	}
+
+	//if the next frame has already been set up release this node's successors in it, else it will do so when it is
+	if (std::atomic_ref<uint8>(frame.NodeStates[node]).fetch_or(NODE_DONE, std::memory_order_acq_rel) & NEXT_FRAME_READY)
+	{
+		releaseNextFrameNodes((frameSlot + 1) % MAX_FRAMES_IN_FLIGHT, node);
+	}
+
+	const uint16 goal = taskGraph.GetNodeGoal(node);
+
+	if (goal < taskGraph.GetNodeTargetGoal(node)) { frame.GoalLatches[taskGraph.GetNodeTargetGoal(node)].CountDown(); }
+
+	if (std::atomic_ref<uint16>(frame.GoalPendingNodes[goal]).fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		frame.GoalTimings[goal].End = BE::Application::Get()->GetClock()->GetCurrentMicroseconds();
+	}
+
+	frame.PendingNodes.fetch_sub(1, std::memory_order_release);
+}
+
+void GameInstance::releaseNextFrameNodes(const uint8 frameSlot, const uint16 node)
+{
+	auto& frame = frames[frameSlot];
+
+	for (const auto successor : taskGraphs[frame.TaskGraph].GetNodeFrameSuccessors(node))
+	{
+		if (std::atomic_ref<uint16>(frame.NodeDependencyCounters[successor]).fetch_sub(1, std::memory_order_acq_rel) == 1) { dispatchRecurringNode(frameSlot, successor); }
+	}
+}
+
+void GameInstance::runParallelFor(ParallelForInfo* info)
+{
+	auto* threadPool = BE::Application::Get()->GetThreadPool();
+	const uint32 threads = threadPool->GetNumberOfThreads() + 1; //this thread runs chunks too
+
+	uint32 chunkSize = info->GrainSize;
+
+	{
+		GTSL::Lock lock(parallelForTimesMutex);
+
+		if (parallelForTimes.Find(info->Name) && parallelForTimes.At(info->Name) > 0.0f)
+		{
+			const auto measuredChunkSize = static_cast<uint32>(static_cast<float32>(PARALLEL_FOR_CHUNK_MICROSECONDS) / parallelForTimes.At(info->Name));
+			const uint32 evenChunkSize = (info->RangeSize + threads - 1) / threads; //never make less chunks than there are threads to run them
+			chunkSize = measuredChunkSize < evenChunkSize ? measuredChunkSize : evenChunkSize;
+			if (chunkSize < info->GrainSize) { chunkSize = info->GrainSize; }
+		}
+	}
+
+	auto* run = GTSL::New<ParallelForRun>(GetPersistentAllocator());
+	run->Info = info; run->RangeSize = info->RangeSize; run->ChunkSize = chunkSize;
+
+	const uint32 chunks = (info->RangeSize + chunkSize - 1) / chunkSize;
+	const uint32 helpers = chunks ? (chunks < threads ? chunks : threads) - 1 : 0;
+
+	run->References.store(helpers + 1, std::memory_order_relaxed);
+
+	auto runChunks = [](GameInstance* gameInstance, ParallelForRun* parallelForRun) -> void
+	{
+		gameInstance->runParallelForChunks(parallelForRun);
+		gameInstance->releaseParallelForRun(parallelForRun);
+	};
+
+	for (uint32 i = 0; i < helpers; ++i)
+	{
+		threadPool->EnqueueTask(GTSL::Delegate<void(GameInstance*, ParallelForRun*)>::Create(runChunks), nullptr, this, GTSL::MoveRef(run));
+	}
+
+	runParallelForChunks(run);
+
+	//this thread holds the task's accesses, so it must not pick up unrelated tasks which could be waiting on them. Only wait for chunks other threads already claimed,
+	//helpers which haven't started yet will find no chunks left
+	for (auto doneElements = run->DoneElements.load(std::memory_order_acquire); doneElements != run->RangeSize; doneElements = run->DoneElements.load(std::memory_order_acquire))
+	{
+		run->DoneElements.wait(doneElements, std::memory_order_acquire);
+	}
+
+	const uint64 workMicroseconds = run->WorkMicroseconds.load(std::memory_order_relaxed);
+
+	releaseParallelForRun(run);
+
+	if (!info->RangeSize) { return; }
+
+	const float32 microsecondsPerElement = static_cast<float32>(workMicroseconds) / static_cast<float32>(info->RangeSize);
+
+	{
+		GTSL::Lock lock(parallelForTimesMutex);
+
+		if (parallelForTimes.Find(info->Name))
+		{
+			auto& average = parallelForTimes.At(info->Name);
+			average = average * 0.75f + microsecondsPerElement * 0.25f;
+		}
+		else
 		{
-			dynamicGoals[i].Clear();
-			dynamicTasksInfo[i].ResizeDown(0);
+			parallelForTimes.Emplace(info->Name, microsecondsPerElement);
 		}
 	}
 }
 
+void GameInstance::runParallelForChunks(ParallelForRun* run)
+{
+	const auto* clock = BE::Application::Get()->GetClock();
+
+	TaskInfo taskInfo;
+	taskInfo.GameInstance = this;
+
+	const uint32 rangeSize = run->RangeSize;
+
+	//Info is only valid while there are chunks left, the parallel for can be over by the time a helper starts
+	for (uint32 begin = run->NextElement.fetch_add(run->ChunkSize, std::memory_order_relaxed); begin < rangeSize; begin = run->NextElement.fetch_add(run->ChunkSize, std::memory_order_relaxed))
+	{
+		const uint32 end = rangeSize - begin < run->ChunkSize ? rangeSize : begin + run->ChunkSize;
+
+		const auto start = clock->GetCurrentMicroseconds();
+		run->Info->Delegate(taskInfo, begin, end);
+		run->WorkMicroseconds.fetch_add((clock->GetCurrentMicroseconds() - start).GetCount(), std::memory_order_relaxed);
+
+		if (run->DoneElements.fetch_add(end - begin, std::memory_order_acq_rel) + (end - begin) == rangeSize) { run->DoneElements.notify_all(); }
+	}
+}
+
+void GameInstance::releaseParallelForRun(ParallelForRun* run)
+{
+	if (run->References.fetch_sub(1, std::memory_order_acq_rel) == 1) { GTSL::Delete<ParallelForRun>(run, GetPersistentAllocator()); }
+}
+
 void GameInstance::UnloadWorld(const WorldReference worldId)
 {
 	World::DestroyInfo destroy_info;
@@ -232,8 +543,13 @@ void GameInstance::RemoveTask(const Id name, const Id startOn)
 	}
 
 	{
-		GTSL::WriteLock lock(recurringGoalsMutex);
+		GTSL::WriteLock lock(recurringTasksInfoMutex);
+		GTSL::WriteLock lock2(recurringGoalsMutex);
+		const uint16 task = recurringGoals[i].GetTaskIndex(name);
+		retiredTasksInfo.EmplaceBack(GTSL::MoveRef(recurringTasksInfo[i][task])); //frames in flight might still run it
+		recurringTasksInfo[i].Pop(task);
 		recurringGoals[i].RemoveTask(name);
+		compileTaskGraph();
 	}
 
 	BE_LOG_MESSAGE("Removed recurring task ", name.GetString(), " from goal ", startOn.GetString())
@@ -241,6 +557,9 @@ void GameInstance::RemoveTask(const Id name, const Id startOn)
 
 void GameInstance::AddGoal(Id name)
 {
+	BE_ASSERT(goalNames.GetLength() < MAX_GOALS, "Too many goals!")
+
+
 	if constexpr (_DEBUG) {
 		GTSL::WriteLock lock(goalNamesMutex);
 		if (goalNames.Find(name) != goalNames.end()) {
@@ -257,6 +576,7 @@ void GameInstance::AddGoal(Id name)
 	{
 		GTSL::WriteLock lock(recurringGoalsMutex);
 		recurringGoals.EmplaceBack(16, GetPersistentAllocator());
+		compileTaskGraph();
 	}
 
 	{
@@ -288,6 +608,9 @@ void GameInstance::initSystem(System* system, const GTSL::Id64 name)
 {
 	System::InitializeInfo initializeInfo;
 	initializeInfo.GameInstance = this;
-	initializeInfo.ScalingFactor = scalingFactor;
+	//component storage of every system is reserved at once, when the first one is added
+	auto* memoryBudget = BE::Application::Get()->GetMemoryBudget();
+	memoryBudget->Reserve();
+	initializeInfo.ScalingFactor = memoryBudget->GetComponentCount(name);
 	system->Initialize(initializeInfo);
 }
\ No newline at end of file
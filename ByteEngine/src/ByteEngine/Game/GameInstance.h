@@ -8,11 +8,16 @@
 #include <GTSL/Algorithm.h>
 #include <GTSL/Allocator.h>
 #include <GTSL/Array.hpp>
+#include <GTSL/Time.h>
+
+#include <atomic>
 
 #include "Tasks.h"
 #include "ByteEngine/Id.h"
+#include "ByteEngine/Application/Latch.h"
 
 #include "ByteEngine/Debug/Assert.h"
+#include "ByteEngine/Debug/TaskProfiler.h"
 
 class World;
 class ComponentCollection;
@@ -50,22 +55,25 @@ public:
 
 	template<typename... ARGS>
 	void AddTask(const Id name, const GTSL::Delegate<void(TaskInfo, ARGS...)>& function, const GTSL::Ranger<const TaskDependency> dependencies, const Id startOn, const Id doneFor, ARGS&&... args)
+	{
+		AddTask(name, TaskSchedule(), function, dependencies, startOn, doneFor, GTSL::ForwardRef<ARGS>(args)...);
+	}
+
+	/**
+	 * \brief Adds a task which runs every frame.
+	 * \param schedule Priority and deadline of the task. Decides which task runs first when two conflicting tasks start on the same goal, and which workers pick it up first.
+	 */
+	template<typename... ARGS>
+	void AddTask(const Id name, const TaskSchedule schedule, const GTSL::Delegate<void(TaskInfo, ARGS...)>& function, const GTSL::Ranger<const TaskDependency> dependencies, const Id startOn, const Id doneFor, ARGS&&... args)
 	{
 		if constexpr (_DEBUG) { if (assertTask(name, startOn, doneFor, dependencies)) { return; } }
 		
 		auto taskInfo = GTSL::SmartPointer<void*, BE::PersistentAllocatorReference>::Create<DispatchTaskInfo<TaskInfo, ARGS...>>(GetPersistentAllocator(), function, TaskInfo(), GTSL::ForwardRef<ARGS>(args)...);
+		auto* info = reinterpret_cast<DispatchTaskInfo<TaskInfo, ARGS...>*>(taskInfo.GetData());
+		BE_DEBUG_ONLY(info->Name = name)
 
-		auto task = [](GameInstance* gameInstance, const uint32 goal, const uint32 goalTaskIndex, const uint32 dynamicTaskIndex) -> void
-		{			
-			{
-				GTSL::ReadLock lock(gameInstance->recurringTasksInfoMutex);
-				DispatchTaskInfo<TaskInfo, ARGS...>* info = reinterpret_cast<DispatchTaskInfo<TaskInfo, ARGS...>*>(gameInstance->recurringTasksInfo[goal][goalTaskIndex].GetData());
-				GTSL::Get<0>(info->Arguments).GameInstance = gameInstance;
-				GTSL::Call(info->Delegate, info->Arguments);
-			}
-
-			gameInstance->taskSorter.ReleaseResources(dynamicTaskIndex);
-		};
+		//the task is bound to it's info, so nodes of graphs compiled before the task was removed, or before other tasks of the goal were, still find it
+		const auto task = FunctionType::Create<DispatchTaskInfo<TaskInfo, ARGS...>, &DispatchTaskInfo<TaskInfo, ARGS...>::RunRecurring>(info);
 
 		GTSL::Array<uint16, 32> objects; GTSL::Array<AccessType, 32> accesses;
 
@@ -81,8 +89,9 @@ public:
 		{
 			GTSL::WriteLock lock(recurringTasksInfoMutex);
 			GTSL::WriteLock lock2(recurringGoalsMutex);
-			recurringGoals[startOnGoalIndex].AddTask(name, FunctionType::Create(task), objects, accesses, taskObjectiveIndex, GetPersistentAllocator());
+			recurringGoals[startOnGoalIndex].AddTask(name, task, objects, accesses, taskObjectiveIndex, schedule, GetPersistentAllocator());
 			recurringTasksInfo[startOnGoalIndex].EmplaceBack(GTSL::MoveRef(taskInfo));
+			compileTaskGraph();
 		}
 
 		BE_LOG_MESSAGE("Added recurring task ", name.GetString(), " to goal ", startOn.GetString(), " to be done before ", doneFor.GetString())
@@ -93,16 +102,29 @@ public:
 	template<typename... ARGS>
 	void AddDynamicTask(const Id name, const GTSL::Delegate<void(TaskInfo, ARGS...)>& function, const GTSL::Ranger<const TaskDependency> dependencies, const Id startOn, const Id doneFor, ARGS&&... args)
 	{
-		auto* taskInfo = GTSL::New<DispatchTaskInfo<TaskInfo, ARGS...>>(GetTransientAllocator(), function, TaskInfo(), GTSL::ForwardRef<ARGS>(args)...);
+		AddDynamicTask(name, TaskSchedule(), function, dependencies, startOn, doneFor, GTSL::ForwardRef<ARGS>(args)...);
+	}
+
+	/**
+	 * \brief Adds a task which runs once.
+	 * \param schedule Priority and deadline of the task. Tasks of a goal are dispatched highest priority and earliest deadline first,
+	 * LOW priority tasks are deferred to later frames while the frame is over budget, see SetFrameBudget.
+	 */
+	template<typename... ARGS>
+	void AddDynamicTask(const Id name, const TaskSchedule schedule, const GTSL::Delegate<void(TaskInfo, ARGS...)>& function, const GTSL::Ranger<const TaskDependency> dependencies, const Id startOn, const Id doneFor, ARGS&&... args)
+	{
+		auto* taskInfo = newDynamicTaskInfo<TaskInfo, ARGS...>(schedule, function, TaskInfo(), GTSL::ForwardRef<ARGS>(args)...);
+		BE_DEBUG_ONLY(taskInfo->Name = name)
 		
 		auto task = [](GameInstance* gameInstance, const uint32 goal, const uint32 goalTaskIndex, const uint32 dynamicTaskIndex) -> void
 		{
 			{				
 				GTSL::ReadLock lock(gameInstance->dynamicTasksInfoMutex);
-				DispatchTaskInfo<TaskInfo, ARGS...>* info = static_cast<DispatchTaskInfo<TaskInfo, ARGS...>*>(gameInstance->dynamicTasksInfo[goal][goalTaskIndex]);
+				DispatchTaskInfo<TaskInfo, ARGS...>* info = static_cast<DispatchTaskInfo<TaskInfo, ARGS...>*>(gameInstance->dynamicTasksInfo[goal][goalTaskIndex].Info);
 				GTSL::Get<0>(info->Arguments).GameInstance = gameInstance;
+				BE_DEBUG_ONLY(TaskProfiler::TaskScope profilerScope(info->Name, goal))
 				GTSL::Call(info->Delegate, info->Arguments);
-				GTSL::Delete<DispatchTaskInfo<TaskInfo, ARGS...>>(info, gameInstance->GetTransientAllocator());
+				gameInstance->deleteDynamicTaskInfo(info);
 			}
 
 			gameInstance->taskSorter.ReleaseResources(dynamicTaskIndex);
@@ -122,8 +144,8 @@ public:
 		{
 			GTSL::WriteLock lock(dynamicTasksInfoMutex);
 			GTSL::WriteLock lock2(dynamicGoalsMutex);
-			dynamicGoals[startOnGoalIndex].AddTask(name, FunctionType::Create(task), objects, accesses, taskObjectiveIndex, GetPersistentAllocator());
-			dynamicTasksInfo[startOnGoalIndex].EmplaceBack(taskInfo);
+			dynamicGoals[startOnGoalIndex].AddTask(name, FunctionType::Create(task), objects, accesses, taskObjectiveIndex, schedule, GetPersistentAllocator());
+			dynamicTasksInfo[startOnGoalIndex].EmplaceBack(taskInfo, &freeDynamicTaskInfo<TaskInfo, ARGS...>);
 		}
 
 		BE_LOG_MESSAGE("Added dynamic task ", name.GetString(), " to goal ", startOn.GetString(), " to be done before ", doneFor.GetString())
@@ -132,16 +154,24 @@ public:
 	template<typename... ARGS>
 	void AddDynamicTask(const Id name, const GTSL::Delegate<void(TaskInfo, ARGS...)>& function, const GTSL::Ranger<const TaskDependency> dependencies, ARGS&&... args)
 	{
-		auto* taskInfo = GTSL::New<DispatchTaskInfo<TaskInfo, ARGS...>>(GetTransientAllocator(), function, TaskInfo(), GTSL::ForwardRef<ARGS>(args)...);
+		AddDynamicTask(name, TaskSchedule(), function, dependencies, GTSL::ForwardRef<ARGS>(args)...);
+	}
+
+	template<typename... ARGS>
+	void AddDynamicTask(const Id name, const TaskSchedule schedule, const GTSL::Delegate<void(TaskInfo, ARGS...)>& function, const GTSL::Ranger<const TaskDependency> dependencies, ARGS&&... args)
+	{
+		auto* taskInfo = newDynamicTaskInfo<TaskInfo, ARGS...>(schedule, function, TaskInfo(), GTSL::ForwardRef<ARGS>(args)...);
+		BE_DEBUG_ONLY(taskInfo->Name = name)
 
 		auto task = [](GameInstance* gameInstance, const uint32 goal, const uint32 goalTaskIndex, const uint32 dynamicTaskIndex) -> void
 		{
 			{
 				GTSL::ReadLock lock(gameInstance->dynamicTasksInfoMutex);
-				DispatchTaskInfo<TaskInfo, ARGS...>* info = static_cast<DispatchTaskInfo<TaskInfo, ARGS...>*>(gameInstance->dynamicTasksInfo[goal][goalTaskIndex]);
+				DispatchTaskInfo<TaskInfo, ARGS...>* info = static_cast<DispatchTaskInfo<TaskInfo, ARGS...>*>(gameInstance->dynamicTasksInfo[goal][goalTaskIndex].Info);
 				GTSL::Get<0>(info->Arguments).GameInstance = gameInstance;
+				BE_DEBUG_ONLY(TaskProfiler::TaskScope profilerScope(info->Name, goal))
 				GTSL::Call(info->Delegate, info->Arguments);
-				GTSL::Delete<DispatchTaskInfo<TaskInfo, ARGS...>>(info, gameInstance->GetTransientAllocator());
+				gameInstance->deleteDynamicTaskInfo(info);
 			}
 
 			gameInstance->taskSorter.ReleaseResources(dynamicTaskIndex);
@@ -158,12 +188,128 @@ public:
 		{
 			GTSL::WriteLock lock(dynamicTasksInfoMutex);
 			GTSL::WriteLock lock2(dynamicGoalsMutex);
-			dynamicGoals[0].AddTask(name, FunctionType::Create(task), objects, accesses, 1, GetPersistentAllocator());
-			dynamicTasksInfo[0].EmplaceBack(taskInfo);
+			dynamicGoals[0].AddTask(name, FunctionType::Create(task), objects, accesses, 1, schedule, GetPersistentAllocator());
+			dynamicTasksInfo[0].EmplaceBack(taskInfo, &freeDynamicTaskInfo<TaskInfo, ARGS...>);
 		}
 	}
 
+	/**
+	 * \brief Runs function over [0, rangeSize) split in chunks spread across the thread pool's workers.
+	 * It's dispatched like a dynamic task on the first goal, so added from a task it runs next frame. To split the work of a running task use the overload taking a TaskInfo.
+	 * Dependencies are acquired once for the whole range and released when the last chunk is done, so declare the system owning the data being iterated as READ_WRITE.
+	 * \param grainSize Minimum number of elements per chunk. Chunks get bigger based on the time per element measured in previous runs with the same name,
+	 * so that every chunk takes around PARALLEL_FOR_CHUNK_MICROSECONDS.
+	 * \param function Called with the start and one past the end of every chunk.
+	 */
+	void ParallelFor(const Id name, const uint32 rangeSize, const uint32 grainSize, const GTSL::Delegate<void(TaskInfo, uint32, uint32)>& function, const GTSL::Ranger<const TaskDependency> dependencies)
+	{
+		BE_ASSERT(grainSize != 0, "Grain size can't be 0!")
+
+		auto* parallelForInfo = GTSL::New<ParallelForInfo>(GetTransientAllocator(), name, rangeSize, grainSize, function);
+
+		auto task = [](GameInstance* gameInstance, const uint32 goal, const uint32 goalTaskIndex, const uint32 dynamicTaskIndex) -> void
+		{
+			ParallelForInfo* info;
+
+			{
+				GTSL::ReadLock lock(gameInstance->dynamicTasksInfoMutex);
+				info = static_cast<ParallelForInfo*>(gameInstance->dynamicTasksInfo[goal][goalTaskIndex].Info);
+			}
+
+			{
+				BE_DEBUG_ONLY(TaskProfiler::TaskScope profilerScope(info->Name, goal))
+				gameInstance->runParallelFor(info);
+			}
+
+			GTSL::Delete<ParallelForInfo>(info, gameInstance->GetTransientAllocator());
+
+			gameInstance->taskSorter.ReleaseResources(dynamicTaskIndex);
+		};
+
+		GTSL::Array<uint16, 32> objects; GTSL::Array<AccessType, 32> accesses;
+
+		{
+			GTSL::ReadLock lock(goalNamesMutex);
+			decomposeTaskDescriptor(dependencies, objects, accesses);
+		}
+
+		{
+			GTSL::WriteLock lock(dynamicTasksInfoMutex);
+			GTSL::WriteLock lock2(dynamicGoalsMutex);
+			dynamicGoals[0].AddTask(name, FunctionType::Create(task), objects, accesses, 1, TaskSchedule(), GetPersistentAllocator());
+			dynamicTasksInfo[0].EmplaceBack(parallelForInfo, &freeParallelForInfo);
+		}
+	}
+
+	/**
+	 * \brief Runs function over [0, rangeSize) split in chunks spread across the thread pool's workers, right away from inside the running task taskInfo belongs to,
+	 * and returns once the whole range is done. Chunks run under the accesses the calling task already holds, so they may only touch what it declared.
+	 * Chunks are sized like the other overload's.
+	 */
+	void ParallelFor(const TaskInfo taskInfo, const Id name, const uint32 rangeSize, const uint32 grainSize, const GTSL::Delegate<void(TaskInfo, uint32, uint32)>& function)
+	{
+		BE_ASSERT(grainSize != 0, "Grain size can't be 0!")
+		BE_ASSERT(taskInfo.GameInstance == this, "Parallel for must be run from a task of this game instance!")
+
+		//only read while chunks are left, which is no longer than this call
+		ParallelForInfo parallelForInfo(name, rangeSize, grainSize, function);
+		BE_DEBUG_ONLY(TaskProfiler::TaskScope profilerScope(name, 0xFFFF))
+		runParallelFor(&parallelForInfo);
+	}
+
 	void AddGoal(Id name);
+
+	/**
+	 * \brief Sets how many frames can be running at the same time. With more than 1 a frame's goals can start while the previous frames'
+	 * recurring tasks are still running, as long as they don't access the same objects in conflicting ways, and OnUpdate returns without waiting for the frame's tasks.
+	 * \param depth Number of frames which can be in flight, 1 to 3. 1 runs frames back to back.
+	 */
+	void SetFramesInFlight(const uint8 depth)
+	{
+		BE_ASSERT(depth >= 1 && depth <= MAX_FRAMES_IN_FLIGHT, "Invalid number of frames in flight!")
+		framesInFlight = depth;
+	}
+
+	/**
+	 * \brief Blocks until every frame still in flight has finished, running pending tasks on the calling thread meanwhile.
+	 */
+	void WaitForFrames(BE::Application* application);
+
+	/**
+	 * \brief Sets the time a frame should take. Once this much time has passed since the start of a frame LOW priority dynamic tasks are deferred to later frames,
+	 * for at most MAX_DEFERRED_FRAMES frames. 0, the default, disables deferring.
+	 */
+	void SetFrameBudget(const GTSL::Microseconds budget) { frameBudget = budget; }
+
+	/**
+	 * \brief Returns the number of task records the thread pool allocated while running frames once warmed up, see ThreadPool::GetAllocationCount.
+	 * Should stay close to 0, records are recycled. It's not always 0 since records freed by other threads only go back to a thread when it runs out,
+	 * and with more than one frame in flight records of different frames share the same pool. Logged at shutdown.
+	 */
+	[[nodiscard]] uint64 GetSteadyStateTaskAllocations() const { return steadyStateTaskAllocations; }
+
+	struct GoalTiming
+	{
+		/**
+		 * \brief Time at which the goal's tasks were allowed to start.
+		 */
+		GTSL::Microseconds Start;
+		/**
+		 * \brief Time at which the last recurring task which started on the goal finished.
+		 */
+		GTSL::Microseconds End;
+	};
+
+	/**
+	 * \brief Returns the start and end timestamps of every goal of one of the last frames, to measure the overlap achieved between frames.
+	 * \param framesAgo 0 for the frame last started by OnUpdate, up to MAX_FRAMES_IN_FLIGHT - 1. Ends of goals still running are not valid.
+	 */
+	[[nodiscard]] GTSL::Ranger<const GoalTiming> GetGoalTimings(const uint8 framesAgo) const
+	{
+		BE_ASSERT(framesAgo < MAX_FRAMES_IN_FLIGHT && framesAgo < frameCount, "Frame is not kept!")
+		const auto& frame = frames[(frameCount - 1 - framesAgo) % MAX_FRAMES_IN_FLIGHT];
+		return GTSL::Ranger<const GoalTiming>(frame.GoalCount, frame.GoalTimings);
+	}
 	
 private:
 	mutable GTSL::ReadWriteMutex systemsMutex;
@@ -180,9 +326,54 @@ private:
 		{
 		}
 
+		/**
+		 * \brief Body of recurring tasks, which are bound to their info.
+		 */
+		void RunRecurring(GameInstance* gameInstance, const uint32 goal, const uint32 goalTaskIndex, const uint32 dynamicTaskIndex)
+		{
+			{
+				GTSL::Get<0>(Arguments).GameInstance = gameInstance;
+				BE_DEBUG_ONLY(TaskProfiler::TaskScope profilerScope(Name, goal))
+				GTSL::Call(Delegate, Arguments);
+			}
+
+			gameInstance->taskSorter.ReleaseResources(dynamicTaskIndex);
+		}
+
 		GTSL::Delegate<void(ARGS...)> Delegate;
 		GTSL::Tuple<ARGS...> Arguments;
+		/**
+		 * \brief Whether the info was allocated from the persistent allocator, dynamic tasks which might be deferred have to outlive the frame's transient allocations.
+		 */
+		bool Persistent = false;
+		BE_DEBUG_ONLY(Id Name)
 	};
+
+	template<typename... ARGS>
+	DispatchTaskInfo<ARGS...>* newDynamicTaskInfo(const TaskSchedule schedule, const GTSL::Delegate<void(ARGS...)>& delegate, ARGS&&... args)
+	{
+		if (schedule.Priority == TaskPriority::LOW)
+		{
+			auto* taskInfo = GTSL::New<DispatchTaskInfo<ARGS...>>(GetPersistentAllocator(), delegate, GTSL::ForwardRef<ARGS>(args)...);
+			taskInfo->Persistent = true;
+			return taskInfo;
+		}
+
+		return GTSL::New<DispatchTaskInfo<ARGS...>>(GetTransientAllocator(), delegate, GTSL::ForwardRef<ARGS>(args)...);
+	}
+
+	template<typename... ARGS>
+	void deleteDynamicTaskInfo(DispatchTaskInfo<ARGS...>* taskInfo)
+	{
+		if (taskInfo->Persistent) { GTSL::Delete<DispatchTaskInfo<ARGS...>>(taskInfo, GetPersistentAllocator()); }
+		else { GTSL::Delete<DispatchTaskInfo<ARGS...>>(taskInfo, GetTransientAllocator()); }
+	}
+
+	template<typename... ARGS>
+	static void freeDynamicTaskInfo(GameInstance* gameInstance, void* taskInfo)
+	{
+		gameInstance->deleteDynamicTaskInfo(static_cast<DispatchTaskInfo<ARGS...>*>(taskInfo));
+	}
 	
 	mutable GTSL::ReadWriteMutex recurringGoalsMutex;
 	GTSL::Vector<Goal<FunctionType, BE::PersistentAllocatorReference>, BE::PersistentAllocatorReference> recurringGoals;
@@ -194,14 +385,182 @@ private:
 
 	mutable GTSL::ReadWriteMutex recurringTasksInfoMutex;
 	GTSL::Vector<GTSL::Vector<GTSL::SmartPointer<void*, BE::PersistentAllocatorReference>, BE::PersistentAllocatorReference>, BE::PersistentAllocatorReference> recurringTasksInfo;
+	/**
+	 * \brief Infos of removed recurring tasks. Nodes of the active task graph might still run them, they are freed once the graph is swapped out.
+	 */
+	GTSL::Vector<GTSL::SmartPointer<void*, BE::PersistentAllocatorReference>, BE::PersistentAllocatorReference> retiredTasksInfo;
 	
 	mutable GTSL::ReadWriteMutex dynamicTasksInfoMutex;
-	GTSL::Vector<GTSL::Vector<void*, BE::PersistentAllocatorReference>, BE::PersistentAllocatorReference> dynamicTasksInfo;
+	/**
+	 * \brief Info of a dynamic task, tasks free it when they run. Delete frees the infos of tasks which never got to run, see ~GameInstance.
+	 */
+	struct DynamicTaskInfo
+	{
+		DynamicTaskInfo(void* info, void(*deleteInfo)(GameInstance*, void*)) : Info(info), Delete(deleteInfo)
+		{
+		}
+
+		void* Info = nullptr;
+		void(*Delete)(GameInstance*, void*) = nullptr;
+	};
+	GTSL::Vector<GTSL::Vector<DynamicTaskInfo, BE::PersistentAllocatorReference>, BE::PersistentAllocatorReference> dynamicTasksInfo;
 
 	TaskSorter<BE::PersistentAllocatorReference> taskSorter;
 
-	uint32 scalingFactor = 16;
-	
+	/**
+	 * \brief Recurring tasks compiled into a dependency graph, double buffered so tasks can be added or removed while a frame is running.
+	 * Compiled into the inactive graph every time a recurring task or goal is added or removed(guarded by recurringGoalsMutex),
+	 * swapped in at the start of the next frame.
+	 */
+	TaskGraph<FunctionType, BE::PersistentAllocatorReference> taskGraphs[2];
+	uint8 activeTaskGraph = 0;
+	bool taskGraphDirty = false;
+
+	static constexpr uint16 MAX_GOALS = 64;
+	static constexpr uint8 MAX_FRAMES_IN_FLIGHT = 3;
+
+	/**
+	 * \brief State of a frame's replay of the task graph. Kept for MAX_FRAMES_IN_FLIGHT frames so a frame can start while previous ones are still running.
+	 */
+	struct FrameState
+	{
+		explicit FrameState(const BE::PersistentAllocatorReference& allocatorReference) : NodeDependencyCounters(64, allocatorReference), NodeStates(64, allocatorReference)
+		{
+		}
+
+		/**
+		 * \brief Dependency counters of the graph's nodes, when one reaches 0 the node is dispatched.
+		 */
+		GTSL::Vector<uint16, BE::PersistentAllocatorReference> NodeDependencyCounters;
+
+		/**
+		 * \brief Per node NODE_DONE and NEXT_FRAME_READY bits. Whichever of the node or the next frame's setup sets the second bit releases
+		 * the node's successors in the next frame.
+		 */
+		GTSL::Vector<uint8, BE::PersistentAllocatorReference> NodeStates;
+
+		std::atomic<uint32> PendingNodes{ 0 };
+
+		/**
+		 * \brief One latch per goal counting the tasks which have to be done before the goal can start.
+		 * Set at the start of every frame to the number of recurring tasks started in a previous goal targeting it, raised for every dynamic task dispatched targeting it.
+		 */
+		Latch GoalLatches[MAX_GOALS];
+
+		/**
+		 * \brief Counts the dynamic tasks dispatched during the frame which no goal waits for.
+		 */
+		Latch DynamicTasks;
+
+		/**
+		 * \brief Number of recurring tasks started in each goal which haven't finished yet, used to timestamp the end of goals.
+		 */
+		uint16 GoalPendingNodes[MAX_GOALS]{};
+		GoalTiming GoalTimings[MAX_GOALS];
+		uint16 GoalCount = 0;
+
+		uint8 TaskGraph = 0;
+		uint64 Frame = 0;
+	};
+
+	static constexpr uint8 NODE_DONE = 1, NEXT_FRAME_READY = 2;
+
+	FrameState frames[MAX_FRAMES_IN_FLIGHT];
+	uint8 framesInFlight = 1;
+	uint64 frameCount = 0;
+
+	/**
+	 * \brief Frames the thread pool gets to warm up it's task records after the task graph changes or a frame runs more dynamic tasks than any before.
+	 * Allocations made by frames after that are counted, see GetSteadyStateTaskAllocations.
+	 */
+	static constexpr uint32 TASK_ALLOCATION_WARM_UP_FRAMES = 64;
+	uint64 taskAllocationCount = 0, steadyStateTaskAllocations = 0;
+	uint32 taskAllocationWarmUpFrames = TASK_ALLOCATION_WARM_UP_FRAMES, steadyStateAllocatingFrames = 0;
+	uint32 maxFrameDynamicTasks = 0;
+
+	static constexpr uint8 MAX_DEFERRED_FRAMES = 8;
+
+	GTSL::Microseconds frameBudget;
+	GTSL::Microseconds frameStartTime;
+
+	[[nodiscard]] bool isOverBudget(BE::Application* application) const;
+
+	/**
+	 * \brief Blocks until every task which has to be done before the goal starts has finished, running pending tasks on the calling thread meanwhile.
+	 */
+	void waitForGoal(FrameState& frame, uint16 goal, BE::Application* application);
+
+	/**
+	 * \brief Blocks until every recurring task of a frame has finished, running pending tasks on the calling thread meanwhile.
+	 */
+	void waitForFrame(const FrameState& frame, BE::Application* application);
+
+	/**
+	 * \brief Must be called with a write lock on recurringGoalsMutex.
+	 */
+	void compileTaskGraph()
+	{
+		taskGraphs[!activeTaskGraph].Compile(recurringGoals, GetPersistentAllocator());
+		taskGraphDirty = true;
+	}
+
+	void dispatchRecurringNode(uint8 frame, uint16 node);
+	void runRecurringNode(uint8 frame, uint16 node);
+	void releaseNextFrameNodes(uint8 frame, uint16 node);
+
+	/**
+	 * \brief Target duration of a parallel for chunk. Long enough for the cost of dispatching and claiming a chunk to be negligible,
+	 * short enough for the chunks to balance across workers.
+	 */
+	static constexpr uint32 PARALLEL_FOR_CHUNK_MICROSECONDS = 50;
+
+	struct ParallelForInfo
+	{
+		ParallelForInfo(const Id name, const uint32 rangeSize, const uint32 grainSize, const GTSL::Delegate<void(TaskInfo, uint32, uint32)>& delegate) :
+		Name(name), RangeSize(rangeSize), GrainSize(grainSize), Delegate(delegate)
+		{
+		}
+
+		Id Name;
+		uint32 RangeSize, GrainSize;
+		GTSL::Delegate<void(TaskInfo, uint32, uint32)> Delegate;
+	};
+
+	static void freeParallelForInfo(GameInstance* gameInstance, void* parallelForInfo)
+	{
+		GTSL::Delete<ParallelForInfo>(static_cast<ParallelForInfo*>(parallelForInfo), gameInstance->GetTransientAllocator());
+	}
+
+	/**
+	 * \brief Chunking state of a parallel for while it runs. Helper tasks might only get to run after the parallel for is over,
+	 * so it's reference counted and freed by whichever of the starting thread or the helpers lets go of it last.
+	 */
+	struct ParallelForRun
+	{
+		ParallelForInfo* Info = nullptr;
+		uint32 RangeSize = 0, ChunkSize = 0;
+		std::atomic<uint32> NextElement{ 0 };
+		/**
+		 * \brief Number of elements whose chunk has finished running, the starting thread waits on it reaching RangeSize.
+		 */
+		std::atomic<uint32> DoneElements{ 0 };
+		/**
+		 * \brief Sum of the time spent by all threads running chunks.
+		 */
+		std::atomic<uint64> WorkMicroseconds{ 0 };
+		std::atomic<uint32> References{ 0 };
+	};
+
+	/**
+	 * \brief Exponential moving average of the time taken per element by every parallel for, used to size the chunks of the next run.
+	 */
+	GTSL::FlatHashMap<float32, BE::PersistentAllocatorReference> parallelForTimes;
+	GTSL::Mutex parallelForTimesMutex;
+
+	void runParallelFor(ParallelForInfo* info);
+	void runParallelForChunks(ParallelForRun* run);
+	void releaseParallelForRun(ParallelForRun* run);
+
 	void initWorld(uint8 worldId);
 	void initSystem(System* system, GTSL::Id64 name);
 
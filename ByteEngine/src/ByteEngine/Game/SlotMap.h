@@ -0,0 +1,134 @@
+#pragma once
+
+#include "ByteEngine/Core.h"
+
+#include <GTSL/Vector.hpp>
+
+#include "ByteEngine/Debug/Assert.h"
+
+/**
+ * \brief Reference to a component which stays valid until the component is removed. Once it's removed the handle is stale and can be detected as such,
+ * even after it's slot has been reused by a new component, because the slot's generation is bumped on every removal.
+ */
+struct ComponentHandle
+{
+	uint32 Index = 0xFFFFFFFF;
+	uint32 Generation = 0;
+
+	bool operator==(const ComponentHandle& other) const { return Index == other.Index && Generation == other.Generation; }
+	bool operator!=(const ComponentHandle& other) const { return !(*this == other); }
+};
+
+/**
+ * \brief Hands out generational handles and maps them to indices into a system's component arrays, which are kept densely packed so they can be iterated
+ * without holes. Component data isn't stored here, systems keep it in as many parallel arrays as they like: adding a component appends to every array
+ * and removing one moves the last component into it's place, which Remove reports so the system can do the same, see SwapRemove.
+ * Emplace, IsValid, GetIndex and Remove are all O(1). Freed slots are kept in a free list threaded through the slots themselves.
+ */
+template<class ALLOCATOR>
+class SlotMap
+{
+public:
+	SlotMap() = default;
+	SlotMap(const uint32 capacity, const ALLOCATOR& allocator) : slots(capacity, allocator), denseToSlot(capacity, allocator) {}
+
+	void Initialize(const uint32 capacity, const ALLOCATOR& allocator)
+	{
+		slots.Initialize(capacity, allocator);
+		denseToSlot.Initialize(capacity, allocator);
+	}
+
+	/**
+	 * \brief Creates a handle for a new component, which lives at index GetLength() - 1 of the system's arrays.
+	 */
+	ComponentHandle Emplace()
+	{
+		uint32 slot;
+
+		if (freeSlot != INVALID)
+		{
+			slot = freeSlot; freeSlot = slots[slot].DenseIndex;
+		}
+		else
+		{
+			slot = slots.EmplaceBack();
+		}
+
+		slots[slot].DenseIndex = denseToSlot.EmplaceBack(slot);
+
+		return ComponentHandle{ slot, slots[slot].Generation };
+	}
+
+	[[nodiscard]] bool IsValid(const ComponentHandle handle) const { return handle.Index < slots.GetLength() && slots[handle.Index].Generation == handle.Generation; }
+
+	/**
+	 * \brief Returns the index of handle's component in the system's arrays. It changes when other components are removed, so it shouldn't be kept.
+	 */
+	[[nodiscard]] uint32 GetIndex(const ComponentHandle handle) const
+	{
+		BE_ASSERT(IsValid(handle), "Stale component handle!")
+		return slots[handle.Index].DenseIndex;
+	}
+
+	[[nodiscard]] ComponentHandle GetHandle(const uint32 index) const
+	{
+		const uint32 slot = denseToSlot[index];
+		return ComponentHandle{ slot, slots[slot].Generation };
+	}
+
+	/**
+	 * \brief Removes handle's component and invalidates every copy of handle.
+	 * \return Index the component occupied, the system has to move it's last component there, see SwapRemove.
+	 */
+	uint32 Remove(const ComponentHandle handle)
+	{
+		const uint32 index = GetIndex(handle);
+		const uint32 last = denseToSlot.GetLength() - 1;
+
+		denseToSlot[index] = denseToSlot[last];
+		slots[denseToSlot[index]].DenseIndex = index;
+		denseToSlot.Pop(last);
+
+		auto& slot = slots[handle.Index];
+		++slot.Generation; slot.DenseIndex = freeSlot; freeSlot = handle.Index;
+
+		return index;
+	}
+
+	/**
+	 * \brief Bytes the map takes per component, for sizing memory budgets.
+	 */
+	static constexpr uint32 BYTES_PER_HANDLE = sizeof(uint32) * 3;
+
+	/**
+	 * \brief Number of live components.
+	 */
+	[[nodiscard]] uint32 GetLength() const { return denseToSlot.GetLength(); }
+
+	/**
+	 * \brief Moves vector's last element into index and drops the last one, mirroring what Remove did to the handles.
+	 */
+	template<typename T, class A>
+	static void SwapRemove(GTSL::Vector<T, A>& vector, const uint32 index)
+	{
+		const uint32 last = vector.GetLength() - 1;
+		if (index != last) { vector[index] = vector[last]; }
+		vector.Pop(last);
+	}
+
+private:
+	static constexpr uint32 INVALID = 0xFFFFFFFF;
+
+	struct Slot
+	{
+		/**
+		 * \brief Index of the component in the dense arrays while the slot is live, the next free slot while it's free.
+		 */
+		uint32 DenseIndex = INVALID;
+		uint32 Generation = 0;
+	};
+
+	GTSL::Vector<Slot, ALLOCATOR> slots;
+	GTSL::Vector<uint32, ALLOCATOR> denseToSlot;
+	uint32 freeSlot = INVALID;
+};
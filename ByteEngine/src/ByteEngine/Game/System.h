@@ -36,8 +36,8 @@ public:
 	{
 		class GameInstance* GameInstance{ nullptr };
 		/**
-		 * \brief Rough estimate for number of components present during average run of the application.
-		 * Can be used for initialization of data structures to allocate "enough" space during start as to avoid as many re-allocations further down the line.
+		 * \brief Number of components the application declared for this system in the MemoryBudget, MemoryBudget::DEFAULT_COMPONENT_COUNT if it declared none.
+		 * Component arrays should be initialized with this capacity and allocated with GetComponentAllocator, so they are reserved at startup and don't grow during frames.
 		 */
 		uint32 ScalingFactor = 0;
 	};
@@ -48,5 +48,10 @@ public:
 		class GameInstance* GameInstance = nullptr;
 	};
 	virtual void Shutdown(const ShutdownInfo& shutdownInfo) = 0;
+
+	/**
+	 * \brief Allocator for component arrays, allocates from the memory budget's arena.
+	 */
+	[[nodiscard]] BE::ComponentAllocatorReference GetComponentAllocator() const { return BE::ComponentAllocatorReference(GetName()); }
 private:
 };
@@ -8,8 +8,16 @@
 #include <GTSL/KeepVector.h>
 #include <GTSL/Result.h>
 #include <GTSL/Array.hpp>
+#include <GTSL/Pair.h>
+
+#include <atomic>
+#include <bit>
+#include <new>
+
+#include <GTSL/Time.h>
 
 #include "ByteEngine/Id.h"
+#include "ByteEngine/Application/TaskPriority.h"
 #include "ByteEngine/Debug/Assert.h"
 
 //enum class AccessType : uint8 { READ = 1, READ_WRITE = 4 };
@@ -37,6 +45,39 @@ struct TaskDependency
 	AccessType Access;
 };
 
+/**
+ * \brief When a task should run relative to other tasks of it's goal.
+ */
+struct TaskSchedule
+{
+	TaskSchedule() = default;
+	TaskSchedule(const TaskPriority priority) : Priority(priority) {}
+	TaskSchedule(const TaskPriority priority, const GTSL::Microseconds deadline) : Priority(priority), Deadline(deadline) {}
+
+	TaskPriority Priority = TaskPriority::NORMAL;
+
+	/**
+	 * \brief Time since the start of the frame by which the task should have been dispatched. Tasks of the same priority are dispatched earliest deadline first,
+	 * 0 means no deadline, those go after the ones with one.
+	 */
+	GTSL::Microseconds Deadline;
+
+	/**
+	 * \brief Number of frames a low priority dynamic task has been deferred for because the frame was over budget.
+	 */
+	uint8 DeferredFrames = 0;
+
+	/**
+	 * \brief Whether this should be dispatched before other when both are ready.
+	 */
+	[[nodiscard]] bool GoesBefore(const TaskSchedule& other) const
+	{
+		if (Priority != other.Priority) { return Priority < other.Priority; }
+		if (Deadline.GetCount() == 0 || other.Deadline.GetCount() == 0) { return Deadline.GetCount() != 0 && other.Deadline.GetCount() == 0; }
+		return Deadline < other.Deadline;
+	}
+};
+
 template<typename TASK, class ALLOCATOR>
 struct Goal
 {
@@ -46,6 +87,7 @@ struct Goal
 	taskAccessedObjects(num, allocatorReference),
 	taskAccessTypes(num, allocatorReference),
 	taskGoalIndex(num, allocatorReference),
+	taskSchedules(num, allocatorReference),
 	taskNames(num, allocatorReference),
 	tasks(num, allocatorReference)
 	{
@@ -56,6 +98,7 @@ struct Goal
 	taskAccessedObjects(other.taskAccessedObjects.GetCapacity(), allocatorReference),
 	taskAccessTypes(other.taskAccessTypes.GetCapacity(), allocatorReference),
 	taskGoalIndex(other.taskGoalIndex, allocatorReference),
+	taskSchedules(other.taskSchedules, allocatorReference),
 	taskNames(other.taskNames, allocatorReference),
 	tasks(other.tasks, allocatorReference)
 	{
@@ -72,12 +115,13 @@ struct Goal
 		taskAccessedObjects = other.taskAccessedObjects;
 		taskAccessTypes = other.taskAccessTypes;
 		taskGoalIndex = other.taskGoalIndex;
+		taskSchedules = other.taskSchedules;
 		taskNames = other.taskNames;
 		tasks = other.tasks;
 		return *this;
 	}
 	
-	void AddTask(Id name, TASK task, GTSL::Ranger<const uint16> offsets, const GTSL::Ranger<const AccessType> accessTypes, uint16 goalIndex, const ALLOCATOR& allocator)
+	void AddTask(Id name, TASK task, GTSL::Ranger<const uint16> offsets, const GTSL::Ranger<const AccessType> accessTypes, uint16 goalIndex, const TaskSchedule schedule, const ALLOCATOR& allocator)
 	{
 		auto task_n = taskAccessedObjects.EmplaceBack(16, allocator);
 		taskAccessTypes.EmplaceBack(16, allocator);
@@ -87,6 +131,7 @@ struct Goal
 		
 		taskNames.EmplaceBack(name);
 		taskGoalIndex.EmplaceBack(goalIndex);
+		taskSchedules.EmplaceBack(schedule);
 		tasks.EmplaceBack(task);
 	}
 
@@ -101,6 +146,7 @@ struct Goal
 		
 		taskNames.PushBack(GTSL::Ranger<const Id>(taskE - taskS, other.taskNames.begin() + taskS));
 		taskGoalIndex.PushBack(GTSL::Ranger<const uint16>(taskE - taskS, other.taskGoalIndex.begin() + taskS));
+		taskSchedules.PushBack(GTSL::Ranger<const TaskSchedule>(taskE - taskS, other.taskSchedules.begin() + taskS));
 		tasks.PushBack(GTSL::Ranger<const TASK>(taskE - taskS, other.tasks.begin() + taskS));
 	}
 
@@ -109,11 +155,15 @@ struct Goal
 		auto res = taskNames.Find(name);
 		BE_ASSERT(res != taskNames.end(), "No task by that name");
 
-		uint32 i = static_cast<uint32>(res - taskNames.begin());
-		
+		PopTask(static_cast<uint16>(res - taskNames.begin()));
+	}
+
+	void PopTask(const uint16 i)
+	{
 		taskAccessedObjects.Pop(i);
 		taskAccessTypes.Pop(i);
 		taskGoalIndex.Pop(i);
+		taskSchedules.Pop(i);
 		taskNames.Pop(i);
 		tasks.Pop(i);
 	}
@@ -126,10 +176,21 @@ struct Goal
 
 	[[nodiscard]] Id GetTaskName(const uint16 task) const { return taskNames[task]; }
 
+	[[nodiscard]] uint16 GetTaskIndex(const Id name) const
+	{
+		auto res = taskNames.Find(name);
+		BE_ASSERT(res != taskNames.end(), "No task by that name");
+		return static_cast<uint16>(res - taskNames.begin());
+	}
+
 	[[nodiscard]] uint16 GetNumberOfTasks() const { return static_cast<uint16>(tasks.GetLength()); }
 
 	[[nodiscard]] uint16 GetTaskGoalIndex(const uint16 task) const { return taskGoalIndex[task]; }
 
+	[[nodiscard]] TaskSchedule GetTaskSchedule(const uint16 task) const { return taskSchedules[task]; }
+
+	void SetTaskSchedule(const uint16 task, const TaskSchedule schedule) { taskSchedules[task] = schedule; }
+
 	void Clear()
 	{
 		for (auto& e : taskAccessedObjects) { e.ResizeDown(0); }
@@ -138,6 +199,7 @@ struct Goal
 		taskAccessTypes.ResizeDown(0);
 
 		taskGoalIndex.ResizeDown(0);
+		taskSchedules.ResizeDown(0);
 
 		taskNames.ResizeDown(0);
 		tasks.ResizeDown(0);
@@ -150,6 +212,7 @@ private:
 	GTSL::Vector<GTSL::Vector<AccessType, ALLOCATOR>, ALLOCATOR> taskAccessTypes;
 	
 	GTSL::Vector<uint16, ALLOCATOR> taskGoalIndex;
+	GTSL::Vector<TaskSchedule, ALLOCATOR> taskSchedules;
 	
 	GTSL::Vector<Id, ALLOCATOR> taskNames;
 	GTSL::Vector<TASK, ALLOCATOR> tasks;
@@ -157,83 +220,341 @@ private:
 	friend struct Goal;
 };
 
-template<class ALLOCATOR>
-struct TaskSorter
+/**
+ * \brief Precompiled dependency graph of all recurring tasks of every goal.
+ * Nodes are ordered by start goal and there is an edge from every node to every later node which accesses an object it also accesses,
+ * where at least one of the two accesses is READ_WRITE. Following the edges no two conflicting recurring tasks can run at the same time,
+ * so conflict detection between recurring tasks only has to happen when the graph is compiled, not every frame.
+ */
+template<typename TASK, class ALLOCATOR>
+struct TaskGraph
 {
-	explicit TaskSorter(const uint32 num, const ALLOCATOR& allocator) :
-	currentObjectAccessState(num, allocator), currentObjectAccessCount(num, allocator),
-	ongoingTasksAccesses(num, allocator), ongoingTasksObjects(num, allocator)
+	TaskGraph() = default;
+
+	TaskGraph(const uint32 num, const ALLOCATOR& allocatorReference) :
+	nodeTasks(num, allocatorReference),
+	nodeGoal(num, allocatorReference),
+	nodeGoalTask(num, allocatorReference),
+	nodeTargetGoal(num, allocatorReference),
+	nodePriority(num, allocatorReference),
+	nodeAccessedObjects(num, allocatorReference),
+	nodeAccessTypes(num, allocatorReference),
+	nodeSuccessors(num, allocatorReference),
+	nodeDependencyCount(num, allocatorReference),
+	nodeFrameSuccessors(num, allocatorReference),
+	nodeFrameDependencyCount(num, allocatorReference),
+	goalNodesEnd(num, allocatorReference),
+	goalWaitNodes(num, allocatorReference)
 	{
 	}
 
-	GTSL::Result<uint32> CanRunTask(const GTSL::Ranger<const uint16> objects, const GTSL::Ranger<const AccessType> accesses)
+	void Compile(const GTSL::Ranger<const Goal<TASK, ALLOCATOR>> goals, const ALLOCATOR& allocator)
 	{
-		BE_ASSERT(objects.ElementCount() == accesses.ElementCount(), "Bad data, shold be equal");
+		Clear();
 
-		const auto elementCount = objects.ElementCount();
-		
+		GTSL::Vector<uint16, ALLOCATOR> goalTasks(32, allocator);
+
+		for (uint16 goal = 0; goal < static_cast<uint16>(goals.ElementCount()); ++goal)
 		{
-			GTSL::ReadLock lock(mutex);
-			
-			for (uint32 i = 0; i < elementCount; ++i)
+			//higher priority and earlier deadline first, else same order in which tasks of a goal have always been dispatched, last added first.
+			//Earlier nodes run first when they conflict so this also decides which of two conflicting tasks runs first
+			goalTasks.ResizeDown(0);
+
+			for (uint16 task = goals[goal].GetNumberOfTasks(); task-- > 0;)
 			{
-				if (currentObjectAccessState[objects[i]] == AccessType::READ_WRITE) { return false; }
-				if (currentObjectAccessState[objects[i]] == AccessType::READ && accesses[i] == AccessType::READ_WRITE) { return false; }
+				uint32 i = goalTasks.GetLength(); goalTasks.EmplaceBack(task);
+				for (; i > 0 && goals[goal].GetTaskSchedule(task).GoesBefore(goals[goal].GetTaskSchedule(goalTasks[i - 1])); --i) { goalTasks[i] = goalTasks[i - 1]; }
+				goalTasks[i] = task;
 			}
+
+			for (const auto task : goalTasks)
+			{
+				nodeTasks.EmplaceBack(goals[goal].GetTask(task));
+				nodeGoal.EmplaceBack(goal);
+				nodeGoalTask.EmplaceBack(task);
+				nodeTargetGoal.EmplaceBack(goals[goal].GetTaskGoalIndex(task));
+				nodePriority.EmplaceBack(goals[goal].GetTaskSchedule(task).Priority);
+				nodeAccessedObjects.EmplaceBack(goals[goal].GetTaskAccessedObjects(task));
+				nodeAccessTypes.EmplaceBack(goals[goal].GetTaskAccessTypes(task));
+				nodeSuccessors.EmplaceBack(8, allocator);
+				nodeDependencyCount.EmplaceBack(1); //every node also waits for it's goal to start
+				nodeFrameSuccessors.EmplaceBack(8, allocator);
+				nodeFrameDependencyCount.EmplaceBack(0);
+			}
+
+			goalNodesEnd.EmplaceBack(GetNumberOfNodes());
+			goalWaitNodes.EmplaceBack(8, allocator);
 		}
 
+		for (uint16 j = 0; j < GetNumberOfNodes(); ++j)
 		{
-			GTSL::WriteLock lock(mutex);
-			
-			for (uint32 i = 0; i < elementCount; ++i)
+			for (uint16 i = 0; i < j; ++i)
 			{
-				currentObjectAccessState[objects[i]] = accesses[i];
-				++currentObjectAccessCount[objects[i]];
+				if (conflict(i, j)) { nodeSuccessors[i].EmplaceBack(j); ++nodeDependencyCount[j]; }
 			}
-			
-			auto i = ongoingTasksAccesses.Emplace(accesses);
-			auto j = ongoingTasksObjects.Emplace(objects);
 
-			BE_ASSERT(i == j, "Error")
-			return GTSL::Result<uint32>(GTSL::MoveRef(i), true);
+			//tasks which have to be done before a later goal starts are waited for by the dispatching thread
+			if (nodeGoal[j] < nodeTargetGoal[j]) { goalWaitNodes[nodeTargetGoal[j]].EmplaceBack(j); }
+		}
+
+		//when frames overlap a node also runs after every conflicting node, itself included, of the previous frame
+		for (uint16 i = 0; i < GetNumberOfNodes(); ++i)
+		{
+			for (uint16 j = 0; j < GetNumberOfNodes(); ++j)
+			{
+				if (conflict(i, j)) { nodeFrameSuccessors[i].EmplaceBack(j); ++nodeFrameDependencyCount[j]; }
+			}
 		}
 	}
 
-	void ReleaseResources(const uint32 taskIndex)
+	void Clear()
 	{
-		GTSL::WriteLock lock(mutex);
+		for (auto& e : nodeSuccessors) { e.ResizeDown(0); }
+		for (auto& e : nodeFrameSuccessors) { e.ResizeDown(0); }
+		for (auto& e : goalWaitNodes) { e.ResizeDown(0); }
+
+		nodeTasks.ResizeDown(0); nodeGoal.ResizeDown(0); nodeGoalTask.ResizeDown(0); nodeTargetGoal.ResizeDown(0); nodePriority.ResizeDown(0);
+		nodeAccessedObjects.ResizeDown(0); nodeAccessTypes.ResizeDown(0);
+		nodeSuccessors.ResizeDown(0); nodeDependencyCount.ResizeDown(0);
+		nodeFrameSuccessors.ResizeDown(0); nodeFrameDependencyCount.ResizeDown(0);
+		goalNodesEnd.ResizeDown(0); goalWaitNodes.ResizeDown(0);
+	}
 
-		const auto count = ongoingTasksAccesses[taskIndex].GetLength();
-		auto& objects = ongoingTasksObjects[taskIndex];
-		auto& accesses = ongoingTasksAccesses[taskIndex];
-		
-		for (uint32 i = 0; i < count; ++i)
+	[[nodiscard]] uint16 GetNumberOfNodes() const { return static_cast<uint16>(nodeTasks.GetLength()); }
+
+	[[nodiscard]] uint16 GetNumberOfGoals() const { return static_cast<uint16>(goalNodesEnd.GetLength()); }
+
+	[[nodiscard]] TASK GetNodeTask(const uint16 node) const { return nodeTasks[node]; }
+
+	[[nodiscard]] uint16 GetNodeGoal(const uint16 node) const { return nodeGoal[node]; }
+
+	/**
+	 * \brief Returns the index of the task inside it's start goal.
+	 */
+	[[nodiscard]] uint16 GetNodeGoalTask(const uint16 node) const { return nodeGoalTask[node]; }
+
+	[[nodiscard]] uint16 GetNodeTargetGoal(const uint16 node) const { return nodeTargetGoal[node]; }
+
+	[[nodiscard]] TaskPriority GetNodePriority(const uint16 node) const { return nodePriority[node]; }
+
+	[[nodiscard]] GTSL::Ranger<const uint16> GetNodeAccessedObjects(const uint16 node) const { return nodeAccessedObjects[node]; }
+
+	[[nodiscard]] GTSL::Ranger<const AccessType> GetNodeAccessTypes(const uint16 node) const { return nodeAccessTypes[node]; }
+
+	[[nodiscard]] GTSL::Ranger<const uint16> GetNodeSuccessors(const uint16 node) const { return nodeSuccessors[node]; }
+
+	/**
+	 * \brief Returns the number of nodes which have to finish before this node can run, plus one for the start of the node's goal.
+	 */
+	[[nodiscard]] GTSL::Ranger<const uint16> GetDependencyCounts() const { return nodeDependencyCount; }
+
+	/**
+	 * \brief Returns the nodes of the next frame which have to wait for this node when frames overlap.
+	 */
+	[[nodiscard]] GTSL::Ranger<const uint16> GetNodeFrameSuccessors(const uint16 node) const { return nodeFrameSuccessors[node]; }
+
+	/**
+	 * \brief Returns the number of nodes of the previous frame which have to finish before this node can run when frames overlap.
+	 */
+	[[nodiscard]] GTSL::Ranger<const uint16> GetFrameDependencyCounts() const { return nodeFrameDependencyCount; }
+
+	/**
+	 * \brief Returns the first node and one past the last node which start on a goal.
+	 */
+	[[nodiscard]] GTSL::Pair<uint16, uint16> GetGoalNodes(const uint16 goal) const { return GTSL::Pair<uint16, uint16>(goal ? goalNodesEnd[goal - 1] : 0, goalNodesEnd[goal]); }
+
+	/**
+	 * \brief Returns the nodes started in a previous goal which have to be done before a goal can start.
+	 */
+	[[nodiscard]] GTSL::Ranger<const uint16> GetGoalWaitNodes(const uint16 goal) const { return goalWaitNodes[goal]; }
+
+private:
+	GTSL::Vector<TASK, ALLOCATOR> nodeTasks;
+	GTSL::Vector<uint16, ALLOCATOR> nodeGoal;
+	GTSL::Vector<uint16, ALLOCATOR> nodeGoalTask;
+	GTSL::Vector<uint16, ALLOCATOR> nodeTargetGoal;
+	GTSL::Vector<TaskPriority, ALLOCATOR> nodePriority;
+	GTSL::Vector<GTSL::Array<uint16, 32>, ALLOCATOR> nodeAccessedObjects;
+	GTSL::Vector<GTSL::Array<AccessType, 32>, ALLOCATOR> nodeAccessTypes;
+	GTSL::Vector<GTSL::Vector<uint16, ALLOCATOR>, ALLOCATOR> nodeSuccessors;
+	GTSL::Vector<uint16, ALLOCATOR> nodeDependencyCount;
+	GTSL::Vector<GTSL::Vector<uint16, ALLOCATOR>, ALLOCATOR> nodeFrameSuccessors;
+	GTSL::Vector<uint16, ALLOCATOR> nodeFrameDependencyCount;
+
+	GTSL::Vector<uint16, ALLOCATOR> goalNodesEnd;
+	GTSL::Vector<GTSL::Vector<uint16, ALLOCATOR>, ALLOCATOR> goalWaitNodes;
+
+	[[nodiscard]] bool conflict(const uint16 a, const uint16 b) const
+	{
+		for (uint32 i = 0; i < nodeAccessedObjects[a].GetLength(); ++i)
+		{
+			for (uint32 j = 0; j < nodeAccessedObjects[b].GetLength(); ++j)
+			{
+				if (nodeAccessedObjects[a][i] != nodeAccessedObjects[b][j]) { continue; }
+				if (nodeAccessTypes[a][i] == AccessType::READ_WRITE || nodeAccessTypes[b][j] == AccessType::READ_WRITE) { return true; }
+			}
+		}
+
+		return false;
+	}
+};
+
+/**
+ * \brief Tracks which objects(systems) are being accessed by running tasks and how, to only let tasks run when none of their accesses conflict with those of running tasks.
+ * The state of every object is a single atomic word holding the number of readers and a writer bit, a task's whole access set is acquired
+ * by CAS-ing each word in object order and rolled back if any of them conflicts, so no lock is ever taken.
+ */
+template<class ALLOCATOR>
+struct TaskSorter
+{
+	explicit TaskSorter(const uint32 num, const ALLOCATOR& allocator) : allocator(allocator), maxObjects(num)
+	{
+		uint64 allocatedSize{ 0 };
+		this->allocator.Allocate(sizeof(std::atomic<uint32>) * maxObjects, alignof(std::atomic<uint32>), reinterpret_cast<void**>(&objectStates), &allocatedSize);
+		for (uint32 i = 0; i < maxObjects; ++i) { ::new(objectStates + i) std::atomic<uint32>(0); }
+	}
+
+	~TaskSorter()
+	{
+		allocator.Deallocate(sizeof(std::atomic<uint32>) * maxObjects, alignof(std::atomic<uint32>), objectStates);
+	}
+
+	GTSL::Result<uint32> CanRunTask(const GTSL::Ranger<const uint16> objects, const GTSL::Ranger<const AccessType> accesses)
+	{
+		BE_ASSERT(objects.ElementCount() == accesses.ElementCount(), "Bad data, shold be equal");
+
+		OngoingTask task;
+
+		//sort by object so that competing tasks acquire in the same order, merge repeated objects keeping the strongest access
+		for (uint32 i = 0; i < objects.ElementCount(); ++i)
 		{
-			BE_ASSERT(currentObjectAccessCount[objects[i]] != 0, "Oops :/");
-			BE_ASSERT(accesses[i] == AccessType::READ || accesses[i] == AccessType::READ_WRITE, "Unexpected value");
-			if (--currentObjectAccessCount[objects[i]] == 0) //if task is done
+			uint32 j = 0; while (j < task.Objects.GetLength() && task.Objects[j] < objects[i]) { ++j; }
+
+			if (j < task.Objects.GetLength() && task.Objects[j] == objects[i])
 			{
-				currentObjectAccessState[objects[i]] = 0;
+				if (accesses[i] == AccessType::READ_WRITE) { task.Accesses[j] = AccessType::READ_WRITE; }
+				continue;
 			}
 
+			task.Objects.EmplaceBack(0); task.Accesses.EmplaceBack(0);
+			for (uint32 k = task.Objects.GetLength() - 1; k > j; --k) { task.Objects[k] = task.Objects[k - 1]; task.Accesses[k] = task.Accesses[k - 1]; }
+			task.Objects[j] = objects[i]; task.Accesses[j] = accesses[i];
 		}
-		
-		ongoingTasksAccesses.Pop(taskIndex); ongoingTasksObjects.Pop(taskIndex);
+
+		uint32 acquired = 0;
+		while (acquired < task.Objects.GetLength() && tryAcquire(task.Objects[acquired], task.Accesses[acquired])) { ++acquired; }
+
+		if (acquired != task.Objects.GetLength())
+		{
+			while (acquired--) { release(task.Objects[acquired], task.Accesses[acquired]); }
+			return false;
+		}
+
+		auto i = allocateTaskSlot();
+
+		if (i == MAX_ONGOING_TASKS) //every slot is held by a dispatched task, treated like a conflict so the caller tries again once some finish
+		{
+			while (acquired--) { release(task.Objects[acquired], task.Accesses[acquired]); }
+			return false;
+		}
+
+		ongoingTasks[i] = task;
+		return GTSL::Result<uint32>(GTSL::MoveRef(i), true);
+	}
+
+	void ReleaseResources(const uint32 taskIndex)
+	{
+		const auto& task = ongoingTasks[taskIndex];
+
+		for (uint32 i = task.Objects.GetLength(); i-- > 0;) { release(task.Objects[i], task.Accesses[i]); }
+
+		taskSlots[taskIndex / 64].fetch_and(~(1ull << (taskIndex % 64)), std::memory_order_release);
 	}
 
 	void AddSystem()
 	{
-		GTSL::WriteLock lock(mutex);
-		currentObjectAccessState.Emplace(0);
-		currentObjectAccessCount.Emplace(0);
+		const auto object = objectCount.fetch_add(1, std::memory_order_relaxed);
+		BE_ASSERT(object < maxObjects, "Too many systems for task sorter!")
+		objectStates[object].store(0, std::memory_order_release);
 	}
 
 private:
-	GTSL::KeepVector<AccessType::value_type, ALLOCATOR> currentObjectAccessState;
-	GTSL::KeepVector<uint16, ALLOCATOR> currentObjectAccessCount;
+	static constexpr uint32 WRITER_BIT = 1u << 31;
+	static constexpr uint32 MAX_ONGOING_TASKS = 512;
+
+	struct OngoingTask
+	{
+		GTSL::Array<uint16, 32> Objects;
+		GTSL::Array<AccessType, 32> Accesses;
+	};
+
+	ALLOCATOR allocator;
+	const uint32 maxObjects{ 0 };
+	std::atomic<uint32> objectCount{ 0 };
+
+	/**
+	 * \brief Per object number of readers, or WRITER_BIT if it's being written to.
+	 */
+	std::atomic<uint32>* objectStates{ nullptr };
+
+	/**
+	 * \brief Bitmask of used ongoingTasks slots.
+	 */
+	std::atomic<uint64> taskSlots[MAX_ONGOING_TASKS / 64]{};
+	OngoingTask ongoingTasks[MAX_ONGOING_TASKS];
+
+	bool tryAcquire(const uint16 object, const AccessType access)
+	{
+		auto& state = objectStates[object];
+
+		if (access == AccessType::READ_WRITE)
+		{
+			uint32 expected = 0;
+			return state.compare_exchange_strong(expected, WRITER_BIT, std::memory_order_acquire, std::memory_order_relaxed);
+		}
+
+		auto current = state.load(std::memory_order_relaxed);
+
+		do
+		{
+			if (current & WRITER_BIT) { return false; }
+		} while (!state.compare_exchange_weak(current, current + 1, std::memory_order_acquire, std::memory_order_relaxed));
+
+		return true;
+	}
+
+	void release(const uint16 object, const AccessType access)
+	{
+		BE_ASSERT(access == AccessType::READ || access == AccessType::READ_WRITE, "Unexpected value");
 
-	GTSL::KeepVector<GTSL::Array<AccessType, 64>, ALLOCATOR> ongoingTasksAccesses;
-	GTSL::KeepVector<GTSL::Array<uint16, 64>, ALLOCATOR> ongoingTasksObjects;
+		if (access == AccessType::READ_WRITE)
+		{
+			[[maybe_unused]] const auto previous = objectStates[object].fetch_sub(WRITER_BIT, std::memory_order_release);
+			BE_ASSERT(previous == WRITER_BIT, "Oops :/");
+		}
+		else
+		{
+			[[maybe_unused]] const auto previous = objectStates[object].fetch_sub(1, std::memory_order_release);
+			BE_ASSERT(previous != 0 && !(previous & WRITER_BIT), "Oops :/");
+		}
+	}
 
-	GTSL::ReadWriteMutex mutex;
-};
\ No newline at end of file
+	/**
+	 * \brief Returns a free slot in ongoingTasks, or MAX_ONGOING_TASKS if all of them are taken.
+	 */
+	uint32 allocateTaskSlot()
+	{
+		for (uint32 word = 0; word < MAX_ONGOING_TASKS / 64; ++word)
+		{
+			auto mask = taskSlots[word].load(std::memory_order_relaxed);
+
+			while (mask != ~0ull)
+			{
+				const uint32 bit = std::countr_one(mask);
+				if (taskSlots[word].compare_exchange_weak(mask, mask | (1ull << bit), std::memory_order_acquire, std::memory_order_relaxed)) { return word * 64 + bit; }
+			}
+		}
+
+		return MAX_ONGOING_TASKS;
+	}
+};
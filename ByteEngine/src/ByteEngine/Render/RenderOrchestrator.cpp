@@ -51,6 +51,8 @@ struct StaticMeshRenderManager : RenderOrchestrator::RenderManager
 				renderInfo.CommandBuffer->BindPipeline(bindPipelineInfo);
 				for (const auto& e : renderGroup->GetMeshes())
 				{
+					if (!e.IndicesCount) { continue; } //still loading
+					
 					CommandBuffer::BindVertexBufferInfo bindVertexInfo;
 					bindVertexInfo.RenderDevice = renderInfo.RenderSystem->GetRenderDevice();
 					bindVertexInfo.Buffer = &e.Buffer;
@@ -184,8 +186,8 @@ void RenderOrchestrator::Initialize(const InitializeInfo& initializeInfo)
 	
 	{
 		const GTSL::Array<TaskDependency, 4> dependencies{ { CLASS_NAME, AccessType::READ_WRITE } };
-		initializeInfo.GameInstance->AddTask(SETUP_TASK_NAME, GTSL::Delegate<void(TaskInfo)>::Create<RenderOrchestrator, &RenderOrchestrator::Setup>(this), dependencies, "GameplayEnd", "RenderStart");
-		initializeInfo.GameInstance->AddTask(RENDER_TASK_NAME, GTSL::Delegate<void(TaskInfo)>::Create<RenderOrchestrator, &RenderOrchestrator::Render>(this), dependencies, "RenderSetup", "RenderFinished");
+		initializeInfo.GameInstance->AddTask(SETUP_TASK_NAME, TaskPriority::HIGH, GTSL::Delegate<void(TaskInfo)>::Create<RenderOrchestrator, &RenderOrchestrator::Setup>(this), dependencies, "GameplayEnd", "RenderStart");
+		initializeInfo.GameInstance->AddTask(RENDER_TASK_NAME, TaskPriority::HIGH, GTSL::Delegate<void(TaskInfo)>::Create<RenderOrchestrator, &RenderOrchestrator::Render>(this), dependencies, "RenderSetup", "RenderFinished");
 	}
 
 	renderManagers.Initialize(16, GetPersistentAllocator());
@@ -312,8 +314,8 @@ void RenderOrchestrator::AddRenderGroup(GameInstance* gameInstance, Id renderGro
 	dependencies.EmplaceBack("MaterialSystem", AccessType::READ);
 	dependencies.EmplaceBack("FrameManager", AccessType::READ);
 
-	gameInstance->AddTask(SETUP_TASK_NAME, GTSL::Delegate<void(TaskInfo)>::Create<RenderOrchestrator, &RenderOrchestrator::Setup>(this), dependencies, "GameplayEnd", "RenderStart");
-	gameInstance->AddTask(RENDER_TASK_NAME, GTSL::Delegate<void(TaskInfo)>::Create<RenderOrchestrator, &RenderOrchestrator::Render>(this), dependencies, "RenderSetup", "RenderFinished");
+	gameInstance->AddTask(SETUP_TASK_NAME, TaskPriority::HIGH, GTSL::Delegate<void(TaskInfo)>::Create<RenderOrchestrator, &RenderOrchestrator::Setup>(this), dependencies, "GameplayEnd", "RenderStart");
+	gameInstance->AddTask(RENDER_TASK_NAME, TaskPriority::HIGH, GTSL::Delegate<void(TaskInfo)>::Create<RenderOrchestrator, &RenderOrchestrator::Render>(this), dependencies, "RenderSetup", "RenderFinished");
 }
 
 void RenderOrchestrator::RemoveRenderGroup(GameInstance* gameInstance, const Id renderGroupName)
@@ -339,6 +341,6 @@ void RenderOrchestrator::RemoveRenderGroup(GameInstance* gameInstance, const Id
 	dependencies.EmplaceBack("MaterialSystem", AccessType::READ);
 	dependencies.EmplaceBack("FrameManager", AccessType::READ);
 	
-	gameInstance->AddTask(SETUP_TASK_NAME, GTSL::Delegate<void(TaskInfo)>::Create<RenderOrchestrator, &RenderOrchestrator::Setup>(this), dependencies, "GameplayEnd", "RenderStart");
-	gameInstance->AddTask(RENDER_TASK_NAME, GTSL::Delegate<void(TaskInfo)>::Create<RenderOrchestrator, &RenderOrchestrator::Render>(this), dependencies, "RenderSetup", "RenderFinished");
+	gameInstance->AddTask(SETUP_TASK_NAME, TaskPriority::HIGH, GTSL::Delegate<void(TaskInfo)>::Create<RenderOrchestrator, &RenderOrchestrator::Setup>(this), dependencies, "GameplayEnd", "RenderStart");
+	gameInstance->AddTask(RENDER_TASK_NAME, TaskPriority::HIGH, GTSL::Delegate<void(TaskInfo)>::Create<RenderOrchestrator, &RenderOrchestrator::Render>(this), dependencies, "RenderSetup", "RenderFinished");
 }
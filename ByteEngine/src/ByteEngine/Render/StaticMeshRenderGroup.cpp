@@ -12,9 +12,11 @@ StaticMeshRenderGroup::StaticMeshRenderGroup()
 void StaticMeshRenderGroup::Initialize(const InitializeInfo& initializeInfo)
 {
 	auto render_device = initializeInfo.GameInstance->GetSystem<RenderSystem>("RenderSystem");
-	positions.Initialize(initializeInfo.ScalingFactor, GetPersistentAllocator());
-	meshes.Initialize(initializeInfo.ScalingFactor, GetPersistentAllocator()),
-	renderAllocations.Initialize(initializeInfo.ScalingFactor, GetPersistentAllocator());
+	instances.Initialize(initializeInfo.ScalingFactor, GetComponentAllocator());
+	positions.Initialize(initializeInfo.ScalingFactor, GetComponentAllocator());
+	resourceNames.Initialize(initializeInfo.ScalingFactor, GetComponentAllocator());
+	meshes.Initialize(initializeInfo.ScalingFactor, GetComponentAllocator());
+	renderAllocations.Initialize(initializeInfo.ScalingFactor, GetComponentAllocator());
 	
 	BE_LOG_MESSAGE("Initialized StaticMeshRenderGroup");
 }
@@ -23,14 +25,16 @@ void StaticMeshRenderGroup::Shutdown(const ShutdownInfo& shutdownInfo)
 {
 	RenderSystem* render_system = shutdownInfo.GameInstance->GetSystem<RenderSystem>("RenderSystem");
 	
-	for (auto& e : meshes)
+	for (uint32 i = 0; i < meshes.GetLength(); ++i)
 	{
-		e.Buffer.Destroy(render_system->GetRenderDevice());
+		if (!meshes[i].IndicesCount) { continue; }
+		
+		meshes[i].Buffer.Destroy(render_system->GetRenderDevice());
+		render_system->DeallocateLocalBufferMemory(renderAllocations[i]);
 	}
-	for (auto& e : renderAllocations) { render_system->DeallocateLocalBufferMemory(e); }
 }
 
-ComponentReference StaticMeshRenderGroup::AddStaticMesh(const AddStaticMeshInfo& addStaticMeshInfo)
+ComponentHandle StaticMeshRenderGroup::AddStaticMesh(const AddStaticMeshInfo& addStaticMeshInfo)
 {
 	uint32 bufferSize = 0, indicesOffset = 0; uint16 indexSize = 0;
 	addStaticMeshInfo.StaticMeshResourceManager->GetMeshSize(addStaticMeshInfo.MeshName, &indexSize, &indexSize, &bufferSize, &indicesOffset);
@@ -56,7 +60,13 @@ ComponentReference StaticMeshRenderGroup::AddStaticMesh(const AddStaticMeshInfo&
 	memoryAllocationInfo.Allocation = &allocation;
 	addStaticMeshInfo.RenderSystem->AllocateScratchBufferMemory(memoryAllocationInfo);
 	
-	auto* mesh_load_info = GTSL::New<MeshLoadInfo>(GetPersistentAllocator(), addStaticMeshInfo.RenderSystem, scratch_buffer, allocation, index);
+	const auto instance = instances.Emplace();
+	resourceNames.EmplaceBack(addStaticMeshInfo.MeshName);
+	positions.EmplaceBack();
+	meshes.EmplaceBack();
+	renderAllocations.EmplaceBack();
+	
+	auto* mesh_load_info = GTSL::New<MeshLoadInfo>(GetPersistentAllocator(), addStaticMeshInfo.RenderSystem, scratch_buffer, allocation, instance);
 
 	auto acts_on = GTSL::Array<TaskDependency, 16>{ { "RenderSystem", AccessType::READ_WRITE }, { "StaticMeshRenderGroup", AccessType::READ_WRITE } };
 	
@@ -69,11 +79,8 @@ ComponentReference StaticMeshRenderGroup::AddStaticMesh(const AddStaticMeshInfo&
 	load_static_meshInfo.ActsOn = acts_on;
 	load_static_meshInfo.GameInstance = addStaticMeshInfo.GameInstance;
 	addStaticMeshInfo.StaticMeshResourceManager->LoadStaticMesh(load_static_meshInfo);
-
-	resourceNames.EmplaceBack(addStaticMeshInfo.MeshName);
-	positions.EmplaceBack();
 	
-	return index++;
+	return instance;
 }
 
 void StaticMeshRenderGroup::onStaticMeshLoaded(TaskInfo taskInfo, StaticMeshResourceManager::OnStaticMeshLoad onStaticMeshLoad)
@@ -118,10 +125,11 @@ void StaticMeshRenderGroup::onStaticMeshLoaded(TaskInfo taskInfo, StaticMeshReso
 		mesh.IndicesOffset = onStaticMeshLoad.IndicesOffset;
 		mesh.Buffer = deviceBuffer;
 		
-		meshes.Insert(loadInfo->InstanceId, mesh);
+		//instance is looked up now since it's index may have changed while loading
+		const auto index = instances.GetIndex(loadInfo->Instance);
+		meshes[index] = mesh;
+		renderAllocations[index] = allocation;
 	}
-	
-	renderAllocations.Insert(loadInfo->InstanceId, loadInfo->Allocation);
 
 	GTSL::Delete(loadInfo, GetPersistentAllocator());
 }
\ No newline at end of file
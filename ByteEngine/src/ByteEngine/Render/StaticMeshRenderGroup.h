@@ -7,6 +7,7 @@
 
 #include "RenderTypes.h"
 #include "ByteEngine/Resources/MaterialResourceManager.h"
+#include "ByteEngine/Game/SlotMap.h"
 
 class RenderSystem;
 
@@ -25,46 +26,59 @@ public:
 		class GameInstance* GameInstance = nullptr;
 		StaticMeshResourceManager* StaticMeshResourceManager = nullptr;
 	};
-	ComponentReference AddStaticMesh(const AddStaticMeshInfo& addStaticMeshInfo);
+	ComponentHandle AddStaticMesh(const AddStaticMeshInfo& addStaticMeshInfo);
+
+	/**
+	 * \brief Bytes one static mesh takes across all arrays, for declaring the system's memory budget.
+	 */
+	static constexpr uint32 GetBytesPerComponent() { return sizeof(Mesh) + sizeof(RenderAllocation) + sizeof(GTSL::Id64) + sizeof(GTSL::Vector3) + SlotMap<BE::ComponentAllocatorReference>::BYTES_PER_HANDLE; }
+
+	[[nodiscard]] bool IsStaticMeshValid(const ComponentHandle component) const { return instances.IsValid(component); }
 
 	[[nodiscard]] GTSL::Ranger<GTSL::Vector3> GetPositions() const { return positions; }
 	[[nodiscard]] GTSL::Ranger<const GTSL::Id64> GetResourceNames() const { return resourceNames; }
 
-	void SetPosition(ComponentReference component, GTSL::Vector3 vector3) { positions[component] = vector3; }
+	void SetPosition(ComponentHandle component, GTSL::Vector3 vector3) { positions[instances.GetIndex(component)] = vector3; }
 
 	
 	
 private:
 	struct MeshLoadInfo
 	{
-		MeshLoadInfo(RenderSystem* renderDevice, const Buffer& buffer, RenderAllocation renderAllocation, uint32 instance) : RenderSystem(renderDevice), ScratchBuffer(buffer),
-		Allocation(renderAllocation), InstanceId(instance)
+		MeshLoadInfo(RenderSystem* renderDevice, const Buffer& buffer, RenderAllocation renderAllocation, ComponentHandle instance) : RenderSystem(renderDevice), ScratchBuffer(buffer),
+		Allocation(renderAllocation), Instance(instance)
 		{
 		}
 		
 		RenderSystem* RenderSystem = nullptr;
 		Buffer ScratchBuffer;
 		RenderAllocation Allocation;
-		uint32 InstanceId;
+		ComponentHandle Instance;
 	};
 	
 	void onStaticMeshLoaded(TaskInfo taskInfo, StaticMeshResourceManager::OnStaticMeshLoad onStaticMeshLoad);
 
-	uint32 index = 0;
-
 	struct Mesh
 	{
 		Buffer Buffer;
-		uint32 IndicesOffset;
-		uint32 IndicesCount;
+		uint32 IndicesOffset = 0;
+		/**
+		 * \brief 0 while the mesh is still loading, such meshes are skipped when rendering.
+		 */
+		uint32 IndicesCount = 0;
 		IndexType IndexType;
 	};
+
+	/**
+	 * \brief Maps static mesh handles to their index in the arrays below, which are parallel and packed.
+	 */
+	SlotMap<BE::ComponentAllocatorReference> instances;
 	
-	GTSL::Vector<Mesh, BE::PersistentAllocatorReference> meshes;
-	GTSL::Vector<RenderAllocation, BE::PersistentAllocatorReference> renderAllocations;
+	GTSL::Vector<Mesh, BE::ComponentAllocatorReference> meshes;
+	GTSL::Vector<RenderAllocation, BE::ComponentAllocatorReference> renderAllocations;
 
-	GTSL::Array<GTSL::Id64, 16> resourceNames;
-	GTSL::Vector<GTSL::Vector3, BE::PersistentAllocatorReference> positions;
+	GTSL::Vector<GTSL::Id64, BE::ComponentAllocatorReference> resourceNames;
+	GTSL::Vector<GTSL::Vector3, BE::ComponentAllocatorReference> positions;
 public:
 	GTSL::Ranger<const Mesh> GetMeshes() const { return meshes; }
 };
@@ -7,7 +7,7 @@
 
 void TextSystem::Initialize(const InitializeInfo& initializeInfo)
 {
-	components.Initialize(initializeInfo.ScalingFactor, GetPersistentAllocator());
+	components.Initialize(initializeInfo.ScalingFactor, GetComponentAllocator());
 
 	{
 		MaterialSystem::AddRenderGroupInfo addRenderGroupInfo;
@@ -30,8 +30,13 @@ public:
 		GTSL::StaticString<64> String;
 	};
 	GTSL::Ranger<const Text> GetTexts() const { return components; }
+
+	/**
+	 * \brief Bytes one text takes, for declaring the system's memory budget.
+	 */
+	static constexpr uint32 GetBytesPerComponent() { return sizeof(Text); }
 private:
-	Vector<Text> components;
+	Vector<Text, BE::ComponentAllocatorReference> components;
 
 	FontResourceManager::Font renderingFont;
 };
@@ -7,7 +7,7 @@
 
 void TextureSystem::Initialize(const InitializeInfo& initializeInfo)
 {
-	textures.Initialize(initializeInfo.ScalingFactor, GetPersistentAllocator());
+	textures.Initialize(initializeInfo.ScalingFactor, GetComponentAllocator());
 
 	BE_LOG_MESSAGE("Initialized TextureSystem")
 }
@@ -29,6 +29,11 @@ public:
 		TextureResourceManager* TextureResourceManager = nullptr;
 	};
 	ComponentReference CreateTexture(const CreateTextureInfo& info);
+
+	/**
+	 * \brief Bytes one texture takes, for declaring the system's memory budget.
+	 */
+	static constexpr uint32 GetBytesPerComponent() { return sizeof(TextureComponent); }
 	
 private:
 	struct LoadInfo
@@ -53,5 +58,5 @@ private:
 		TextureSampler TextureSampler;
 		RenderAllocation Allocation;
 	};
-	Vector<TextureComponent> textures;
+	Vector<TextureComponent, BE::ComponentAllocatorReference> textures;
 };
@@ -0,0 +1,138 @@
+#include "AssetCooker.h"
+
+#include <cstring>
+
+#include <GTSL/Serialize.h>
+
+#if defined(BE_PLATFORM_WIN)
+#include <Windows.h>
+#elif defined(BE_PLATFORM_LINUX)
+#include <cstdio>
+#include <sys/stat.h>
+#endif
+
+AssetCache::AssetCache(const UTF8* name, const GTSL::StaticString<512>& packagePath) : Object(name), packagePath(packagePath), records(16, GetPersistentAllocator())
+{
+}
+
+bool AssetCache::ExtractRecords(GTSL::Buffer& buffer)
+{
+	uint32 version = 0; GTSL::Extract(version, buffer);
+	if (version != INDEX_VERSION) { return false; }
+
+	uint64 expectedPackageSize = 0, currentPackageSize = 0, modificationTime = 0;
+	GTSL::Extract(expectedPackageSize, buffer);
+
+	//a package which was rebuilt or lost since the index was written can't be trusted to hold what the records say
+	if (!getSourceStamp(packagePath.begin(), &modificationTime, &currentPackageSize) || currentPackageSize != expectedPackageSize) { return false; }
+
+	GTSL::Extract(records, buffer);
+
+	packageSize = expectedPackageSize;
+	hasIndex = true;
+	return true;
+}
+
+void AssetCache::InsertRecords(GTSL::Buffer& buffer) const
+{
+	GTSL::Insert(INDEX_VERSION, buffer);
+	GTSL::Insert(packageSize, buffer);
+	GTSL::Insert(records, buffer);
+}
+
+namespace
+{
+	constexpr uint64 PRIME_1 = 0x9E3779B185EBCA87ull, PRIME_2 = 0xC2B2AE3D27D4EB4Full, PRIME_3 = 0x165667B19E3779F9ull, PRIME_4 = 0x85EBCA77C2B2AE63ull, PRIME_5 = 0x27D4EB2F165667C5ull;
+
+	uint64 rotateLeft(const uint64 value, const uint8 bits) { return (value << bits) | (value >> (64 - bits)); }
+
+	uint64 read64(const byte* data) { uint64 value; std::memcpy(&value, data, 8); return value; }
+	uint32 read32(const byte* data) { uint32 value; std::memcpy(&value, data, 4); return value; }
+
+	uint64 accumulate(uint64 accumulator, const uint64 input) { accumulator += input * PRIME_2; return rotateLeft(accumulator, 31) * PRIME_1; }
+	uint64 mergeRound(uint64 accumulator, const uint64 value) { accumulator ^= accumulate(0, value); return accumulator * PRIME_1 + PRIME_4; }
+}
+
+uint64 AssetCache::HashContent(const byte* data, const uint64 size, const uint64 seed)
+{
+	//reads are little endian as every platform the engine runs on is
+	const byte* const end = data + size;
+	uint64 hash;
+
+	if (size >= 32)
+	{
+		uint64 v1 = seed + PRIME_1 + PRIME_2, v2 = seed + PRIME_2, v3 = seed, v4 = seed - PRIME_1;
+
+		for (const byte* const limit = end - 32; data <= limit; data += 32)
+		{
+			v1 = accumulate(v1, read64(data)); v2 = accumulate(v2, read64(data + 8)); v3 = accumulate(v3, read64(data + 16)); v4 = accumulate(v4, read64(data + 24));
+		}
+
+		hash = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+		hash = mergeRound(hash, v1); hash = mergeRound(hash, v2); hash = mergeRound(hash, v3); hash = mergeRound(hash, v4);
+	}
+	else
+	{
+		hash = seed + PRIME_5;
+	}
+
+	hash += size;
+
+	for (; data + 8 <= end; data += 8) { hash ^= accumulate(0, read64(data)); hash = rotateLeft(hash, 27) * PRIME_1 + PRIME_4; }
+	if (data + 4 <= end) { hash ^= read32(data) * PRIME_1; hash = rotateLeft(hash, 23) * PRIME_2 + PRIME_3; data += 4; }
+	for (; data < end; ++data) { hash ^= *data * PRIME_5; hash = rotateLeft(hash, 11) * PRIME_1; }
+
+	hash ^= hash >> 33; hash *= PRIME_2;
+	hash ^= hash >> 29; hash *= PRIME_3;
+	hash ^= hash >> 32;
+
+	return hash;
+}
+
+bool AssetCache::getSourceStamp(const char* path, uint64* modificationTime, uint64* size)
+{
+#if defined(BE_PLATFORM_WIN)
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	if (!GetFileAttributesExA(path, GetFileExInfoStandard, &attributes)) { return false; }
+	*modificationTime = static_cast<uint64>(attributes.ftLastWriteTime.dwHighDateTime) << 32 | attributes.ftLastWriteTime.dwLowDateTime;
+	*size = static_cast<uint64>(attributes.nFileSizeHigh) << 32 | attributes.nFileSizeLow;
+	return true;
+#elif defined(BE_PLATFORM_LINUX)
+	struct stat status;
+	if (stat(path, &status)) { return false; }
+	*modificationTime = static_cast<uint64>(status.st_mtim.tv_sec) * 1000000000ull + static_cast<uint64>(status.st_mtim.tv_nsec);
+	*size = static_cast<uint64>(status.st_size);
+	return true;
+#else
+#error "AssetCache can't stamp sources on this platform!"
+#endif
+}
+
+bool AssetCache::replaceFile(const char* from, const char* to)
+{
+#if defined(BE_PLATFORM_WIN)
+	return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#elif defined(BE_PLATFORM_LINUX)
+	return !std::rename(from, to);
+#else
+#error "AssetCache can't replace files on this platform!"
+#endif
+}
+
+void Insert(const AssetCache::AssetRecord& assetRecord, GTSL::Buffer& buffer)
+{
+	GTSL::Insert(assetRecord.PathHash, buffer);
+	GTSL::Insert(assetRecord.ModificationTime, buffer);
+	GTSL::Insert(assetRecord.SourceSize, buffer);
+	GTSL::Insert(assetRecord.ContentHash, buffer);
+	GTSL::Insert(assetRecord.CookedSize, buffer);
+}
+
+void Extract(AssetCache::AssetRecord& assetRecord, GTSL::Buffer& buffer)
+{
+	GTSL::Extract(assetRecord.PathHash, buffer);
+	GTSL::Extract(assetRecord.ModificationTime, buffer);
+	GTSL::Extract(assetRecord.SourceSize, buffer);
+	GTSL::Extract(assetRecord.ContentHash, buffer);
+	GTSL::Extract(assetRecord.CookedSize, buffer);
+}
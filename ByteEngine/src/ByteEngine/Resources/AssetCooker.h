@@ -0,0 +1,431 @@
+#pragma once
+
+#include "ByteEngine/Core.h"
+#include "ByteEngine/Object.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <GTSL/Buffer.h>
+#include <GTSL/Delegate.hpp>
+#include <GTSL/File.h>
+#include <GTSL/FlatHashMap.h>
+#include <GTSL/Id.h>
+#include <GTSL/StaticString.hpp>
+#include <GTSL/Vector.hpp>
+
+#include "ByteEngine/Application/Application.h"
+#include "ByteEngine/Application/ThreadPool.h"
+
+/**
+ * \brief Remembers what every asset in a package was cooked from, so a package can be brought up to date by cooking only the assets whose source changed.
+ * Records are stored at the start of the package's index, followed by the index's own entries.
+ */
+class AssetCache : public Object
+{
+public:
+	/**
+	 * \brief What an asset was last cooked from.
+	 */
+	struct AssetRecord
+	{
+		/**
+		 * \brief Hash of the source's path, assets are keyed by name so this tells if an asset now comes from another file.
+		 */
+		uint64 PathHash = 0;
+		uint64 ModificationTime = 0;
+		uint64 SourceSize = 0;
+		uint64 ContentHash = 0;
+		/**
+		 * \brief Bytes the asset takes in the package, starting at it's info's ByteOffset.
+		 */
+		uint32 CookedSize = 0;
+
+		/**
+		 * \brief Whether the asset's source was found this run, records of assets whose source is gone are dropped. Not serialized.
+		 */
+		bool Found = false;
+
+		friend void Insert(const AssetRecord& assetRecord, GTSL::Buffer& buffer);
+		friend void Extract(AssetRecord& assetRecord, GTSL::Buffer& buffer);
+	};
+
+	AssetCache(const UTF8* name, const GTSL::StaticString<512>& packagePath);
+
+	/**
+	 * \brief Extracts the records an index starts with. Returns false if the index can't be used, in which case the rest of it must not be extracted
+	 * and every asset is cooked again: the index was written by a build which didn't keep records or the package isn't the one the index was written for.
+	 */
+	bool ExtractRecords(GTSL::Buffer& buffer);
+	void InsertRecords(GTSL::Buffer& buffer) const;
+
+	/**
+	 * \brief 64 bit XXH64 hash of size bytes at data.
+	 */
+	static uint64 HashContent(const byte* data, uint64 size, uint64 seed = 0);
+
+protected:
+	static constexpr uint32 INDEX_VERSION = 0xBE1D0001;
+
+	GTSL::StaticString<512> packagePath;
+	uint64 packageSize = 0;
+
+	GTSL::FlatHashMap<AssetRecord, BE::PersistentAllocatorReference> records;
+	bool hasIndex = false;
+
+	/**
+	 * \brief Gets the last modification time and size of a file without opening it. Returns false if they can't be known, assets are then told apart by their content.
+	 */
+	static bool getSourceStamp(const char* path, uint64* modificationTime, uint64* size);
+
+	/**
+	 * \brief Replaces to with from, such that to is either the old or the new file if interrupted.
+	 */
+	static bool replaceFile(const char* from, const char* to);
+};
+
+/**
+ * \brief Cooks the source assets of a resource manager on the ThreadPool, so startup isn't bound by importing thousands of assets one after another.
+ * Assets are cooked in parallel but appended to the package one at a time in name order, so a package cooked from the same sources always comes out the same.
+ * Only a window of assets ahead of the one being appended is cooked at a time, to bound the memory held by cooked assets waiting to be written.
+ * The calling thread appends assets and runs cooking tasks while it waits. Logs progress and a timing report once done.
+ *
+ * When the package's index could be read(see ExtractRecords) only assets whose source changed are cooked. Sources whose modification time and size didn't change
+ * are skipped without being read, the rest are hashed and only cooked if their content changed. Assets cooked again are appended and their old copy, along with
+ * assets whose source was removed, is left as a hole in the package, which is compacted once holes take most of it.
+ * \tparam INFO Index entry of the asset type, must have a ByteOffset member which is set to the asset's position in the package.
+ */
+template<typename INFO>
+class AssetCooker : public AssetCache
+{
+public:
+	/**
+	 * \brief Cooks source into info and cooked, the bytes to append to the package, returns false if source couldn't be cooked.
+	 * Called from worker threads. cooked is allocated by the function with COOKED_ALIGNMENT from the allocator it's passed.
+	 */
+	using CookFunction = GTSL::Delegate<bool(const GTSL::Buffer&, INFO&, GTSL::Buffer&, const BE::PersistentAllocatorReference&)>;
+
+	static constexpr uint32 COOKED_ALIGNMENT = 32;
+
+	/**
+	 * \param assetType Plural name of the assets cooked, for progress messages.
+	 */
+	AssetCooker(const UTF8* name, const char* assetType, const GTSL::StaticString<512>& packagePath) : AssetCache(name, packagePath), assetType(assetType), assets(16, GetPersistentAllocator())
+	{
+	}
+
+	/**
+	 * \brief Adds a source asset, it will be cooked unless the package holds it already and it's source hasn't changed since. Must be called after ExtractRecords.
+	 */
+	void AddAsset(const GTSL::StaticString<512>& path, const GTSL::Id64 name)
+	{
+		uint64 modificationTime = 0, sourceSize = 0;
+		const bool stamped = getSourceStamp(path.begin(), &modificationTime, &sourceSize);
+		const uint64 pathHash = GTSL::Id64(path).GetHash();
+
+		bool hasRecord = false; uint64 previousHash = 0;
+
+		if (records.Find(name))
+		{
+			auto& record = records.At(name);
+			record.Found = true;
+
+			if (record.PathHash == pathHash)
+			{
+				if (stamped && record.ModificationTime == modificationTime && record.SourceSize == sourceSize) { return; }
+				hasRecord = true; previousHash = record.ContentHash;
+			}
+		}
+
+		assets.EmplaceBack(path, name, pathHash, modificationTime, sourceSize, hasRecord, previousHash);
+	}
+
+	/**
+	 * \brief Number of assets which will be checked and cooked if changed.
+	 */
+	[[nodiscard]] uint32 GetAssetCount() const { return assets.GetLength(); }
+
+	/**
+	 * \brief Brings the package up to date: drops assets whose source is gone, cooks every asset added whose content changed and appends it,
+	 * adding it's info to infos, and compacts the package if needed. Assets which fail to cook are left out.
+	 * \return Whether the package or the records changed, and so the index must be written again.
+	 */
+	template<class MAP>
+	bool Cook(const CookFunction cook, MAP& infos)
+	{
+		uint32 orphaned = 0;
+
+		{
+			GTSL::Vector<uint64, BE::PersistentAllocatorReference> orphans(8, GetPersistentAllocator());
+			GTSL::PairForEach(records, [&](const uint64 name, AssetRecord& record) { if (!record.Found) { orphans.EmplaceBack(name); } });
+
+			for (const auto name : orphans) { infos.Remove(name); records.Remove(name); }
+			orphaned = orphans.GetLength();
+		}
+
+		const uint32 assetCount = assets.GetLength();
+		const bool changed = !hasIndex || orphaned || assetCount;
+
+		if (assetCount)
+		{
+			GTSL::File package;
+			package.OpenFile(packagePath, static_cast<uint8>(GTSL::File::AccessMode::WRITE) | static_cast<uint8>(GTSL::File::AccessMode::READ),
+				hasIndex ? GTSL::File::OpenMode::LEAVE_CONTENTS : GTSL::File::OpenMode::CLEAR);
+			packageSize = package.GetFileSize();
+
+			cookAll(cook, package, infos);
+
+			package.CloseFile();
+		}
+
+		uint64 liveBytes = 0;
+		GTSL::PairForEach(records, [&](uint64, AssetRecord& record) { liveBytes += record.CookedSize; });
+
+		if (packageSize - liveBytes > liveBytes) { compact(infos, liveBytes); }
+
+		if (hasIndex) { BE_LOG_MESSAGE(assetCount, " ", assetType, " changed since the package was cooked, ", orphaned, " were removed.") }
+
+		return changed;
+	}
+
+private:
+	struct Asset
+	{
+		Asset(const GTSL::StaticString<512>& path, const GTSL::Id64 name, const uint64 pathHash, const uint64 modificationTime, const uint64 sourceSize, const bool hasRecord, const uint64 previousHash) :
+			Path(path), Name(name), PathHash(pathHash), ModificationTime(modificationTime), SourceSize(sourceSize), PreviousHash(previousHash), HasRecord(hasRecord) {}
+
+		GTSL::StaticString<512> Path;
+		GTSL::Id64 Name;
+		uint64 PathHash = 0, ModificationTime = 0, SourceSize = 0;
+		/**
+		 * \brief Content hash the asset was last cooked with, only valid if HasRecord.
+		 */
+		uint64 PreviousHash = 0;
+		bool HasRecord = false;
+	};
+
+	struct Job
+	{
+		INFO Info;
+		GTSL::Buffer Cooked;
+		uint64 ContentHash = 0;
+		uint64 Microseconds = 0;
+		bool Success = false;
+		/**
+		 * \brief The source was touched but it's content is the same as when it was last cooked, so it wasn't cooked.
+		 */
+		bool Unchanged = false;
+		/**
+		 * \brief Set once the job's results can be read. The job might be destroyed right after, so cooking tasks never wait or notify on it.
+		 */
+		std::atomic<bool> Done{ false };
+	};
+
+	const char* assetType = nullptr;
+	GTSL::Vector<Asset, BE::PersistentAllocatorReference> assets;
+	CookFunction cookFunction;
+
+	/**
+	 * \brief One per asset, constructed when the asset's cooking is enqueued and destroyed once it has been appended.
+	 */
+	Job* jobs = nullptr;
+
+	/**
+	 * \brief Raised by every cooking task once it's job is done, the appending thread waits on it instead of on the job.
+	 */
+	std::atomic<uint32> doneJobs{ 0 };
+	/**
+	 * \brief Raised by every cooking task as the last thing it does, jobs aren't freed until every enqueued task has let go of the cooker.
+	 */
+	std::atomic<uint32> exitedJobs{ 0 };
+
+	static uint64 now() { return static_cast<uint64>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count()); }
+
+	template<class MAP>
+	void cookAll(const CookFunction cook, GTSL::File& package, MAP& infos)
+	{
+		const uint32 assetCount = assets.GetLength();
+
+		std::sort(assets.begin(), assets.end(), [](const Asset& a, const Asset& b) { return a.Name.GetHash() < b.Name.GetHash(); });
+
+		cookFunction = cook;
+		doneJobs.store(0, std::memory_order_relaxed); exitedJobs.store(0, std::memory_order_relaxed);
+
+		uint64 allocatedSize{ 0 };
+		GetPersistentAllocator().Allocate(sizeof(Job) * assetCount, alignof(Job), reinterpret_cast<void**>(&jobs), &allocatedSize);
+
+		auto* threadPool = BE::Application::Get()->GetThreadPool();
+		const uint32 window = ThreadPool::GetNumberOfThreads() * 2u + 2u;
+
+		auto cookTask = [](AssetCooker* cooker, const uint32 asset) -> void { cooker->cookAsset(asset); };
+
+		auto enqueue = [&](uint32 asset)
+		{
+			::new(jobs + asset) Job();
+			threadPool->EnqueueTask(GTSL::Delegate<void(AssetCooker*, uint32)>::Create(cookTask), nullptr, this, GTSL::MoveRef(asset));
+		};
+
+		const uint64 start = now();
+		uint64 cookMicroseconds = 0, slowestMicroseconds = 0; uint32 slowest = 0, failed = 0, unchanged = 0;
+
+		for (uint32 i = 0; i < assetCount && i < window; ++i) { enqueue(i); }
+
+		for (uint32 i = 0; i < assetCount; ++i)
+		{
+			auto& job = jobs[i];
+			const auto& asset = assets[i];
+
+			while (!job.Done.load(std::memory_order_acquire))
+			{
+				if (!threadPool->TryRunTask())
+				{
+					//a job finishing after the count is read raises it, so the wait can't miss it
+					const auto done = doneJobs.load(std::memory_order_acquire);
+					if (!job.Done.load(std::memory_order_acquire)) { doneJobs.wait(done, std::memory_order_acquire); }
+				}
+			}
+
+			if (job.Unchanged)
+			{
+				auto& record = records.At(asset.Name);
+				record.ModificationTime = asset.ModificationTime; record.SourceSize = asset.SourceSize;
+				++unchanged;
+			}
+			else if (job.Success)
+			{
+				job.Info.ByteOffset = static_cast<uint32>(packageSize);
+				package.SetPointer(packageSize, GTSL::File::MoveFrom::BEGIN);
+				package.WriteToFile(GTSL::Ranger<byte>(job.Cooked.GetLength(), job.Cooked.GetData()));
+				packageSize += job.Cooked.GetLength();
+
+				AssetRecord record;
+				record.PathHash = asset.PathHash; record.ModificationTime = asset.ModificationTime; record.SourceSize = asset.SourceSize;
+				record.ContentHash = job.ContentHash; record.CookedSize = static_cast<uint32>(job.Cooked.GetLength()); record.Found = true;
+
+				//a previous copy of the asset is left as a hole in the package
+				if (records.Find(asset.Name)) { records.At(asset.Name) = record; } else { records.Emplace(asset.Name, record); }
+				if (infos.Find(asset.Name)) { infos.At(asset.Name) = job.Info; } else { infos.Emplace(asset.Name, job.Info); }
+			}
+			else
+			{
+				BE_LOG_WARNING("Couldn't cook ", asset.Path.begin(), ", it will not be available!")
+				++failed;
+
+				//don't keep serving a copy cooked from an older source, with no record it will be cooked again next time
+				if (records.Find(asset.Name)) { records.Remove(asset.Name); infos.Remove(asset.Name); }
+			}
+
+			cookMicroseconds += job.Microseconds;
+			if (job.Microseconds > slowestMicroseconds) { slowestMicroseconds = job.Microseconds; slowest = i; }
+
+			if (job.Cooked.GetData()) { job.Cooked.Free(COOKED_ALIGNMENT, GetPersistentAllocator()); }
+			job.~Job();
+
+			if (i + window < assetCount) { enqueue(i + window); }
+
+			if ((i + 1) * 10 / assetCount != i * 10 / assetCount) { BE_LOG_MESSAGE("Cooked ", i + 1, " of ", assetCount, " ", assetType) }
+		}
+
+		const uint64 wallMicroseconds = now() - start;
+
+		BE_LOG_SUCCESS("Cooked ", assetCount - failed - unchanged, " ", assetType, " in ", wallMicroseconds / 1000, " ms, ", cookMicroseconds / 1000, " ms of cooking across ",
+			ThreadPool::GetNumberOfThreads() + 1, " threads. Slowest: ", assets[slowest].Path.begin(), ", ", slowestMicroseconds / 1000, " ms.")
+		if (unchanged) { BE_LOG_MESSAGE(unchanged, " ", assetType, " were touched but their content didn't change, they weren't cooked.") }
+		if (failed) { BE_LOG_WARNING(failed, " ", assetType, " failed to cook.") }
+
+		//every job is done, but their tasks might still be notifying
+		while (exitedJobs.load(std::memory_order_acquire) != assetCount) { std::this_thread::yield(); }
+
+		GetPersistentAllocator().Deallocate(sizeof(Job) * assetCount, alignof(Job), jobs);
+		jobs = nullptr;
+	}
+
+	void cookAsset(const uint32 asset)
+	{
+		auto& job = jobs[asset];
+		const uint64 start = now();
+
+		GTSL::File sourceFile;
+		sourceFile.OpenFile(assets[asset].Path, static_cast<uint8>(GTSL::File::AccessMode::READ), GTSL::File::OpenMode::LEAVE_CONTENTS);
+
+		if (const uint64 sourceSize = sourceFile.GetFileSize())
+		{
+			GTSL::Buffer source; source.Allocate(static_cast<uint32>(sourceSize), COOKED_ALIGNMENT, GetPersistentAllocator());
+
+			if (sourceFile.ReadFile(source))
+			{
+				job.ContentHash = HashContent(source.GetData(), source.GetLength());
+
+				if (assets[asset].HasRecord && job.ContentHash == assets[asset].PreviousHash) { job.Unchanged = true; }
+				else { job.Success = cookFunction(source, job.Info, job.Cooked, GetPersistentAllocator()); }
+			}
+
+			source.Free(COOKED_ALIGNMENT, GetPersistentAllocator());
+		}
+
+		sourceFile.CloseFile();
+
+		job.Microseconds = now() - start;
+		job.Done.store(true, std::memory_order_release);
+
+		doneJobs.fetch_add(1, std::memory_order_release); doneJobs.notify_all();
+		exitedJobs.fetch_add(1, std::memory_order_release);
+	}
+
+	/**
+	 * \brief Rewrites the package with only the assets which have a record, in the order they are in the package, and moves their infos to their new offsets.
+	 * The package is read whole, compaction only happens once most of it are holes so it's at most twice the size of the live assets.
+	 */
+	template<class MAP>
+	void compact(MAP& infos, const uint64 liveBytes)
+	{
+		struct Region
+		{
+			Region(const uint64 name, const uint32 byteOffset, const uint32 size) : Name(name), ByteOffset(byteOffset), Size(size) {}
+
+			uint64 Name; uint32 ByteOffset, Size;
+		};
+
+		GTSL::Vector<Region, BE::PersistentAllocatorReference> regions(16, GetPersistentAllocator());
+		GTSL::PairForEach(records, [&](const uint64 name, AssetRecord& record) { regions.EmplaceBack(name, infos.At(name).ByteOffset, record.CookedSize); });
+		std::sort(regions.begin(), regions.end(), [](const Region& a, const Region& b) { return a.ByteOffset < b.ByteOffset; });
+
+		GTSL::File package;
+		package.OpenFile(packagePath, static_cast<uint8>(GTSL::File::AccessMode::READ), GTSL::File::OpenMode::LEAVE_CONTENTS);
+
+		GTSL::Buffer contents; contents.Allocate(static_cast<uint32>(packageSize), COOKED_ALIGNMENT, GetTransientAllocator());
+		const bool read = package.ReadFile(contents) == packageSize;
+		package.CloseFile();
+
+		if (!read)
+		{
+			BE_LOG_WARNING("Couldn't read ", assetType, " package to compact it!")
+			contents.Free(COOKED_ALIGNMENT, GetTransientAllocator());
+			return;
+		}
+
+		GTSL::StaticString<512> compactedPath; compactedPath += packagePath; compactedPath += ".compacted";
+
+		GTSL::File compacted;
+		compacted.OpenFile(compactedPath, static_cast<uint8>(GTSL::File::AccessMode::WRITE), GTSL::File::OpenMode::CLEAR);
+
+		for (const auto& region : regions) { compacted.WriteToFile(GTSL::Ranger<byte>(region.Size, contents.GetData() + region.ByteOffset)); }
+
+		compacted.CloseFile();
+		contents.Free(COOKED_ALIGNMENT, GetTransientAllocator());
+
+		if (!replaceFile(compactedPath.begin(), packagePath.begin()))
+		{
+			BE_LOG_WARNING("Couldn't replace ", assetType, " package with it's compacted copy!")
+			return;
+		}
+
+		uint32 byteOffset = 0;
+		for (const auto& region : regions) { infos.At(region.Name).ByteOffset = byteOffset; byteOffset += region.Size; }
+
+		BE_LOG_MESSAGE("Compacted ", assetType, " package from ", packageSize, " to ", liveBytes, " bytes.")
+		packageSize = liveBytes;
+	}
+};
@@ -144,12 +144,11 @@ void Extract(AudioResourceManager::AudioResourceInfo& audioResourceInfo, GTSL::B
 
 void AudioResourceManager::LoadAudioAsset(const LoadAudioAssetInfo& loadAudioAssetInfo)
 {
-	auto& audio_resource_info = audioResourceInfos.At(loadAudioAssetInfo.Name);
+	[[maybe_unused]] const auto& audio_resource_info = audioResourceInfos.At(loadAudioAssetInfo.Name);
 	
 	if(!audioAssets.Find(loadAudioAssetInfo.Name))
 	{
-		indexFile.SetPointer(audio_resource_info.ByteOffset, GTSL::File::MoveFrom::BEGIN);
-		//packageFile.ReadFromFile()
+		//to be read at audio_resource_info.ByteOffset through the IOService like other resources, moving a shared file pointer isn't safe with concurrent loads
 	}
 
 	//handle resource is loaded
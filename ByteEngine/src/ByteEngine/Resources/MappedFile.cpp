@@ -0,0 +1,83 @@
+#include "MappedFile.h"
+
+#include "ByteEngine/Debug/Assert.h"
+
+#if defined(BE_PLATFORM_WIN)
+#include <Windows.h>
+#elif defined(BE_PLATFORM_LINUX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool MappedFile::Open(const char* path)
+{
+	Close();
+
+#if defined(BE_PLATFORM_WIN)
+	fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE) { fileHandle = nullptr; return false; }
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize) || !fileSize.QuadPart) { Close(); return false; }
+
+	mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mappingHandle) { Close(); return false; }
+
+	data = static_cast<byte*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (!data) { Close(); return false; }
+
+	size = static_cast<uint64>(fileSize.QuadPart);
+	return true;
+#elif defined(BE_PLATFORM_LINUX)
+	const int file = open(path, O_RDONLY);
+	if (file == -1) { return false; }
+
+	struct stat fileStat;
+	if (fstat(file, &fileStat) == -1 || !fileStat.st_size) { close(file); return false; }
+
+	void* mapping = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_SHARED, file, 0);
+	close(file); //the mapping keeps the file alive
+
+	if (mapping == MAP_FAILED) { return false; }
+
+	//loads jump around the package, don't let the kernel read ahead more than is asked for
+	madvise(mapping, static_cast<size_t>(fileStat.st_size), MADV_RANDOM);
+
+	data = static_cast<byte*>(mapping); size = static_cast<uint64>(fileStat.st_size);
+	return true;
+#else
+	return false;
+#endif
+}
+
+void MappedFile::Close()
+{
+#if defined(BE_PLATFORM_WIN)
+	if (data) { UnmapViewOfFile(data); }
+	if (mappingHandle) { CloseHandle(mappingHandle); }
+	if (fileHandle) { CloseHandle(fileHandle); }
+	mappingHandle = nullptr; fileHandle = nullptr;
+#elif defined(BE_PLATFORM_LINUX)
+	if (data) { munmap(data, size); }
+#endif
+
+	data = nullptr; size = 0;
+}
+
+void MappedFile::Prefetch(const uint64 offset, const uint64 rangeSize) const
+{
+	if (!data) { return; }
+
+	BE_ASSERT(offset + rangeSize <= size, "Prefetch range is outside of the file!")
+
+#if defined(BE_PLATFORM_WIN)
+	WIN32_MEMORY_RANGE_ENTRY range{ data + offset, static_cast<SIZE_T>(rangeSize) };
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#elif defined(BE_PLATFORM_LINUX)
+	//madvise wants a page aligned address
+	const uint64 pageOffset = offset & ~static_cast<uint64>(4095);
+	madvise(data + pageOffset, static_cast<size_t>(rangeSize + (offset - pageOffset)), MADV_WILLNEED);
+#endif
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "ByteEngine/Core.h"
+
+#include <GTSL/Ranger.h>
+
+/**
+ * \brief Read only view of a whole file mapped into memory. Reads are plain memory accesses, so any number of threads can read at once without a shared file pointer,
+ * and pages are shared with the OS' file cache instead of being copied through read calls.
+ * Resource managers map their packages after cooking them, loads are read through the IOService into the caller's buffers while the mapping is used to
+ * hint upcoming loads to the OS, warming the same file cache those reads are served from, and to hand out assets in place to callers which can consume them from there.
+ */
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile() { Close(); }
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	/**
+	 * \return Whether the file could be mapped. Empty files can't be mapped.
+	 */
+	bool Open(const char* path);
+	void Close();
+
+	[[nodiscard]] bool IsOpen() const { return data; }
+
+	[[nodiscard]] const byte* GetData() const { return data; }
+	[[nodiscard]] uint64 GetSize() const { return size; }
+
+	[[nodiscard]] GTSL::Ranger<const byte> GetRange(const uint64 offset, const uint64 rangeSize) const { return GTSL::Ranger<const byte>(rangeSize, data + offset); }
+
+	/**
+	 * \brief Hints the OS to start reading a range from disk because it's going to be accessed soon, returns without waiting for it. Does nothing if the file isn't mapped.
+	 */
+	void Prefetch(uint64 offset, uint64 rangeSize) const;
+
+private:
+	byte* data{ nullptr };
+	uint64 size{ 0 };
+
+#ifdef BE_PLATFORM_WIN
+	void* fileHandle{ nullptr };
+	void* mappingHandle{ nullptr };
+#endif
+};
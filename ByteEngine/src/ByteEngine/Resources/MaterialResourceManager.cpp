@@ -25,6 +25,8 @@ MaterialResourceManager::MaterialResourceManager() : ResourceManager("MaterialRe
 
 	resources_path += "Materials.bepkg";
 	package.OpenFile(resources_path, (uint8)GTSL::File::AccessMode::READ | (uint8)GTSL::File::AccessMode::WRITE, GTSL::File::OpenMode::LEAVE_CONTENTS);
+	packageReadHandle = IOService::OpenFile(resources_path.begin());
+	if (packageReadHandle == IOService::INVALID_FILE) { BE_LOG_WARNING("Couldn't open material package for reading, no materials can be loaded!") }
 
 	resources_path.Drop(resources_path.FindLast('/') + 1);
 	resources_path += "Materials.beidx";
@@ -42,12 +44,15 @@ MaterialResourceManager::MaterialResourceManager() : ResourceManager("MaterialRe
 
 MaterialResourceManager::~MaterialResourceManager()
 {
-	package.CloseFile(); index.CloseFile();
+	IOService::CloseFile(packageReadHandle); package.CloseFile(); index.CloseFile();
 }
 
 void MaterialResourceManager::CreateMaterial(const MaterialCreateInfo& materialCreateInfo)
 {
 	const auto hashed_name = GTSL::Id64(materialCreateInfo.ShaderName);
+
+	//only one material is cooked at a time, it's shaders are appended to the package and the index is rewritten
+	GTSL::Lock createLock(createMutex);
 	
 	if (!materialInfos.Find(hashed_name))
 	{
@@ -125,7 +130,11 @@ void MaterialResourceManager::CreateMaterial(const MaterialCreateInfo& materialC
 			}
 		}
 		
-		materialInfos.Emplace(hashed_name, materialInfo);
+		{
+			GTSL::WriteLock lock(mutex);
+			materialInfos.Emplace(hashed_name, materialInfo);
+		}
+
 		index.SetPointer(0, GTSL::File::MoveFrom::BEGIN);
 		Insert(materialInfos, index_buffer);
 		index.WriteToFile(index_buffer);
@@ -146,7 +155,12 @@ void MaterialResourceManager::GetMaterialSize(const GTSL::Id64 name, uint32& siz
 
 void MaterialResourceManager::LoadMaterial(const MaterialLoadInfo& loadInfo)
 {
-	auto materialInfo = materialInfos.At(loadInfo.Name);
+	MaterialInfo materialInfo;
+
+	{
+		GTSL::ReadLock lock(mutex);
+		materialInfo = materialInfos.At(loadInfo.Name);
+	}
 
 	uint32 mat_size = 0;
 	for (auto e : materialInfo.ShaderSizes) { mat_size += e; }
@@ -154,11 +168,6 @@ void MaterialResourceManager::LoadMaterial(const MaterialLoadInfo& loadInfo)
 
 	BE_ASSERT(materialInfo.MaterialOffset != materialInfo.ShaderSizes[0], ":|");
 	
-	package.SetPointer(materialInfo.MaterialOffset, GTSL::File::MoveFrom::BEGIN);
-
-	[[maybe_unused]] const auto read = package.ReadFromFile(loadInfo.DataBuffer);
-	BE_ASSERT(read != 0, "Read 0 bytes!");
-	
 	OnMaterialLoadInfo onMaterialLoadInfo;
 	onMaterialLoadInfo.ResourceName = loadInfo.Name;
 	onMaterialLoadInfo.UserData = loadInfo.UserData;
@@ -195,8 +204,26 @@ void MaterialResourceManager::LoadMaterial(const MaterialLoadInfo& loadInfo)
 	}
 	
 	onMaterialLoadInfo.VertexElements = GTSL::Ranger<GAL::ShaderDataType>(materialInfo.VertexElements.GetLength(), reinterpret_cast<GAL::ShaderDataType*>(materialInfo.VertexElements.begin()));
-	
-	loadInfo.GameInstance->AddDynamicTask("loadMaterial", loadInfo.OnMaterialLoad, loadInfo.ActsOn, GTSL::MoveRef(onMaterialLoadInfo));
+
+	auto* pendingLoad = GTSL::New<PendingLoad>(GetPersistentAllocator(), loadInfo, onMaterialLoadInfo, mat_size);
+
+	IOService::ReadRequest readRequest;
+	readRequest.File = packageReadHandle;
+	readRequest.Offset = materialInfo.MaterialOffset;
+	readRequest.Buffer = GTSL::Ranger<byte>(mat_size, loadInfo.DataBuffer.begin());
+	readRequest.OnDone = GTSL::Delegate<void(void*, uint64)>::Create<MaterialResourceManager, &MaterialResourceManager::onMaterialRead>(this);
+	readRequest.UserData = pendingLoad;
+	BE::Application::Get()->GetIOService()->Read(readRequest);
+}
+
+void MaterialResourceManager::onMaterialRead(void* pendingLoad, const uint64 bytesRead)
+{
+	auto* load = static_cast<PendingLoad*>(pendingLoad);
+
+	if (bytesRead != load->Bytes) { BE_LOG_WARNING("Couldn't read whole material, read ", bytesRead, " of ", load->Bytes, " bytes!") }
+
+	load->LoadInfo.GameInstance->AddDynamicTask("loadMaterial", TaskPriority::LOW, load->LoadInfo.OnMaterialLoad, load->LoadInfo.ActsOn, GTSL::MoveRef(load->OnLoad));
+	GTSL::Delete(load, GetPersistentAllocator());
 }
 
 void Insert(const MaterialResourceManager::MaterialInfo::Binding& materialInfo, GTSL::Buffer& buffer)
@@ -6,7 +6,9 @@
 #include <GTSL/Delegate.hpp>
 #include <GTSL/File.h>
 #include <GTSL/FlatHashMap.h>
+#include <GTSL/Mutex.h>
 #include "ResourceManager.h"
+#include "ByteEngine/Application/IOService.h"
 
 class MaterialResourceManager final : public ResourceManager
 {
@@ -141,10 +143,35 @@ public:
 	{
 		GTSL::Delegate<void(TaskInfo, OnMaterialLoadInfo)> OnMaterialLoad;
 	};
+	/**
+	 * \brief Queues reading the material's shaders into the data buffer and returns, OnMaterialLoad is dispatched once they have been read.
+	 */
 	void LoadMaterial(const MaterialLoadInfo& loadInfo);
 	
 private:
 	GTSL::File package, index;
+	/**
+	 * \brief Second handle to the package for reads through the IOService, package is still written to when materials are created.
+	 */
+	IOService::FileHandle packageReadHandle{ IOService::INVALID_FILE };
 	GTSL::FlatHashMap<MaterialInfo, BE::PersistentAllocatorReference> materialInfos;
+	/**
+	 * \brief Guards materialInfos, which CreateMaterial can add to while other threads load materials.
+	 */
 	GTSL::ReadWriteMutex mutex;
+	GTSL::Mutex createMutex;
+
+	/**
+	 * \brief A material being read.
+	 */
+	struct PendingLoad
+	{
+		PendingLoad(const MaterialLoadInfo& loadInfo, const OnMaterialLoadInfo& onLoad, const uint32 bytes) : LoadInfo(loadInfo), OnLoad(onLoad), Bytes(bytes) {}
+
+		MaterialLoadInfo LoadInfo;
+		OnMaterialLoadInfo OnLoad;
+		uint32 Bytes = 0;
+	};
+
+	void onMaterialRead(void* pendingLoad, uint64 bytesRead);
 };
@@ -1,5 +1,6 @@
 #include "StaticMeshResourceManager.h"
 
+#include "AssetCooker.h"
 #include "ByteEngine/Application/Application.h"
 #include "ByteEngine/Debug/Assert.h"
 
@@ -32,80 +33,61 @@ StaticMeshResourceManager::StaticMeshResourceManager() : ResourceManager("Static
 	resources_path += "/resources/";
 
 	indexFile.OpenFile(index_path, (uint8)GTSL::File::AccessMode::WRITE | (uint8)GTSL::File::AccessMode::READ, GTSL::File::OpenMode::LEAVE_CONTENTS);
-	staticMeshPackage.OpenFile(package_path, (uint8)GTSL::File::AccessMode::WRITE | (uint8)GTSL::File::AccessMode::READ, GTSL::File::OpenMode::LEAVE_CONTENTS);
 	
 	GTSL::Buffer file_buffer; file_buffer.Allocate(2048 * 2048, 32, GetTransientAllocator());
-	GTSL::Buffer mesh_buffer; mesh_buffer.Allocate(2048 * 2048, 32, GetTransientAllocator());
 
-	if (indexFile.ReadFile(file_buffer))
-	{
-		GTSL::Extract(meshInfos, file_buffer);
-		file_buffer.Free(32, GetTransientAllocator());
-		mesh_buffer.Free(32, GetTransientAllocator());
-		return;
-	}
+	AssetCooker<MeshInfo> cooker(GetName(), "static meshes", package_path);
+
+	//an index which can't be used is rebuilt along with the package, otherwise only meshes whose source changed are cooked
+	if (indexFile.ReadFile(file_buffer) && cooker.ExtractRecords(file_buffer)) { GTSL::Extract(meshInfos, file_buffer); }
 	
 	auto load = [&](const GTSL::FileQuery::QueryResult& queryResult)
 	{
 		auto file_path = resources_path;
 		file_path += queryResult.FileNameWithExtension;
 		auto name = queryResult.FileNameWithExtension; name.Drop(name.FindLast('.'));
-		const auto hashed_name = GTSL::Id64(name);
-
-		if (!meshInfos.Find(hashed_name))
-		{
-			GTSL::File query_file;
-			query_file.OpenFile(file_path, static_cast<uint8>(GTSL::File::AccessMode::READ), GTSL::File::OpenMode::LEAVE_CONTENTS);
-
-			query_file.ReadFile(file_buffer);
-
-			MeshInfo mesh_info;
-
-			loadMesh(file_buffer, mesh_info, mesh_buffer); //writes into file buffer after reading, SAFE
-			file_buffer.Resize(0);
-			
-			mesh_info.ByteOffset = static_cast<uint32>(staticMeshPackage.GetFileSize());
-
-			staticMeshPackage.WriteToFile(mesh_buffer);
-
-			meshInfos.Emplace(hashed_name, mesh_info);
-
-			query_file.CloseFile();
-		}
+		cooker.AddAsset(file_path, GTSL::Id64(name));
 	};
-
 	
 	GTSL::FileQuery file_query(query_path);
 	GTSL::ForEach(file_query, load);
 
-	file_buffer.Resize(0);
-	Insert(meshInfos, file_buffer);
-	
-	indexFile.SetPointer(0, GTSL::File::MoveFrom::BEGIN);
-	indexFile.WriteToFile(file_buffer);
+	auto cookMesh = [](const GTSL::Buffer& source, MeshInfo& meshInfo, GTSL::Buffer& mesh, const BE::PersistentAllocatorReference& allocator) -> bool
+	{
+		mesh.Allocate(2048 * 2048, AssetCooker<MeshInfo>::COOKED_ALIGNMENT, allocator);
+		return loadMesh(source, meshInfo, mesh);
+	};
+
+	if (cooker.Cook(AssetCooker<MeshInfo>::CookFunction::Create(cookMesh), meshInfos))
+	{
+		indexFile.CloseFile();
+		indexFile.OpenFile(index_path, (uint8)GTSL::File::AccessMode::WRITE | (uint8)GTSL::File::AccessMode::READ, GTSL::File::OpenMode::CLEAR);
+
+		file_buffer.Resize(0);
+		cooker.InsertRecords(file_buffer);
+		Insert(meshInfos, file_buffer);
+		indexFile.WriteToFile(file_buffer);
+	}
 	
 	file_buffer.Free(32, GetTransientAllocator());
-	mesh_buffer.Free(32, GetTransientAllocator());
+
+	staticMeshPackage = IOService::OpenFile(package_path.begin());
+	if (staticMeshPackage == IOService::INVALID_FILE) { BE_LOG_WARNING("Couldn't open static mesh package, no meshes can be loaded!") }
+
+	if (!packageMapping.Open(package_path.begin())) { BE_LOG_WARNING("Couldn't map static mesh package, meshes won't be prefetched!") }
 }
 
 StaticMeshResourceManager::~StaticMeshResourceManager()
 {
-	staticMeshPackage.CloseFile(); indexFile.CloseFile();
+	packageMapping.Close(); IOService::CloseFile(staticMeshPackage); indexFile.CloseFile();
 }
 
 void StaticMeshResourceManager::LoadStaticMesh(const LoadStaticMeshInfo& loadStaticMeshInfo)
 {
-	const auto meshInfo = meshInfos.At(loadStaticMeshInfo.Name);
-
-	staticMeshPackage.SetPointer(meshInfo.ByteOffset, GTSL::File::MoveFrom::BEGIN);
+	const auto& meshInfo = meshInfos.At(loadStaticMeshInfo.Name);
 
 	byte* vertices = loadStaticMeshInfo.DataBuffer;
 	byte* indices = GTSL::AlignPointer(loadStaticMeshInfo.IndicesAlignment, vertices + meshInfo.VerticesSize);
-	
-	[[maybe_unused]] auto bytes_read = staticMeshPackage.ReadFromFile(GTSL::Ranger<byte>(meshInfo.VerticesSize, vertices));
-	BE_ASSERT(bytes_read != 0, "Read 0 bytes!");
-	bytes_read = staticMeshPackage.ReadFromFile(GTSL::Ranger<byte>(meshInfo.IndicesSize, indices));
-	BE_ASSERT(bytes_read != 0, "Read 0 bytes!");
 
 	const auto mesh_size = (indices + meshInfo.IndicesSize) - vertices;
 		
@@ -118,24 +100,56 @@ void StaticMeshResourceManager::LoadStaticMesh(const LoadStaticMeshInfo& loadSta
 	on_static_mesh_load.IndexSize = meshInfo.IndexSize;
 	on_static_mesh_load.UserData = loadStaticMeshInfo.UserData;
 	on_static_mesh_load.DataBuffer = GTSL::Ranger<byte>(mesh_size, loadStaticMeshInfo.DataBuffer.begin());
-	loadStaticMeshInfo.GameInstance->AddDynamicTask("OnStaticMeshLoad", loadStaticMeshInfo.OnStaticMeshLoad, loadStaticMeshInfo.ActsOn, GTSL::MoveRef(on_static_mesh_load));
+
+	auto* pendingLoad = GTSL::New<PendingLoad>(GetPersistentAllocator(), loadStaticMeshInfo, on_static_mesh_load, meshInfo.MeshSize());
+
+	//vertices and indices are stored back to back, indices are read to their aligned position
+	IOService::ReadRequest readRequest;
+	readRequest.File = staticMeshPackage;
+	readRequest.OnDone = GTSL::Delegate<void(void*, uint64)>::Create<StaticMeshResourceManager, &StaticMeshResourceManager::onMeshRead>(this);
+	readRequest.UserData = pendingLoad;
+
+	auto* ioService = BE::Application::Get()->GetIOService();
+
+	readRequest.Offset = meshInfo.ByteOffset; readRequest.Buffer = GTSL::Ranger<byte>(meshInfo.VerticesSize, vertices);
+	ioService->Read(readRequest);
+
+	readRequest.Offset = meshInfo.ByteOffset + meshInfo.VerticesSize; readRequest.Buffer = GTSL::Ranger<byte>(meshInfo.IndicesSize, indices);
+	ioService->Read(readRequest);
+}
+
+void StaticMeshResourceManager::onMeshRead(void* pendingLoad, const uint64 bytesRead)
+{
+	auto* load = static_cast<PendingLoad*>(pendingLoad);
+
+	load->BytesLeft.fetch_sub(static_cast<uint32>(bytesRead), std::memory_order_relaxed);
+	if (load->ReadsLeft.fetch_sub(1, std::memory_order_acq_rel) != 1) { return; }
+
+	if (load->BytesLeft.load(std::memory_order_relaxed))
+	{
+		BE_LOG_WARNING("Couldn't read whole mesh, ", load->BytesLeft.load(std::memory_order_relaxed), " bytes are missing!")
+	}
+
+	load->LoadInfo.GameInstance->AddDynamicTask("OnStaticMeshLoad", TaskPriority::LOW, load->LoadInfo.OnStaticMeshLoad, load->LoadInfo.ActsOn, GTSL::MoveRef(load->OnLoad));
+	GTSL::Delete(load, GetPersistentAllocator());
 }
 
 void StaticMeshResourceManager::GetMeshSize(const GTSL::Id64 name, uint16* indexSize, const uint16* indicesAlignment, uint32* meshSize, uint32* indicesOffset)
 {
-	auto& mesh = meshInfos.At(name);
+	const auto& mesh = meshInfos.At(name);
+	packageMapping.Prefetch(mesh.ByteOffset, mesh.MeshSize());
 	*indexSize = mesh.IndexSize;
 	*indicesOffset = GTSL::Math::PowerOf2RoundUp(mesh.VerticesSize, static_cast<uint32>(*indicesAlignment));
 	*meshSize = *indicesOffset + mesh.IndicesSize;
 }
 
-void StaticMeshResourceManager::loadMesh(const GTSL::Buffer& sourceBuffer, MeshInfo& meshInfo, GTSL::Buffer& mesh)
+bool StaticMeshResourceManager::loadMesh(const GTSL::Buffer& sourceBuffer, MeshInfo& meshInfo, GTSL::Buffer& mesh)
 {
 	Assimp::Importer importer;
 	const auto* const ai_scene = importer.ReadFileFromMemory(sourceBuffer.GetData(), sourceBuffer.GetLength(), aiProcess_Triangulate | aiProcess_FlipUVs |
 		aiProcess_JoinIdenticalVertices | aiProcess_CalcTangentSpace | aiProcess_GenSmoothNormals | aiProcess_ImproveCacheLocality);
 
-	BE_ASSERT(ai_scene != nullptr && !(ai_scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE), "Error interpreting file!");
+	if (ai_scene == nullptr || (ai_scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) || !ai_scene->mNumMeshes) { return false; }
 
 	aiMesh* inMesh = ai_scene->mMeshes[0];
 
@@ -221,6 +235,8 @@ void StaticMeshResourceManager::loadMesh(const GTSL::Buffer& sourceBuffer, MeshI
 
 	meshInfo.IndicesSize = inMesh->mNumFaces * 3 * indexSize;
 	meshInfo.IndexSize = indexSize;
+
+	return true;
 }
 
 void Insert(const StaticMeshResourceManager::MeshInfo& meshInfo, GTSL::Buffer& buffer)
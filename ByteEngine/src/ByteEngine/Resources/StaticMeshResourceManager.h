@@ -3,6 +3,9 @@
 #include <GTSL/Array.hpp>
 
 #include "ResourceManager.h"
+#include "MappedFile.h"
+#include "ByteEngine/Application/IOService.h"
+#include "ByteEngine/Debug/Assert.h"
 
 #include <GTSL/Delegate.hpp>
 #include <GTSL/FlatHashMap.h>
@@ -55,10 +58,42 @@ public:
 		GTSL::Delegate<void(TaskInfo, OnStaticMeshLoad)> OnStaticMeshLoad;
 		uint32 IndicesAlignment = 0;
 	};
+	/**
+	 * \brief Queues reading the mesh into the data buffer and returns, OnStaticMeshLoad is dispatched once it has been read. Can be called from any thread.
+	 */
 	void LoadStaticMesh(const LoadStaticMeshInfo& loadStaticMeshInfo);
 
+	/**
+	 * \brief Also hints the OS to start reading the mesh from disk, since it's called right before loading a mesh to size it's buffer.
+	 */
 	void GetMeshSize(GTSL::Id64 name, uint16* indexSize, const uint16* indicesAlignment, uint32* meshSize, uint32* indecesOffset);
 
+	/**
+	 * \brief Hints the OS to start reading a mesh from disk, to be called ahead of loading it.
+	 */
+	void PrefetchStaticMesh(const GTSL::Id64 name) const
+	{
+		const auto& meshInfo = meshInfos.At(name); packageMapping.Prefetch(meshInfo.ByteOffset, meshInfo.MeshSize());
+	}
+
+	/**
+	 * \brief Returns the mesh's vertices followed by it's indices, unaligned, straight from the mapped package. Valid for as long as the manager lives,
+	 * for callers which can consume the mesh in place instead of loading it into a buffer of their own. Empty if the package couldn't be mapped.
+	 */
+	[[nodiscard]] GTSL::Ranger<const byte> GetStaticMeshData(const GTSL::Id64 name) const
+	{
+		const auto& meshInfo = meshInfos.At(name);
+		if (!packageMapping.IsOpen()) { return GTSL::Ranger<const byte>(); }
+		BE_ASSERT(meshInfo.ByteOffset + meshInfo.MeshSize() <= packageMapping.GetSize(), "Mesh is outside of the package!")
+		return packageMapping.GetRange(meshInfo.ByteOffset, meshInfo.MeshSize());
+	}
+
+	/**
+	 * \brief Calls function with the name of every mesh in the package.
+	 */
+	template<typename F>
+	void ForEachStaticMesh(F&& function) { GTSL::PairForEach(meshInfos, [&](const uint64 name, MeshInfo&) { function(GTSL::Id64(name)); }); }
+
 	struct MeshInfo
 	{
 		GTSL::Array<uint8, 20> VertexDescriptor;
@@ -75,9 +110,39 @@ public:
 	
 private:
 	GTSL::FlatHashMap<OnStaticMeshLoad, BE::PersistentAllocatorReference> resources;
-	GTSL::File staticMeshPackage, indexFile;
+	GTSL::File indexFile;
+	/**
+	 * \brief Package opened for reading through the IOService once cooked.
+	 */
+	IOService::FileHandle staticMeshPackage{ IOService::INVALID_FILE };
+	/**
+	 * \brief The same package mapped read only, to prefetch meshes and hand them out in place.
+	 */
+	MappedFile packageMapping;
 	
+	/**
+	 * \brief Only written while cooking in the constructor, lookups can be made from any number of threads without locking.
+	 */
 	GTSL::FlatHashMap<MeshInfo, BE::PersistentAllocatorReference> meshInfos;
 
-	static void loadMesh(const GTSL::Buffer& sourceBuffer, MeshInfo& meshInfo, GTSL::Buffer& mesh);
+	/**
+	 * \brief A mesh being read, vertices and indices are read separately since indices go to an aligned offset.
+	 */
+	struct PendingLoad
+	{
+		PendingLoad(const LoadStaticMeshInfo& loadInfo, const OnStaticMeshLoad& onLoad, const uint32 bytes) : LoadInfo(loadInfo), OnLoad(onLoad), BytesLeft(bytes) {}
+
+		LoadStaticMeshInfo LoadInfo;
+		OnStaticMeshLoad OnLoad;
+		std::atomic<uint8> ReadsLeft{ 2 };
+		std::atomic<uint32> BytesLeft;
+	};
+
+	void onMeshRead(void* pendingLoad, uint64 bytesRead);
+
+	/**
+	 * \brief Imports the first mesh in sourceBuffer and writes it's vertices followed by it's indices to mesh. Called from cooking tasks.
+	 * \return false if the source couldn't be imported.
+	 */
+	static bool loadMesh(const GTSL::Buffer& sourceBuffer, MeshInfo& meshInfo, GTSL::Buffer& mesh);
 };
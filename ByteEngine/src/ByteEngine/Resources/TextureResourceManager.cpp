@@ -7,6 +7,7 @@
 #include <GTSL/Filesystem.h>
 #include <GTSL/Serialize.h>
 
+#include "AssetCooker.h"
 #include "ByteEngine/Application/Application.h"
 #include "ByteEngine/Debug/Assert.h"
 #include "ByteEngine/Game/GameInstance.h"
@@ -26,87 +27,80 @@ TextureResourceManager::TextureResourceManager() : ResourceManager("TextureResou
 	package_path += "/resources/Textures.bepkg";
 
 	indexFile.OpenFile(index_path, (uint8)GTSL::File::AccessMode::WRITE | (uint8)GTSL::File::AccessMode::READ, GTSL::File::OpenMode::LEAVE_CONTENTS);
-	packageFile.OpenFile(package_path, (uint8)GTSL::File::AccessMode::WRITE | (uint8)GTSL::File::AccessMode::READ, GTSL::File::OpenMode::LEAVE_CONTENTS);
 	
 	GTSL::Buffer file_buffer; file_buffer.Allocate(2048 * 2048 * 2, 32, GetTransientAllocator());
 
-	if (indexFile.ReadFile(file_buffer))
-	{
-		GTSL::Extract(textureInfos, file_buffer);
-		file_buffer.Free(32, GetTransientAllocator());
-		return;
-	}
+	AssetCooker<TextureInfo> cooker(GetName(), "textures", package_path);
+
+	//an index which can't be used is rebuilt along with the package, otherwise only textures whose source changed are cooked
+	if (indexFile.ReadFile(file_buffer) && cooker.ExtractRecords(file_buffer)) { GTSL::Extract(textureInfos, file_buffer); }
 	
 	auto load = [&](const GTSL::FileQuery::QueryResult& queryResult)
 	{
 		auto file_path = resources_path;
 		file_path += queryResult.FileNameWithExtension;
 		auto name = queryResult.FileNameWithExtension; name.Drop(name.FindLast('.'));
-		const auto hashed_name = GTSL::Id64(name);
-
-		if (!textureInfos.Find(hashed_name))
-		{
-			GTSL::File query_file;
-			query_file.OpenFile(file_path, static_cast<uint8>(GTSL::File::AccessMode::READ), GTSL::File::OpenMode::LEAVE_CONTENTS);
-
-			query_file.ReadFile(file_buffer);
-
-			int32 x, y, channel_count = 0;
-			auto* const data = stbi_load_from_memory(file_buffer.GetData(), file_buffer.GetLength(), &x, &y, &channel_count, 0);
-
-			TextureInfo texture_info;
-
-			switch (channel_count)
-			{
-			case 1: texture_info.Format = static_cast<uint8>(GAL::TextureFormat::R_I8); break;
-			case 2: texture_info.Format = static_cast<uint8>(GAL::TextureFormat::RG_I8); break;
-			case 3: texture_info.Format = static_cast<uint8>(GAL::TextureFormat::RGB_I8); break;
-			case 4: texture_info.Format = static_cast<uint8>(GAL::TextureFormat::RGBA_I8); break;
-			default: BE_ASSERT(false, "Non valid texture format count!");
-			}
-
-			texture_info.ByteOffset = static_cast<uint32>(packageFile.GetFileSize());
+		cooker.AddAsset(file_path, GTSL::Id64(name));
+	};
+	
+	GTSL::FileQuery file_query(query_path);
+	GTSL::ForEach(file_query, load);
 
-			const uint32 size = static_cast<uint32>(x) * y * channel_count;
+	auto cookTexture = [](const GTSL::Buffer& source, TextureInfo& textureInfo, GTSL::Buffer& texture, const BE::PersistentAllocatorReference& allocator) -> bool
+	{
+		int32 x, y, channel_count = 0;
+		auto* const data = stbi_load_from_memory(source.GetData(), source.GetLength(), &x, &y, &channel_count, 0);
+		if (!data) { return false; }
 
-			texture_info.ImageSize = size;
-			texture_info.Dimensions = GAL::Dimension::SQUARE;
-			texture_info.Extent = { static_cast<uint16>(x), static_cast<uint16>(y), 1 };
+		switch (channel_count)
+		{
+		case 1: textureInfo.Format = static_cast<uint8>(GAL::TextureFormat::R_I8); break;
+		case 2: textureInfo.Format = static_cast<uint8>(GAL::TextureFormat::RG_I8); break;
+		case 3: textureInfo.Format = static_cast<uint8>(GAL::TextureFormat::RGB_I8); break;
+		case 4: textureInfo.Format = static_cast<uint8>(GAL::TextureFormat::RGBA_I8); break;
+		default: BE_ASSERT(false, "Non valid texture format count!");
+		}
 
-			packageFile.WriteToFile(GTSL::Ranger<byte>(size, data));
+		const uint32 size = static_cast<uint32>(x) * y * channel_count;
 
-			textureInfos.Emplace(hashed_name, texture_info);
+		textureInfo.ImageSize = size;
+		textureInfo.Dimensions = GAL::Dimension::SQUARE;
+		textureInfo.Extent = { static_cast<uint16>(x), static_cast<uint16>(y), 1 };
 
-			stbi_image_free(data);
+		texture.Allocate(size, AssetCooker<TextureInfo>::COOKED_ALIGNMENT, allocator);
+		texture.WriteBytes(size, data);
 
-			query_file.CloseFile();
-		}
+		stbi_image_free(data);
+		return true;
 	};
-	
-	GTSL::FileQuery file_query(query_path);
-	GTSL::ForEach(file_query, load);
 
-	indexFile.CloseFile();
-	indexFile.OpenFile(index_path, (uint8)GTSL::File::AccessMode::WRITE | (uint8)GTSL::File::AccessMode::READ, GTSL::File::OpenMode::CLEAR);
+	if (cooker.Cook(AssetCooker<TextureInfo>::CookFunction::Create(cookTexture), textureInfos))
+	{
+		indexFile.CloseFile();
+		indexFile.OpenFile(index_path, (uint8)GTSL::File::AccessMode::WRITE | (uint8)GTSL::File::AccessMode::READ, GTSL::File::OpenMode::CLEAR);
 
-	file_buffer.Resize(0);
-	Insert(textureInfos, file_buffer);
-	indexFile.WriteToFile(file_buffer);
+		file_buffer.Resize(0);
+		cooker.InsertRecords(file_buffer);
+		Insert(textureInfos, file_buffer);
+		indexFile.WriteToFile(file_buffer);
+	}
 	
 	file_buffer.Free(32, GetTransientAllocator());
+
+	packageFile = IOService::OpenFile(package_path.begin());
+	if (packageFile == IOService::INVALID_FILE) { BE_LOG_WARNING("Couldn't open texture package, no textures can be loaded!") }
+
+	if (!packageMapping.Open(package_path.begin())) { BE_LOG_WARNING("Couldn't map texture package, textures won't be prefetched!") }
 }
 
 TextureResourceManager::~TextureResourceManager()
 {
-	packageFile.CloseFile(); indexFile.CloseFile();
+	packageMapping.Close(); IOService::CloseFile(packageFile); indexFile.CloseFile();
 }
 
 void TextureResourceManager::LoadTexture(const TextureLoadInfo& textureLoadInfo)
 {
-	auto& texture_info = textureInfos.At(textureLoadInfo.Name);
-
-	indexFile.SetPointer(texture_info.ByteOffset, GTSL::File::MoveFrom::BEGIN);
-	packageFile.ReadFromFile(GTSL::Ranger<byte>(texture_info.ImageSize, textureLoadInfo.DataBuffer.begin()));
+	const auto& texture_info = textureInfos.At(textureLoadInfo.Name);
 
 	OnTextureLoadInfo onTextureLoadInfo;
 	onTextureLoadInfo.ResourceName = textureLoadInfo.Name;
@@ -117,8 +111,26 @@ void TextureResourceManager::LoadTexture(const TextureLoadInfo& textureLoadInfo)
 	onTextureLoadInfo.Dimensions = texture_info.Dimensions;
 	onTextureLoadInfo.LODPercentage = 1.0f;
 	onTextureLoadInfo.TextureFormat = static_cast<GAL::TextureFormat>(texture_info.Format);
-	
-	textureLoadInfo.GameInstance->AddDynamicTask("Texture load", textureLoadInfo.OnTextureLoadInfo, textureLoadInfo.ActsOn, GTSL::MoveRef(onTextureLoadInfo));
+
+	auto* pendingLoad = GTSL::New<PendingLoad>(GetPersistentAllocator(), textureLoadInfo, onTextureLoadInfo, texture_info.ImageSize);
+
+	IOService::ReadRequest readRequest;
+	readRequest.File = packageFile;
+	readRequest.Offset = texture_info.ByteOffset;
+	readRequest.Buffer = GTSL::Ranger<byte>(texture_info.ImageSize, textureLoadInfo.DataBuffer.begin());
+	readRequest.OnDone = GTSL::Delegate<void(void*, uint64)>::Create<TextureResourceManager, &TextureResourceManager::onTextureRead>(this);
+	readRequest.UserData = pendingLoad;
+	BE::Application::Get()->GetIOService()->Read(readRequest);
+}
+
+void TextureResourceManager::onTextureRead(void* pendingLoad, const uint64 bytesRead)
+{
+	auto* load = static_cast<PendingLoad*>(pendingLoad);
+
+	if (bytesRead != load->Bytes) { BE_LOG_WARNING("Couldn't read whole texture, read ", bytesRead, " of ", load->Bytes, " bytes!") }
+
+	load->LoadInfo.GameInstance->AddDynamicTask("Texture load", TaskPriority::LOW, load->LoadInfo.OnTextureLoadInfo, load->LoadInfo.ActsOn, GTSL::MoveRef(load->OnLoad));
+	GTSL::Delete(load, GetPersistentAllocator());
 }
 
 void Insert(const TextureResourceManager::TextureInfo& textureInfo, GTSL::Buffer& buffer)
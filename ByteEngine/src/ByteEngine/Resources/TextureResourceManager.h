@@ -1,6 +1,9 @@
 #pragma once
 
 #include "ResourceManager.h"
+#include "MappedFile.h"
+#include "ByteEngine/Application/IOService.h"
+#include "ByteEngine/Debug/Assert.h"
 
 #include <GTSL/Extent.h>
 #include <GAL/RenderCore.h>
@@ -33,7 +36,8 @@ public:
 	
 	void GetTextureSizeFormatExtent(const GTSL::Id64 name, uint32* size, GAL::TextureFormat* format, GTSL::Extent3D* extent)
 	{
-		auto& e = textureInfos.At(name);
+		const auto& e = textureInfos.At(name);
+		packageMapping.Prefetch(e.ByteOffset, e.ImageSize); //called right before loading a texture to size it's buffer
 		*size = e.ImageSize;
 		*format = static_cast<GAL::TextureFormat>(e.Format);
 		*extent = e.Extent;
@@ -45,11 +49,66 @@ public:
 		GTSL::Extent3D TextureExtent;
 		float32 LODPercentage{ 0.0f };
 	};
+
+	/**
+	 * \brief Queues reading the texture into the data buffer and returns, OnTextureLoadInfo is dispatched once it has been read. Can be called from any thread.
+	 */
 	void LoadTexture(const TextureLoadInfo& textureLoadInfo);
 
+	/**
+	 * \brief Hints the OS to start reading a texture from disk, to be called ahead of loading it.
+	 */
+	void PrefetchTexture(const GTSL::Id64 name) const
+	{
+		const auto& e = textureInfos.At(name); packageMapping.Prefetch(e.ByteOffset, e.ImageSize);
+	}
+
+	/**
+	 * \brief Returns the texture's texels straight from the mapped package. Valid for as long as the manager lives,
+	 * for callers which can consume the texture in place instead of loading it into a buffer of their own. Empty if the package couldn't be mapped.
+	 */
+	[[nodiscard]] GTSL::Ranger<const byte> GetTextureData(const GTSL::Id64 name) const
+	{
+		const auto& e = textureInfos.At(name);
+		if (!packageMapping.IsOpen()) { return GTSL::Ranger<const byte>(); }
+		BE_ASSERT(e.ByteOffset + e.ImageSize <= packageMapping.GetSize(), "Texture is outside of the package!")
+		return packageMapping.GetRange(e.ByteOffset, e.ImageSize);
+	}
+
+	/**
+	 * \brief Calls function with the name of every texture in the package.
+	 */
+	template<typename F>
+	void ForEachTexture(F&& function) { GTSL::PairForEach(textureInfos, [&](const uint64 name, TextureInfo&) { function(GTSL::Id64(name)); }); }
+
 private:
-	GTSL::File packageFile, indexFile;
+	GTSL::File indexFile;
+	/**
+	 * \brief Package opened for reading through the IOService once cooked.
+	 */
+	IOService::FileHandle packageFile{ IOService::INVALID_FILE };
+	/**
+	 * \brief The same package mapped read only, to prefetch textures and hand them out in place.
+	 */
+	MappedFile packageMapping;
+	/**
+	 * \brief Only written while cooking in the constructor, lookups can be made from any number of threads without locking.
+	 */
 	GTSL::FlatHashMap<TextureInfo, BE::PersistentAllocatorReference> textureInfos;
+
+	/**
+	 * \brief A texture being read.
+	 */
+	struct PendingLoad
+	{
+		PendingLoad(const TextureLoadInfo& loadInfo, const OnTextureLoadInfo& onLoad, const uint32 bytes) : LoadInfo(loadInfo), OnLoad(onLoad), Bytes(bytes) {}
+
+		TextureLoadInfo LoadInfo;
+		OnTextureLoadInfo OnLoad;
+		uint32 Bytes = 0;
+	};
+
+	void onTextureRead(void* pendingLoad, uint64 bytesRead);
 	
 };
 
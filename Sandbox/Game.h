@@ -6,6 +6,7 @@
 #include "ByteEngine/Application/InputManager.h"
 #include "ByteEngine/Application/Templates/GameApplication.h"
 #include "ByteEngine/Game/GameInstance.h"
+#include "ByteEngine/Game/SlotMap.h"
 
 class Game final : public GameApplication
 {
@@ -17,7 +18,7 @@ class Game final : public GameApplication
 	GTSL::Vector3 moveDir;
 	float32 fov = 45.0f;
 	
-	uint32 camera;
+	ComponentHandle camera;
 	System::ComponentReference material;
 	System::ComponentReference texture;
 	uint32 textMaterial;
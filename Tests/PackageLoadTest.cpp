@@ -0,0 +1,161 @@
+#include "PackageLoadTest.h"
+
+#include <cstring>
+
+#include "ByteEngine/Application/Templates/Benchmarks/BenchmarkThreads.h"
+#include "ByteEngine/Application/Application.h"
+#include "ByteEngine/Debug/Logger.h"
+
+PackageLoadTest::~PackageLoadTest()
+{
+	if (threads) { GTSL::Delete(threads, GetPersistentAllocator()); }
+
+	if (meshes) { GetPersistentAllocator().Deallocate(sizeof(uint64) * meshCount, alignof(uint64), meshes); }
+	if (textures) { GetPersistentAllocator().Deallocate(sizeof(uint64) * textureCount, alignof(uint64), textures); }
+}
+
+void PackageLoadTest::Start()
+{
+	auto* staticMeshResourceManager = BE::Application::Get()->GetResourceManager<StaticMeshResourceManager>("StaticMeshResourceManager");
+	auto* textureResourceManager = BE::Application::Get()->GetResourceManager<TextureResourceManager>("TextureResourceManager");
+
+	staticMeshResourceManager->ForEachStaticMesh([&](GTSL::Id64) { ++meshCount; });
+	textureResourceManager->ForEachTexture([&](GTSL::Id64) { ++textureCount; });
+
+	uint64 allocatedSize{ 0 }; uint32 i = 0;
+
+	if (meshCount)
+	{
+		GetPersistentAllocator().Allocate(sizeof(uint64) * meshCount, alignof(uint64), reinterpret_cast<void**>(&meshes), &allocatedSize);
+		staticMeshResourceManager->ForEachStaticMesh([&](const GTSL::Id64 name) { meshes[i++] = name; });
+	}
+
+	i = 0;
+
+	if (textureCount)
+	{
+		GetPersistentAllocator().Allocate(sizeof(uint64) * textureCount, alignof(uint64), reinterpret_cast<void**>(&textures), &allocatedSize);
+		textureResourceManager->ForEachTexture([&](const GTSL::Id64 name) { textures[i++] = name; });
+	}
+
+	if (!meshCount && !textureCount) { BenchmarkThreads::Report(true, "Package load: no meshes or textures in the packages, skipped"); return; }
+
+	//as many loading threads as threads running tasks, so loads are issued and completed concurrently at the same time
+	const uint8 threadCount = BenchmarkThreads::GetTaskThreadCount();
+	loadsExpected = threadCount * rounds * (meshCount + textureCount);
+
+	threads = GTSL::New<BenchmarkThreads>(GetPersistentAllocator(), threadCount, GTSL::Delegate<void(uint8)>::Create<PackageLoadTest, &PackageLoadTest::work>(this));
+
+	//threads aren't joined here, the IOService submits reads once per frame so loads only make progress while frames run
+	loadStart = BenchmarkThreads::Now();
+	threads->Start();
+}
+
+bool PackageLoadTest::Finish()
+{
+	if (!threads) { return true; }
+
+	threads->Join();
+
+	const float64 seconds = static_cast<float64>(loadEnd.load() - loadStart) / 1000000000.0;
+
+	return BenchmarkThreads::Report(!mismatches.load(), "Package load: %u threads, %u meshes, %u textures, %u loads in %.2f ms, %.1f MB/s, %u verified, %u mismatched, %u unverified",
+		static_cast<uint32>(threads->GetThreadCount()), meshCount, textureCount, loadsExpected, seconds * 1000.0, static_cast<float64>(loadedBytes.load()) / (1024.0 * 1024.0) / seconds,
+		loadsExpected - mismatches.load() - unverified.load(), mismatches.load(), unverified.load());
+}
+
+void PackageLoadTest::work(const uint8 thread)
+{
+	auto* staticMeshResourceManager = BE::Application::Get()->GetResourceManager<StaticMeshResourceManager>("StaticMeshResourceManager");
+	auto* textureResourceManager = BE::Application::Get()->GetResourceManager<TextureResourceManager>("TextureResourceManager");
+
+	for (uint32 round = 0; round < rounds; ++round)
+	{
+		//every thread starts at a different asset so the same assets aren't read by all threads in lockstep
+		for (uint32 i = 0; i < meshCount; ++i)
+		{
+			const GTSL::Id64 name(meshes[(i + thread) % meshCount]);
+
+			uint16 indexSize; const uint16 indicesAlignment = 16; uint32 meshSize, indicesOffset;
+			staticMeshResourceManager->GetMeshSize(name, &indexSize, &indicesAlignment, &meshSize, &indicesOffset);
+
+			auto* load = GTSL::New<PackageLoad>(GetPersistentAllocator());
+			load->Name = name; load->Size = meshSize;
+
+			uint64 allocatedSize{ 0 };
+			GetPersistentAllocator().Allocate(meshSize, indicesAlignment, reinterpret_cast<void**>(&load->Data), &allocatedSize);
+
+			StaticMeshResourceManager::LoadStaticMeshInfo loadStaticMeshInfo;
+			loadStaticMeshInfo.Name = name;
+			loadStaticMeshInfo.DataBuffer = GTSL::Ranger<byte>(meshSize, load->Data);
+			loadStaticMeshInfo.IndicesAlignment = indicesAlignment;
+			loadStaticMeshInfo.UserData = DYNAMIC_TYPE(PackageLoad, load);
+			loadStaticMeshInfo.GameInstance = gameInstance;
+			loadStaticMeshInfo.OnStaticMeshLoad = GTSL::Delegate<void(TaskInfo, StaticMeshResourceManager::OnStaticMeshLoad)>::Create<PackageLoadTest, &PackageLoadTest::onStaticMeshLoad>(this);
+			staticMeshResourceManager->LoadStaticMesh(loadStaticMeshInfo);
+		}
+
+		for (uint32 i = 0; i < textureCount; ++i)
+		{
+			const GTSL::Id64 name(textures[(i + thread) % textureCount]);
+
+			uint32 textureSize; GAL::TextureFormat textureFormat; GTSL::Extent3D extent;
+			textureResourceManager->GetTextureSizeFormatExtent(name, &textureSize, &textureFormat, &extent);
+
+			auto* load = GTSL::New<PackageLoad>(GetPersistentAllocator());
+			load->Name = name; load->Size = textureSize;
+
+			uint64 allocatedSize{ 0 };
+			GetPersistentAllocator().Allocate(textureSize, 16, reinterpret_cast<void**>(&load->Data), &allocatedSize);
+
+			TextureResourceManager::TextureLoadInfo textureLoadInfo;
+			textureLoadInfo.Name = name;
+			textureLoadInfo.DataBuffer = GTSL::Ranger<byte>(textureSize, load->Data);
+			textureLoadInfo.UserData = DYNAMIC_TYPE(PackageLoad, load);
+			textureLoadInfo.GameInstance = gameInstance;
+			textureLoadInfo.TextureExtent = extent;
+			textureLoadInfo.OnTextureLoadInfo = GTSL::Delegate<void(TaskInfo, TextureResourceManager::OnTextureLoadInfo)>::Create<PackageLoadTest, &PackageLoadTest::onTextureLoad>(this);
+			textureResourceManager->LoadTexture(textureLoadInfo);
+		}
+	}
+}
+
+void PackageLoadTest::onStaticMeshLoad(TaskInfo taskInfo, StaticMeshResourceManager::OnStaticMeshLoad onStaticMeshLoad)
+{
+	auto* load = DYNAMIC_CAST(PackageLoad, onStaticMeshLoad.UserData);
+
+	const auto mapped = BE::Application::Get()->GetResourceManager<StaticMeshResourceManager>("StaticMeshResourceManager")->GetStaticMeshData(load->Name);
+	if (!mapped.Bytes()) { unverified.fetch_add(1, std::memory_order_relaxed); finishLoad(load, true); return; }
+
+	//the package stores indices right after vertices while the load puts them at an aligned offset
+	const uint32 indicesSize = load->Size - onStaticMeshLoad.IndicesOffset, verticesSize = static_cast<uint32>(mapped.Bytes()) - indicesSize;
+
+	finishLoad(load, indicesSize <= mapped.Bytes() && !std::memcmp(load->Data, mapped.begin(), verticesSize) &&
+		!std::memcmp(load->Data + onStaticMeshLoad.IndicesOffset, mapped.begin() + verticesSize, indicesSize));
+}
+
+void PackageLoadTest::onTextureLoad(TaskInfo taskInfo, TextureResourceManager::OnTextureLoadInfo onTextureLoadInfo)
+{
+	auto* load = DYNAMIC_CAST(PackageLoad, onTextureLoadInfo.UserData);
+
+	const auto mapped = BE::Application::Get()->GetResourceManager<TextureResourceManager>("TextureResourceManager")->GetTextureData(load->Name);
+	if (!mapped.Bytes()) { unverified.fetch_add(1, std::memory_order_relaxed); finishLoad(load, true); return; }
+
+	finishLoad(load, mapped.Bytes() == load->Size && !std::memcmp(load->Data, mapped.begin(), load->Size));
+}
+
+void PackageLoadTest::finishLoad(PackageLoad* load, const bool matches)
+{
+	if (!matches)
+	{
+		mismatches.fetch_add(1, std::memory_order_relaxed);
+		BE_LOG_ERROR("Loaded asset ", static_cast<uint64>(load->Name), " doesn't match the package!")
+	}
+
+	loadedBytes.fetch_add(load->Size, std::memory_order_relaxed);
+
+	GetPersistentAllocator().Deallocate(load->Size, 16, load->Data);
+	GTSL::Delete(load, GetPersistentAllocator());
+
+	if (loadsDone.fetch_add(1, std::memory_order_acq_rel) + 1 == loadsExpected) { loadEnd.store(BenchmarkThreads::Now(), std::memory_order_relaxed); }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "ByteEngine/Object.h"
+
+#include <atomic>
+
+#include "ByteEngine/Game/Tasks.h"
+#include "ByteEngine/Resources/StaticMeshResourceManager.h"
+#include "ByteEngine/Resources/TextureResourceManager.h"
+
+class BenchmarkThreads;
+class GameInstance;
+
+/**
+ * \brief Loads every static mesh and texture in the packages from as many threads as run tasks, all at once, and checks the loaded bytes against the packages mapped from disk.
+ * Loads complete as tasks of the frames, so it's started and then polled while frames run. Needs the StaticMeshResourceManager and TextureResourceManager to have been created.
+ */
+class PackageLoadTest : public Object
+{
+public:
+	/**
+	 * \param rounds Times every thread loads every asset.
+	 */
+	PackageLoadTest(GameInstance* gameInstance, const uint32 rounds) : Object("Package Load Test"), gameInstance(gameInstance), rounds(rounds)
+	{
+	}
+
+	~PackageLoadTest();
+
+	/**
+	 * \brief Starts the loading threads, they issue loads while frames run.
+	 */
+	void Start();
+
+	/**
+	 * \brief Whether every load issued has completed and been checked.
+	 */
+	[[nodiscard]] bool IsDone() const { return loadsDone.load(std::memory_order_acquire) == loadsExpected; }
+
+	/**
+	 * \brief Joins the loading threads and prints the results, call once IsDone.
+	 * \return false if any loaded asset didn't match the package.
+	 */
+	bool Finish();
+
+private:
+	GameInstance* gameInstance; uint32 rounds;
+
+	/**
+	 * \brief A load issued by the test, owns the buffer the resource is read to.
+	 */
+	struct PackageLoad
+	{
+		GTSL::Id64 Name;
+		byte* Data = nullptr;
+		uint32 Size = 0;
+	};
+
+	BenchmarkThreads* threads = nullptr;
+	uint64* meshes = nullptr; uint32 meshCount = 0;
+	uint64* textures = nullptr; uint32 textureCount = 0;
+	uint64 loadStart = 0;
+	std::atomic<uint64> loadEnd{ 0 };
+	uint32 loadsExpected = 0;
+	std::atomic<uint32> loadsDone{ 0 };
+	std::atomic<uint32> mismatches{ 0 }, unverified{ 0 };
+	std::atomic<uint64> loadedBytes{ 0 };
+
+	void work(uint8 thread);
+
+	void onStaticMeshLoad(TaskInfo taskInfo, StaticMeshResourceManager::OnStaticMeshLoad onStaticMeshLoad);
+	void onTextureLoad(TaskInfo taskInfo, TextureResourceManager::OnTextureLoadInfo onTextureLoadInfo);
+	void finishLoad(PackageLoad* load, bool matches);
+};
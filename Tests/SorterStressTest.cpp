@@ -0,0 +1,72 @@
+#include "SorterStressTest.h"
+
+#include "ByteEngine/Application/Templates/Benchmarks/BenchmarkThreads.h"
+
+bool SorterStressTest::Run()
+{
+	sorter = GTSL::New<TaskSorter<BE::PersistentAllocatorReference>>(GetPersistentAllocator(), MAX_OBJECTS, GetPersistentAllocator());
+	for (uint32 i = 0; i < MAX_OBJECTS; ++i) { sorter->AddSystem(); readers[i].store(0); writers[i].store(0); }
+
+	const uint8 threadCount = BenchmarkThreads::GetTaskThreadCount();
+	const float64 seconds = BenchmarkThreads::Run(threadCount, GTSL::Delegate<void(uint8)>::Create<SorterStressTest, &SorterStressTest::work>(this));
+
+	GTSL::Delete(sorter, GetPersistentAllocator());
+	sorter = nullptr;
+
+	return BenchmarkThreads::Report(violations.load() == 0, "TaskSorter stress: %u threads, %u objects, %.0f granted/sec, %llu granted, %llu refused, %llu violations", static_cast<uint32>(threadCount),
+		MAX_OBJECTS, static_cast<float64>(granted.load()) / seconds, granted.load(), refused.load(), violations.load());
+}
+
+void SorterStressTest::work(const uint8 thread)
+{
+	static constexpr uint32 MAX_ACCESSES = 8;
+
+	uint64 state = seed + thread * 0x9E3779B97F4A7C15ull;
+	auto next = [&](const uint32 max) -> uint32 { state ^= state << 13; state ^= state >> 7; state ^= state << 17; return static_cast<uint32>(state % max); };
+
+	for (uint32 i = 0; i < iterations; ++i)
+	{
+		uint16 objects[MAX_ACCESSES]; AccessType accesses[MAX_ACCESSES];
+		const uint32 count = 1 + next(MAX_ACCESSES);
+
+		//repeated objects are allowed, the sorter merges them keeping the strongest access
+		for (uint32 a = 0; a < count; ++a)
+		{
+			objects[a] = static_cast<uint16>(next(MAX_OBJECTS));
+			accesses[a] = next(100) < writePercentage ? AccessType::READ_WRITE : AccessType::READ;
+		}
+
+		auto res = sorter->CanRunTask(GTSL::Ranger<const uint16>(count, objects), GTSL::Ranger<const AccessType>(count, accesses));
+		if (!res) { refused.fetch_add(1, std::memory_order_relaxed); continue; }
+
+		granted.fetch_add(1, std::memory_order_relaxed);
+
+		bool writes[MAX_OBJECTS]{}, reads[MAX_OBJECTS]{};
+		for (uint32 a = 0; a < count; ++a) { if (accesses[a] == AccessType::READ_WRITE) { writes[objects[a]] = true; } else { reads[objects[a]] = true; } }
+
+		for (uint32 o = 0; o < MAX_OBJECTS; ++o)
+		{
+			if (writes[o])
+			{
+				if (writers[o].fetch_add(1, std::memory_order_acq_rel) != 0 || readers[o].load(std::memory_order_acquire) != 0) { violations.fetch_add(1, std::memory_order_relaxed); }
+			}
+			else if (reads[o])
+			{
+				readers[o].fetch_add(1, std::memory_order_acq_rel);
+				if (writers[o].load(std::memory_order_acquire) != 0) { violations.fetch_add(1, std::memory_order_relaxed); }
+			}
+		}
+
+		//hold the lease for a moment so other threads try to get in
+		volatile uint32 spin = 0;
+		for (uint32 s = next(64); s > 0; --s) { spin = spin + s; }
+
+		for (uint32 o = 0; o < MAX_OBJECTS; ++o)
+		{
+			if (writes[o]) { writers[o].fetch_sub(1, std::memory_order_acq_rel); }
+			else if (reads[o]) { readers[o].fetch_sub(1, std::memory_order_acq_rel); }
+		}
+
+		sorter->ReleaseResources(res.Get());
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "ByteEngine/Object.h"
+
+#include <atomic>
+
+#include "ByteEngine/Game/Tasks.h"
+
+/**
+ * \brief Acquires and releases random access sets on a TaskSorter from as many threads as run tasks, and checks it never lets conflicting accesses overlap.
+ * Every granted set is checked against shadow counters, so that no object ever has a writer alongside other writers or readers.
+ */
+class SorterStressTest : public Object
+{
+public:
+	/**
+	 * \param iterations Access sets every thread tries to acquire.
+	 * \param writePercentage Percentage of accesses which are READ_WRITE, the rest are READ.
+	 */
+	SorterStressTest(const uint32 iterations, const uint32 writePercentage, const uint64 seed) : Object("Sorter Stress Test"), iterations(iterations), writePercentage(writePercentage), seed(seed ? seed : 1)
+	{
+	}
+
+	/**
+	 * \return false if the sorter ever granted conflicting accesses.
+	 */
+	bool Run();
+
+private:
+	static constexpr uint32 MAX_OBJECTS = 64;
+
+	uint32 iterations, writePercentage; uint64 seed;
+
+	TaskSorter<BE::PersistentAllocatorReference>* sorter = nullptr;
+	/**
+	 * \brief Per object readers and writers of the leases granted by the sorter, kept by the stress threads themselves.
+	 */
+	std::atomic<uint32> readers[MAX_OBJECTS], writers[MAX_OBJECTS];
+	std::atomic<uint64> granted{ 0 }, refused{ 0 }, violations{ 0 };
+
+	void work(uint8 thread);
+};
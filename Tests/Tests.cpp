@@ -0,0 +1,85 @@
+#include "Tests.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "PackageLoadTest.h"
+#include "SorterStressTest.h"
+#include "ByteEngine/Application/Templates/Benchmarks/BenchmarkThreads.h"
+#include "ByteEngine/Game/GameInstance.h"
+#include "ByteEngine/Resources/StaticMeshResourceManager.h"
+#include "ByteEngine/Resources/TextureResourceManager.h"
+
+void Tests::Initialize()
+{
+	Application::Initialize();
+
+	gameInstance = GTSL::SmartPointer<GameInstance, BE::SystemAllocatorReference>::Create<GameInstance>(systemAllocatorReference);
+
+	CreateResourceManager<StaticMeshResourceManager>();
+	CreateResourceManager<TextureResourceManager>();
+
+	for (int i = 1; i < application_argc; ++i)
+	{
+		if (!std::strncmp(application_argv[i], "Seed=", 5)) { seed = std::strtoull(application_argv[i] + 5, nullptr, 10); }
+		else { printf("Ignoring unknown argument %s\n", application_argv[i]); }
+	}
+}
+
+void Tests::PostInitialize()
+{
+	printf("Tests: seed %llu\n", seed);
+
+	//load completions are dispatched from the first goal to the second
+	gameInstance->AddGoal("FrameStart"); gameInstance->AddGoal("FrameEnd");
+
+	//enough contended acquisitions to hit interleavings a broken sorter lets through, while taking a few seconds
+	failed += !SorterStressTest(200000, 30, seed).Run();
+
+	//loads complete as tasks of the frames, it's checked every frame and finishes the run once every load has been verified
+	packageLoadTest = GTSL::New<PackageLoadTest>(GetPersistentAllocator(), gameInstance.GetData(), 2);
+	packageLoadTest->Start();
+
+	startTime = BenchmarkThreads::Now();
+}
+
+void Tests::OnUpdate(const OnUpdateInfo& updateInfo)
+{
+	Application::OnUpdate(updateInfo);
+
+	if (packageLoadTest->IsDone())
+	{
+		failed += !packageLoadTest->Finish();
+		finish();
+	}
+	else if (BenchmarkThreads::Now() - startTime > TIMEOUT_SECONDS * 1000000000ull) //lost loads would otherwise keep a gating run going forever
+	{
+		failed += !BenchmarkThreads::Report(false, "Package load: not every load completed in %u seconds", TIMEOUT_SECONDS);
+		finish();
+	}
+}
+
+void Tests::Shutdown()
+{
+	gameInstance->WaitForFrames(this);
+	if (packageLoadTest) { GTSL::Delete(packageLoadTest, GetPersistentAllocator()); }
+
+	Application::Shutdown();
+}
+
+void Tests::finish()
+{
+	printf("Tests: %u failed\n", failed);
+
+	//the close mode becomes the exit code
+	if (failed)
+	{
+		static constexpr UTF8 REASON[] = "Tests failed";
+		Close(CloseMode::ERROR, GTSL::Ranger<const UTF8>(sizeof(REASON) - 1, REASON));
+	}
+	else
+	{
+		Close(CloseMode::OK, GTSL::Ranger<const UTF8>());
+	}
+}
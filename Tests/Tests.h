@@ -0,0 +1,39 @@
+#pragma once
+
+#include <ByteEngine.h>
+
+class PackageLoadTest;
+
+/**
+ * \brief Runs the engine's stress tests and exits with a non zero code if any of them fails, so it can gate changes to the code they cover.
+ * Tests which need frames, like PackageLoadTest, keep frames running until they are done. Tests run with fixed sizes and seeds, pass Seed=value to try a different one.
+ */
+class Tests final : public BE::Application
+{
+public:
+	Tests() : Application(BE::ApplicationCreateInfo{ "Tests" })
+	{
+	}
+
+	void Initialize() override;
+	void PostInitialize() override;
+	void OnUpdate(const OnUpdateInfo& updateInfo) override;
+	void Shutdown() override;
+
+	const char* GetApplicationName() override { return "Tests"; }
+
+private:
+	static constexpr uint32 TIMEOUT_SECONDS = 60;
+
+	uint64 seed = 1, startTime = 0;
+	uint32 failed = 0;
+
+	PackageLoadTest* packageLoadTest = nullptr;
+
+	void finish();
+};
+
+inline GTSL::SmartPointer<BE::Application, SystemAllocatorReference> CreateApplication(const SystemAllocatorReference& allocatorReference)
+{
+	return GTSL::SmartPointer<BE::Application, SystemAllocatorReference>::Create<Tests>(allocatorReference);
+}